@@ -1,4 +1,6 @@
 # PythonSCAD Stub File for use in editors like Visual Studio Code
+from concurrent.futures import Future
+
 class PyLibFive:
     pass
 
@@ -249,7 +251,7 @@ def divmatrix(obj:PyOpenSCAD, m:list[float]) -> PyOpenSCAD:
     """
     ...
 
-def offset(obj:PyOpenSCAD, r:float, delta:float, chamfer:float, fn:int, fa:float, fs:float) -> PyOpenSCAD:
+def offset(obj:PyOpenSCAD, r:float, delta:float, chamfer:float, fn:int, fa:float, fs:float, method:str, resolution:float) -> PyOpenSCAD:
     """2D or 3D Offset of an Object
     """
     ...
@@ -300,6 +302,12 @@ def export(obj:PyOpenSCAD, file:str) -> None:
     """
     ...
 
+def export_async(obj:PyOpenSCAD, file:str) -> Future[None]:
+    """Same as export, but writes the file on a background thread
+    returns a concurrent.futures.Future, which resolves to None once the file is written
+    """
+    ...
+
 def find_face(obj:PyOpenSCAD,m:lis[float] ) :
     """Find the face of the object which matches the given normal vector most
     m: vector of the normal
@@ -453,6 +461,12 @@ def render(obj:PyOpenSCAD,convexity:int) -> PyOpenSCAD:
     """
     ...
 
+def render_async(obj:PyOpenSCAD,convexity:int) -> Future[PyOpenSCAD]:
+    """Same as render, but evaluates the geometry on a background thread
+    returns a concurrent.futures.Future, which resolves to the rendered object
+    """
+    ...
+
 def osimport(file:str, layer:str, convexity:int, origin:list[float], scale:float, width:float, height:float, filename:str, center:bool, dpi:float, id:int) -> PyOpenSCAD:
     """Imports Object from disc
     """
@@ -4,6 +4,7 @@ from __future__ import annotations
 
 from typing import Union, List, Optional, overload, Self
 from enum import Enum
+from concurrent.futures import Future
 
 PyOpenSCADType = Union[PyOpenSCAD, List["PyOpenSCADType"]]
 
@@ -174,11 +175,15 @@ class PyOpenSCAD:
         fn: int = FN,
         fa: float = FA,
         fs: float = FS,
+        method: str = "prisms",
+        resolution: float = 0,
     ) -> Self:
         """2D or 3D Offset of an Object
         r: radius for round corners (can't be used with delta)
         delta: distance to offset (can't be used with r)
         chamfer: when true, creates chamfered edges
+        method: 3D only, "prisms" or "levelset" (sampled signed distance)
+        resolution: grid spacing of the "levelset" method, 0 derives it from the object size
         """
         ...
 
@@ -233,6 +238,12 @@ class PyOpenSCAD:
         """
         ...
 
+    def export_async(self, file: str) -> Future[None]:
+        """Same as export, but writes the file on a background thread
+        returns a concurrent.futures.Future, which resolves to None once the file is written
+        """
+        ...
+
     def linear_extrude(
         self,
         height: Optional[float] = None,
@@ -584,11 +595,15 @@ def offset(
     fn: Optional[int] = None,
     fa: Optional[float] = None,
     fs: Optional[float] = None,
+    method: Optional[str] = None,
+    resolution: Optional[float] = None,
 ) -> PyOpenSCAD:
     """2D or 3D Offset of an Object
     r: radius for round corners (can't be used with delta)
     delta: distance to offset (can't be used with r)
     chamfer: when true, creates chamfered edges
+    method: 3D only, "prisms" or "levelset" (sampled signed distance)
+    resolution: grid spacing of the "levelset" method, 0 derives it from the object size
     """
     ...
 
@@ -622,6 +637,12 @@ def export(obj: PyOpenSCADType, file: str) -> None:
     """
     ...
 
+def export_async(obj: PyOpenSCADType, file: str) -> Future[None]:
+    """Same as export, but writes the file on a background thread
+    returns a concurrent.futures.Future, which resolves to None once the file is written
+    """
+    ...
+
 def linear_extrude(
     obj: PyOpenSCADType,
     height: float,
@@ -779,6 +800,12 @@ def render(obj: PyOpenSCADType, convexity: int) -> PyOpenSCAD:
     """Renders Object even in preview mode"""
     ...
 
+def render_async(obj: PyOpenSCAD, convexity: int = 2) -> Future[PyOpenSCAD]:
+    """Same as render, but evaluates the geometry on a background thread
+    returns a concurrent.futures.Future, which resolves to the rendered object
+    """
+    ...
+
 def osimport(
     file: str,
     layer: str,
@@ -21,6 +21,7 @@ def main():
               "src/geometry/skin.cc",
               "src/geometry/linear_extrude.cc",
               "src/geometry/cgal/CGALCache.cc",
+              "src/geometry/cgal/ConvexDecompositionCache.cc",
               "src/geometry/cgal/cgalutils.cc",
               "src/geometry/cgal/cgalutils-kernel.cc",
               "src/geometry/cgal/cgalutils-applyops.cc",
@@ -34,19 +35,25 @@ def main():
               "src/geometry/cgal/cgalutils-project.cc",
               "src/geometry/cgal/cgalutils-closed.cc",
               "src/geometry/Geometry.cc",
+              "src/geometry/CompressedPolySet.cc",
               "src/geometry/GeometryCache.cc",
               "src/geometry/GeometryUtils.cc",
+              "src/geometry/HalfEdgeMesh.cc",
+              "src/geometry/PolygonIndexBuffer.cc",
               "src/geometry/Polygon2d.cc",
               "src/geometry/Barcode1d.cc",
               "src/geometry/PolySet.cc",
               "src/geometry/PolySetBuilder.cc",
               "src/geometry/PolySetUtils.cc",
+              "src/geometry/PointInPolyhedron.cc",
+              "src/geometry/QuickHull.cc",
               "src/geometry/Surface.cc",
               "src/geometry/Curve.cc",
               "src/geometry/ClipperUtils.cc",
               "src/geometry/linalg.cc",
               "src/geometry/manifold/ManifoldGeometry.cc",
               "src/geometry/manifold/manifold-applyops.cc",
+              "src/geometry/manifold/manifold-offset.cc",
               "src/geometry/manifold/manifoldutils.cc",
               "src/geometry/manifold/manifold-applyops-minkowski.cc",
               "src/geometry/boolean_utils.cc" ]
@@ -93,7 +100,10 @@ def main():
               "src/core/ContextMemoryManager.cc",
               "src/core/BuiltinContext.cc",
               "src/core/EvaluationSession.cc",
+              "src/core/FunctionMemoTable.cc",
+              "src/core/Profiler.cc",
               "src/core/Parameters.cc",
+              "src/core/ParseCache.cc",
               "src/core/SourceFileCache.cc",
             ]
     arith = [
@@ -103,6 +113,7 @@ def main():
               "src/core/Assignment.cc",
               "src/core/Arguments.cc",
               "src/core/Expression.cc",
+              "src/core/NumericKernel.cc",
               "src/core/SourceFile.cc",
             ]
     language = [
@@ -118,6 +129,7 @@ def main():
             ]
     core = [
               "src/core/FreetypeRenderer.cc",
+              "src/core/GlyphCache.cc",
               "src/core/DrawingCallback.cc",
               "src/core/customizer/Annotation.cc",
               "src/core/node.cc",
@@ -44,37 +44,62 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <map>
 #include <unordered_map>
+#include <utility>
 #include "utils/printutils.h"
 
+/*
+ * Size-bounded cache using the GreedyDual-Size replacement policy.
+ *
+ * Every entry has a cost (its size, counted against maxCost()) and a value,
+ * e.g. the time it took to compute it. Entries are evicted in order of
+ * priority L + value / cost, where L is the priority of the most recently
+ * evicted entry, so cheap or large entries go first while expensive entries
+ * survive until they have aged for a while. Accessing an entry refreshes its
+ * priority. An entry is only admitted if it doesn't displace entries which
+ * are worth more than itself. A refused entry counts as evicted right away, so
+ * it raises L as well and entries which are no longer used still age.
+ *
+ * Entries inserted without a value are worth their cost; if all entries are
+ * inserted that way, the policy is plain LRU.
+ */
 template <class Key, class T>
 class Cache
 {
+  struct Node;
+  using priority_type = std::pair<double, uint64_t>; // (priority, access sequence)
+  using queue_type = std::map<priority_type, Node *>;
+
   struct Node {
-    inline Node() : keyPtr(nullptr), t(nullptr), c(0), p(nullptr), n(nullptr) {
+    inline Node() : keyPtr(nullptr), t(nullptr), c(0), v(0.0) {
     }
-    inline Node(T * data, size_t cost) : keyPtr(nullptr), t(data), c(cost), p(nullptr), n(nullptr) {
+    inline Node(T *data, size_t cost, double value) : keyPtr(nullptr), t(data), c(cost), v(value) {
     }
-    const Key *keyPtr; T *t; size_t c; Node *p, *n;
+    const Key *keyPtr; T *t; size_t c; double v; typename queue_type::iterator pos;
   };
   using map_type = typename std::unordered_map<Key, Node>;
   using iterator_type = typename map_type::iterator;
   using value_type = typename map_type::value_type;
 
   std::unordered_map<Key, Node> hash;
-  Node *f, *l;
-  void *unused{nullptr};
+  queue_type queue;
   size_t mx, total{0};
+  double inflation{0.0};
+  uint64_t sequence{0};
+  size_t evicted{0}, rejected{0};
 
+  [[nodiscard]] inline priority_type priority(const Node& n) {
+    return {inflation + n.v / std::max<size_t>(n.c, 1), ++sequence};
+  }
   inline void unlink(Node& n) {
-    if (n.p) n.p->n = n.n;
-    if (n.n) n.n->p = n.p;
-    if (l == &n) l = n.p;
-    if (f == &n) f = n.n;
     total -= n.c;
+    queue.erase(n.pos);
     T *obj = n.t;
-    hash.erase(*n.keyPtr);
+    hash.erase(hash.find(*n.keyPtr));
     delete obj;
   }
   inline T *relink(const Key& key) {
@@ -82,21 +107,15 @@ class Cache
     if (i == hash.end()) return nullptr;
 
     Node& n = i->second;
-    if (f != &n) {
-      if (n.p) n.p->n = n.n;
-      if (n.n) n.n->p = n.p;
-      if (l == &n) l = n.p;
-      n.p = nullptr;
-      n.n = f;
-      f->p = &n;
-      f = &n;
-    }
+    auto handle = queue.extract(n.pos);
+    handle.key() = priority(n);
+    n.pos = queue.insert(std::move(handle)).position;
     return n.t;
   }
 
 public:
   inline explicit Cache(size_t maxCost = 100)
-    : f(nullptr), l(nullptr), mx(maxCost) { }
+    : mx(maxCost) { }
   inline ~Cache() { clear(); }
 
   [[nodiscard]] inline size_t maxCost() const { return mx; }
@@ -106,16 +125,20 @@ public:
   [[nodiscard]] inline size_t size() const { return hash.size(); }
   [[nodiscard]] inline bool empty() const { return hash.empty(); }
 
+  // Number of entries evicted to make room, and of entries refused admission
+  [[nodiscard]] inline size_t evictions() const { return evicted; }
+  [[nodiscard]] inline size_t rejections() const { return rejected; }
+
   void clear() {
-    while (f) {
-      delete f->t; f = f->n;
-    }
+    for (auto& item : hash) delete item.second.t;
     hash.clear();
-    l = nullptr;
+    queue.clear();
     total = 0;
+    inflation = 0.0;
   }
 
-  bool insert(const Key& key, T *object, size_t cost);
+  bool insert(const Key& key, T *object, size_t cost) { return insert(key, object, cost, static_cast<double>(cost)); }
+  bool insert(const Key& key, T *object, size_t cost, double value);
   T *object(const Key& key) const { return const_cast<Cache<Key, T> *>(this)->relink(key); }
   inline bool contains(const Key& key) const { return hash.find(key) != hash.end(); }
   T *operator[](const Key& key) const { return object(key); }
@@ -124,6 +147,7 @@ public:
   T *take(const Key& key);
 
 private:
+  bool admits(double priority, size_t cost) const;
   void trim(size_t m);
 };
 
@@ -143,47 +167,63 @@ template <class Key, class T>
 inline T *Cache<Key, T>::take(const Key& key)
 {
   iterator_type i = hash.find(key);
-  if (i == hash.end()) return 0;
+  if (i == hash.end()) return nullptr;
 
-  Node& n = *i;
+  Node& n = i->second;
   T *t = n.t;
-  n.t = 0;
+  n.t = nullptr;
   unlink(n);
   return t;
 }
 
+/*!
+   Returns true if an entry of the given priority and cost can be made to fit
+   by evicting only entries of lower or equal priority.
+ */
+template <class Key, class T>
+bool Cache<Key, T>::admits(double priority, size_t cost) const
+{
+  if (cost > mx) return false;
+  size_t remaining = total;
+  for (auto it = queue.begin(); it != queue.end() && remaining > mx - cost; ++it) {
+    if (it->first.first > priority) return false;
+    remaining -= it->second->c;
+  }
+  return true;
+}
+
 template <class Key, class T>
-bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost)
+bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost, double avalue)
 {
   remove(akey);
-  if (acost > mx) {
+  Node node(aobject, acost, avalue);
+  const auto prio = priority(node);
+  if (!admits(prio.first, acost)) {
+    if (acost <= mx) inflation = std::max(inflation, prio.first);
+    rejected++;
     delete aobject;
     return false;
   }
   trim(mx - acost);
-  Node node(aobject, acost);
-  hash[akey] = node;
-  auto i = hash.find(akey);
+  auto i = hash.emplace(akey, node).first;
   total += acost;
   Node *n = &i->second;
   n->keyPtr = &i->first;
-  if (f) f->p = n;
-  n->n = f;
-  f = n;
-  if (!l) l = f;
+  n->pos = queue.emplace(prio, n).first;
   return true;
 }
 
 template <class Key, class T>
 void Cache<Key, T>::trim(size_t m)
 {
-  Node *n = l;
-  while (n && total > m) {
-    Node *u = n;
-    n = n->p;
+  while (!queue.empty() && total > m) {
+    auto first = queue.begin();
+    Node *u = first->second;
+    inflation = first->first.first;
 #ifdef DEBUG
     LOG("Trimming cache: %1$s (%2$d bytes)", u->keyPtr->substr(0, 40), u->c);
 #endif
+    evicted++;
     unlink(*u);
   }
 }
@@ -35,6 +35,9 @@ const Feature Feature::ExperimentalTextMetricsFunctions("textmetrics", "Enable t
 const Feature Feature::ExperimentalImportFunction("import-function", "Enable import function returning data instead of geometry.");
 const Feature Feature::ExperimentalObjectFunction("object-function", "Enable object function to allow user creation of objects.");
 const Feature Feature::ExperimentalPredictibleOutput("predictible-output", "Attempt to produce predictible, diffable outputs (e.g. sorting the STL, or remeshing in a determined order)");
+const Feature Feature::ExperimentalFunctionMemoization("function-memoization", "Cache results of side effect free user function calls for the duration of an evaluation.");
+const Feature Feature::ExperimentalParseCache("parse-cache", "Keep parsed source files in a persistent cache, reusing them until the file or any of its includes change.");
+const Feature Feature::ExperimentalCompactGeometryCache("compact-geometry-cache", "Store cached meshes in a compact lossless encoding, decoded on use, so the geometry cache holds more of them. Meshes with single precision coordinates, e.g. from STL imports, are stored as floats.");
 
 Feature::Feature(const std::string& name, std::string description, bool hidden)
   : name(name), description(std::move(description))
@@ -21,6 +21,9 @@ public:
   static const Feature ExperimentalImportFunction;
   static const Feature ExperimentalObjectFunction;
   static const Feature ExperimentalPredictibleOutput;
+  static const Feature ExperimentalFunctionMemoization;
+  static const Feature ExperimentalParseCache;
+  static const Feature ExperimentalCompactGeometryCache;
 
 #ifdef ENABLE_GUI_TESTS
   static constexpr bool HasGuiTesting {true};
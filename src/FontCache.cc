@@ -44,6 +44,7 @@
 #include FT_TYPES_H
 #include FT_TRUETYPE_IDS_H
 
+#include "core/GlyphCache.h"
 #include "platform/PlatformUtils.h"
 #include "utils/printutils.h"
 #include "utils/version_helper.h"
@@ -233,6 +234,8 @@ void FontCache::register_font_file(const std::string& path)
   if (!FcConfigAppFontAddFile(this->config, reinterpret_cast<const FcChar8 *>(path.c_str()))) {
     LOG("Can't register font '%1$s'", path);
   }
+  // A new font file may change which face a font name resolves to
+  GlyphCache::instance()->clear();
 }
 
 void FontCache::add_font_dir(const std::string& path)
@@ -320,6 +323,7 @@ bool FontCache::is_init_ok() const
 void FontCache::clear()
 {
   this->cache.clear();
+  GlyphCache::instance()->clear();
 }
 
 void FontCache::dump_cache(const std::string& info)
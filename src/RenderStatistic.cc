@@ -40,6 +40,9 @@
 
 #include "json/json.hpp"
 
+#include "core/EvaluationSession.h"
+#include "core/GlyphCache.h"
+#include "core/Profiler.h"
 #include "geometry/Geometry.h"
 #include "geometry/GeometryCache.h"
 #include "geometry/linalg.h"
@@ -51,6 +54,7 @@
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
 #include "geometry/cgal/CGALCache.h"
+#include "geometry/cgal/ConvexDecompositionCache.h"
 #endif // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
 #include "geometry/manifold/ManifoldGeometry.h"
@@ -70,6 +74,8 @@ struct StatisticVisitor : public GeometryVisitor
   virtual void printCamera(const Camera& camera) = 0;
   virtual void printCacheStatistic() = 0;
   virtual void printRenderingTime(std::chrono::milliseconds) = 0;
+  virtual void printEvaluationStatistic(const EvaluationStatistic& statistic) = 0;
+  virtual void printProfile() = 0;
   virtual void finish() = 0;
 protected:
   bool is_enabled(const std::string& name) {
@@ -96,6 +102,8 @@ struct LogVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printEvaluationStatistic(const EvaluationStatistic& statistic) override;
+  void printProfile() override;
   void finish() override;
 private:
   void printBoundingBox3(const BoundingBox& bb);
@@ -121,6 +129,8 @@ struct StreamVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printEvaluationStatistic(const EvaluationStatistic& statistic) override;
+  void printProfile() override;
   void finish() override;
 private:
   nlohmann::json json;
@@ -161,18 +171,24 @@ static nlohmann::json getCache(C cache)
   cacheJson["entries"] = cache->size();
   cacheJson["bytes"] = cache->totalCost();
   cacheJson["max_size"] = cache->maxSizeMB() * 1024 * 1024;
+  cacheJson["hits"] = cache->hits();
+  cacheJson["misses"] = cache->misses();
   return cacheJson;
 }
 
 } // namespace
 
-RenderStatistic::RenderStatistic() : begin(std::chrono::steady_clock::now())
+RenderStatistic::RenderStatistic()
 {
+  start();
 }
 
 void RenderStatistic::start()
 {
   begin = std::chrono::steady_clock::now();
+#ifdef ENABLE_MANIFOLD
+  ManifoldUtils::resetConversionStatistics();
+#endif // ENABLE_MANIFOLD
 }
 
 std::chrono::milliseconds RenderStatistic::ms()
@@ -220,6 +236,11 @@ void RenderStatistic::printRenderingTime()
   visitor.printRenderingTime(ms());
 }
 
+void RenderStatistic::collectEvaluationStatistic(const EvaluationSession& session)
+{
+  evaluationStatistic = std::make_unique<EvaluationStatistic>(session.statistic());
+}
+
 void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options, const std::string& filename)
 {
   //bool is_log = false;
@@ -235,6 +256,12 @@ void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, cons
 
   visitor->printCacheStatistic();
   visitor->printRenderingTime(ms());
+  if (evaluationStatistic) {
+    visitor->printEvaluationStatistic(*evaluationStatistic);
+  }
+  if (Profiler::instance()->isEnabled()) {
+    visitor->printProfile();
+  }
   if (geom && !geom->isEmpty()) {
     geom->accept(*visitor);
   }
@@ -353,7 +380,12 @@ void LogVisitor::printCacheStatistic()
   GeometryCache::instance()->print();
 #ifdef ENABLE_CGAL
   CGALCache::instance()->print();
+  ConvexDecompositionCache::instance()->print();
 #endif
+#ifdef ENABLE_MANIFOLD
+  ManifoldUtils::printConversionStatistics();
+#endif
+  GlyphCache::instance()->print();
 }
 
 void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
@@ -366,6 +398,33 @@ void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
       (ms.count() % 1000));
 }
 
+void LogVisitor::printEvaluationStatistic(const EvaluationStatistic& statistic)
+{
+  if (is_enabled(RenderStatistic::EVALUATION)) {
+    const auto& gc = statistic.garbageCollection;
+    LOG("Garbage collection:");
+    LOG("   Minor collections: %1$d", gc.minorCollections);
+    LOG("   Full collections:  %1$d", gc.fullCollections);
+    LOG("   Contexts collected: %1$d", gc.contextsCollected);
+    LOG("   Contexts promoted:  %1$d", gc.contextsPromoted);
+    LOG("   Total pause: %1$.3f ms", gc.totalPause.count() / 1000.0);
+    LOG("   Max pause:   %1$.3f ms", gc.maxPause.count() / 1000.0);
+    const auto& memo = statistic.functionMemo;
+    LOG("Function memoization:");
+    LOG("   Hits:    %1$d", memo.hits);
+    LOG("   Misses:  %1$d", memo.misses);
+    LOG("   Entries: %1$d", memo.entries);
+    LOG("   Bytes:   %1$d", memo.bytes);
+  }
+}
+
+void LogVisitor::printProfile()
+{
+  if (is_enabled(RenderStatistic::PROFILE)) {
+    Profiler::instance()->print();
+  }
+}
+
 void LogVisitor::finish()
 {
 }
@@ -467,10 +526,26 @@ void StreamVisitor::printCacheStatistic()
 {
   if (is_enabled(RenderStatistic::CACHE)) {
     nlohmann::json cacheJson;
-    cacheJson["geometry_cache"] = getCache(GeometryCache::instance());
+    auto geometryCache = getCache(GeometryCache::instance());
+    geometryCache["evictions"] = GeometryCache::instance()->evictions();
+    geometryCache["rejections"] = GeometryCache::instance()->rejections();
+    cacheJson["geometry_cache"] = geometryCache;
 #ifdef ENABLE_CGAL
-    cacheJson["cgal_cache"] = getCache(CGALCache::instance());
+    auto cgalCache = getCache(CGALCache::instance());
+    cgalCache["evictions"] = CGALCache::instance()->evictions();
+    cgalCache["rejections"] = CGALCache::instance()->rejections();
+    cacheJson["cgal_cache"] = cgalCache;
+    cacheJson["convex_decomposition_cache"] = getCache(ConvexDecompositionCache::instance());
 #endif // ENABLE_CGAL
+#ifdef ENABLE_MANIFOLD
+    nlohmann::json conversionsJson;
+    conversionsJson["to_manifold"] = ManifoldUtils::conversionCount(ManifoldUtils::Conversion::ToManifold, false);
+    conversionsJson["to_manifold_reused"] = ManifoldUtils::conversionCount(ManifoldUtils::Conversion::ToManifold, true);
+    conversionsJson["to_polyset"] = ManifoldUtils::conversionCount(ManifoldUtils::Conversion::ToPolySet, false);
+    conversionsJson["to_polyset_reused"] = ManifoldUtils::conversionCount(ManifoldUtils::Conversion::ToPolySet, true);
+    cacheJson["manifold_conversions"] = conversionsJson;
+#endif // ENABLE_MANIFOLD
+    cacheJson["glyph_cache"] = getCache(GlyphCache::instance());
     json["cache"] = cacheJson;
   }
 }
@@ -493,6 +568,34 @@ void StreamVisitor::printRenderingTime(const std::chrono::milliseconds ms)
   }
 }
 
+void StreamVisitor::printEvaluationStatistic(const EvaluationStatistic& statistic)
+{
+  if (is_enabled(RenderStatistic::EVALUATION)) {
+    const auto& gc = statistic.garbageCollection;
+    nlohmann::json gcJson;
+    gcJson["minor_collections"] = gc.minorCollections;
+    gcJson["full_collections"] = gc.fullCollections;
+    gcJson["contexts_collected"] = gc.contextsCollected;
+    gcJson["contexts_promoted"] = gc.contextsPromoted;
+    gcJson["total_pause_us"] = gc.totalPause.count();
+    gcJson["max_pause_us"] = gc.maxPause.count();
+    json["evaluation"]["garbage_collection"] = gcJson;
+    nlohmann::json memoJson;
+    memoJson["hits"] = statistic.functionMemo.hits;
+    memoJson["misses"] = statistic.functionMemo.misses;
+    memoJson["entries"] = statistic.functionMemo.entries;
+    memoJson["bytes"] = statistic.functionMemo.bytes;
+    json["evaluation"]["function_memo"] = memoJson;
+  }
+}
+
+void StreamVisitor::printProfile()
+{
+  if (is_enabled(RenderStatistic::PROFILE)) {
+    json["profile"] = Profiler::instance()->toJson();
+  }
+}
+
 void StreamVisitor::finish()
 {
   stream << json;
@@ -32,6 +32,7 @@
 
 #include "glview/Camera.h"
 #include "geometry/Geometry.h"
+#include "core/EvaluationSession.h"
 
 /**
  * An utility class to collect and print rendering statistics for the given
@@ -47,15 +48,18 @@ public:
   constexpr static auto BOUNDING_BOX = "bounding-box";
   constexpr static auto AREA = "area";
   constexpr static auto VOLUME = "volume";
+  constexpr static auto EVALUATION = "evaluation";
+  constexpr static auto PROFILE = "profile";
 
   /**
    * Construct a statistic printer for the given geometry with current
-   * time as start time.
+   * time as start time, see start().
    */
   RenderStatistic();
 
   /**
-   * Set start time when reusing a RenderStatistic instance.
+   * Set start time when reusing a RenderStatistic instance, and reset the
+   * per render counters, like the Manifold conversions.
    */
   void start();
 
@@ -75,6 +79,13 @@ public:
    */
   void printRenderingTime();
 
+  /**
+   * Take a snapshot of the statistics of the given evaluation session (e.g.
+   * garbage collection and function memoization counters), to be included
+   * by printAll().
+   */
+  void collectEvaluationStatistic(const EvaluationSession& session);
+
   /**
    * Print all available statistic information.
    */
@@ -82,4 +93,5 @@ public:
 
 private:
   std::chrono::steady_clock::time_point begin;
+  std::unique_ptr<EvaluationStatistic> evaluationStatistic;
 };
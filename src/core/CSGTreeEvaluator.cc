@@ -31,7 +31,9 @@
 
 std::shared_ptr<CSGNode> CSGTreeEvaluator::buildCSGTree(const AbstractNode& node)
 {
+  this->buildRoot = &node;
   this->traverse(node);
+  this->buildRoot = nullptr;
 
   std::shared_ptr<CSGNode> t(this->stored_term[node.index()]);
   if (t) {
@@ -360,5 +362,12 @@ void CSGTreeEvaluator::addToParent(const State& state, const AbstractNode& node)
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
     this->visitedchildren[state.parent()->index()].push_back(node.shared_from_this());
+    if (state.parent().get() == this->buildRoot) {
+      const auto& t = this->stored_term[node.index()];
+      if (t && !t->isBackground()) {
+        PRINTDB("Partial result: top level object %d", node.index());
+        if (this->partialResult) this->partialResult(t);
+      }
+    }
   }
 }
@@ -4,6 +4,7 @@
 #include <list>
 #include <vector>
 #include <cstddef>
+#include <functional>
 #include "core/NodeVisitor.h"
 #include <memory>
 #include "core/ModuleInstantiation.h"
@@ -33,6 +34,12 @@ public:
 
   std::shared_ptr<CSGNode> buildCSGTree(const AbstractNode& node);
 
+  // Called with the term of each top level object as soon as it is complete,
+  // so a preview can be shown before the whole tree is built.
+  void setPartialResultCallback(std::function<void(const std::shared_ptr<CSGNode>&)> callback) {
+    this->partialResult = std::move(callback);
+  }
+
   [[nodiscard]] const std::shared_ptr<CSGNode>& getRootNode() const {
     return this->rootNode;
   }
@@ -62,4 +69,6 @@ protected:
   std::vector<std::shared_ptr<CSGNode>> highlightNodes;
   std::vector<std::shared_ptr<CSGNode>> backgroundNodes;
   std::map<int, std::shared_ptr<CSGNode>> stored_term; // The term evaluated from each node index
+  const AbstractNode *buildRoot{nullptr};
+  std::function<void(const std::shared_ptr<CSGNode>&)> partialResult;
 };
@@ -82,6 +82,9 @@ boost::optional<const Value&> Context::try_lookup_variable(const std::string& na
       return result;
     }
   }
+  // The variable might still get defined later on, so this lookup is not
+  // repeatable.
+  session()->registerSideEffect();
   return boost::none;
 }
 
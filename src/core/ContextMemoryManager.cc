@@ -26,6 +26,8 @@
 
 #include "core/ContextMemoryManager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <variant>
 #include <cassert>
 #include <utility>
@@ -206,11 +208,15 @@ static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr
 
 
 /*
- * Finds all contexts reachable from a set of root contexts.
+ * Finds all contexts in scope reachable from a set of root contexts.
+ * Contexts outside of scope (i.e. the old generation during a minor
+ * collection) are not traversed; any references they hold into scope have
+ * already been accounted for as roots by findRootContexts().
  *
  * Implemented as a breadth first search to save on stack space.
  */
-static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts)
+static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts,
+                                                                 const std::unordered_set<const Context *>& scope)
 {
   std::unordered_set<ValueIdentifier> valuesSeen;
   std::unordered_set<const Context *> contextsSeen;
@@ -229,6 +235,9 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
       }
     };
   auto visitContext = [&](const Context *context) {
+      if (!scope.count(context)) {
+        return;
+      }
       if (!contextsSeen.count(context)) {
         contextsSeen.insert(context);
         contextQueue.push_back(context);
@@ -273,9 +282,13 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
 
 
 /*
- * Clean up all unreachable contexts.
+ * Clean up all unreachable contexts in managedContexts. Any references to
+ * them from outside of managedContexts are treated as roots, which makes it
+ * safe to collect a single generation at a time.
+ *
+ * Returns the number of contexts collected.
  */
-static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
+static size_t collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
 {
   /*
    * Garbage collection consists of three phases.
@@ -299,16 +312,19 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
    * Lock all contexts to prevent deletion during reachability analysis.
    */
   std::vector<std::shared_ptr<Context>> allContexts;
+  std::unordered_set<const Context *> scope;
   for (const std::weak_ptr<Context>& managedContext : managedContexts) {
     std::shared_ptr<Context> context = managedContext.lock();
     if (context) {
+      scope.insert(context.get());
       allContexts.push_back(std::move(context));
     }
   }
 
   const std::vector<Context *> rootContexts = findRootContexts(allContexts);
 
-  const std::unordered_set<const Context *> reachableContexts = findReachableContexts(rootContexts);
+  const std::unordered_set<const Context *> reachableContexts = findReachableContexts(rootContexts, scope);
+  size_t collected = 0;
 
 #ifdef DEBUG
   std::vector<std::weak_ptr<Context>> removedContexts;
@@ -320,6 +336,7 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
       managedContexts.emplace_back(context);
     } else {
       context->clear();
+      ++collected;
 #ifdef DEBUG
       removedContexts.emplace_back(context);
 #endif
@@ -345,17 +362,50 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
     assert(context.expired());
   }
 #endif
+  return collected;
 }
 
 
 
+/*
+ * Number of heap units (see HeapSizeAccounting) that may be allocated
+ * between two minor collections. Keeps minor collection pauses bounded and
+ * independent of the total heap size.
+ */
+static constexpr size_t minorCollectionInterval = 16384;
+
 ContextMemoryManager::~ContextMemoryManager()
 {
-  collectGarbage(managedContexts);
-  assert(managedContexts.empty());
+  fullCollection();
+  assert(oldContexts.empty());
   assert(heapSizeAccounting.size() == 0);
 }
 
+void ContextMemoryManager::minorCollection()
+{
+  const auto start = std::chrono::steady_clock::now();
+  gcStatistic.contextsCollected += collectGarbage(youngContexts);
+  gcStatistic.contextsPromoted += youngContexts.size();
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+  const auto pause = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  gcStatistic.minorCollections++;
+  gcStatistic.totalPause += pause;
+  gcStatistic.maxPause = std::max(gcStatistic.maxPause, pause);
+}
+
+void ContextMemoryManager::fullCollection()
+{
+  const auto start = std::chrono::steady_clock::now();
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+  gcStatistic.contextsCollected += collectGarbage(oldContexts);
+  const auto pause = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  gcStatistic.fullCollections++;
+  gcStatistic.totalPause += pause;
+  gcStatistic.maxPause = std::max(gcStatistic.maxPause, pause);
+}
+
 void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
 {
   heapSizeAccounting.addContext();
@@ -367,12 +417,12 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
    * right away.
    */
   if (context.use_count() > 1) {
-    managedContexts.emplace_back(context);
+    youngContexts.emplace_back(context);
 
     if (heapSizeAccounting.size() >= nextGarbageCollectSize) {
-      collectGarbage(managedContexts);
+      fullCollection();
       /*
-       * The cost of a garbage collection run is proportional to the heap
+       * The cost of a full garbage collection run is proportional to the heap
        * size. By scheduling the next run at twice the *remaining* heap size,
        * the total processing time of garbage collection throughout an
        * evaluation session is at most proportional to the total heap size
@@ -381,6 +431,18 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
        * (i.e. waste is at most a factor 2 overhead).
        */
       nextGarbageCollectSize = heapSizeAccounting.size() * 2;
+      nextMinorCollectSize = heapSizeAccounting.size() + minorCollectionInterval;
+    } else if (heapSizeAccounting.size() >= nextMinorCollectSize) {
+      /*
+       * Most contexts die young, so collecting only the contexts created
+       * since the last collection reclaims most garbage at a cost
+       * proportional to the young generation rather than the whole heap.
+       * References from the old generation into the young one act as the
+       * remembered set: they show up as unaccounted references in
+       * findRootContexts() and keep their targets alive until promoted.
+       */
+      minorCollection();
+      nextMinorCollectSize = heapSizeAccounting.size() + minorCollectionInterval;
     }
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <vector>
@@ -31,6 +32,28 @@ private:
   size_t count = 0;
 };
 
+/*
+ * Counters describing the garbage collection work done during an
+ * EvaluationSession, reported as part of the render summary.
+ */
+struct GarbageCollectionStatistic
+{
+  size_t minorCollections = 0;
+  size_t fullCollections = 0;
+  size_t contextsCollected = 0;
+  size_t contextsPromoted = 0;
+  std::chrono::microseconds totalPause{0};
+  std::chrono::microseconds maxPause{0};
+};
+
+/*
+ * Generational garbage collector for contexts.
+ *
+ * Newly registered contexts start out in the young generation. Minor
+ * collections only scan the young generation; contexts surviving a minor
+ * collection are promoted to the old generation, which is only scanned by
+ * the (much rarer) full collections.
+ */
 class ContextMemoryManager
 {
 public:
@@ -40,9 +63,16 @@ public:
   void releaseContext() { heapSizeAccounting.removeContext(); }
 
   HeapSizeAccounting& accounting() { return heapSizeAccounting; }
+  [[nodiscard]] const GarbageCollectionStatistic& statistic() const { return gcStatistic; }
 
 private:
-  std::vector<std::weak_ptr<Context>> managedContexts;
+  void minorCollection();
+  void fullCollection();
+
+  std::vector<std::weak_ptr<Context>> youngContexts;
+  std::vector<std::weak_ptr<Context>> oldContexts;
   HeapSizeAccounting heapSizeAccounting;
   size_t nextGarbageCollectSize = 0;
+  size_t nextMinorCollectSize = 0;
+  GarbageCollectionStatistic gcStatistic;
 };
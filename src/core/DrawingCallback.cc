@@ -125,3 +125,16 @@ void DrawingCallback::curve_to(const Vector2d& c1, const Vector2d& c2, const Vec
   }
   pen = to;
 }
+
+void DrawingCallback::add_outlines(const std::vector<Outline2d>& outlines)
+{
+  for (const auto& o : outlines) {
+    if (this->outline.vertices.size() > 0) {
+      this->polygon->addOutline(this->outline);
+      this->outline.vertices.clear();
+    }
+    for (const auto& v : o.vertices) {
+      add_vertex(v);
+    }
+  }
+}
@@ -51,6 +51,8 @@ public:
   void line_to(const Vector2d& to);
   void curve_to(const Vector2d& c1, const Vector2d& to);
   void curve_to(const Vector2d& c1, const Vector2d& c2, const Vector2d& to);
+  // Replays already flattened contours, e.g. from the GlyphCache
+  void add_outlines(const std::vector<Outline2d>& outlines);
 private:
   Vector2d pen;
   Vector2d offset;
@@ -32,6 +32,7 @@
 
 #include "core/AST.h"
 #include "core/ContextFrame.h"
+#include "core/progress.h"
 #include "utils/printutils.h"
 
 size_t EvaluationSession::push_frame(ContextFrame *frame)
@@ -53,8 +54,27 @@ void EvaluationSession::pop_frame(size_t index)
   assert(stack.size() == index);
 }
 
+size_t EvaluationSession::sideEffectCount() const
+{
+  return side_effect_count + print_messages_count;
+}
+
+void EvaluationSession::checkCancel() const
+{
+  if (cancel_flag && cancel_flag->load(std::memory_order_relaxed)) throw ProgressCancelException();
+}
+
+EvaluationStatistic EvaluationSession::statistic() const
+{
+  EvaluationStatistic statistic;
+  statistic.garbageCollection = context_memory_manager.statistic();
+  statistic.functionMemo = function_memo_table.statistic();
+  return statistic;
+}
+
 boost::optional<const Value&> EvaluationSession::try_lookup_special_variable(const std::string& name) const
 {
+  registerSideEffect();
   for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
     boost::optional<const Value&> result = (*it)->lookup_local_variable(name);
     if (result) {
@@ -76,6 +96,7 @@ const Value& EvaluationSession::lookup_special_variable(const std::string& name,
 
 boost::optional<CallableFunction> EvaluationSession::lookup_special_function(const std::string& name, const Location& loc) const
 {
+  registerSideEffect();
   for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
     boost::optional<CallableFunction> result = (*it)->lookup_local_function(name, loc);
     if (result) {
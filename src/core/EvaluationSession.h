@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <string>
 #include <utility>
@@ -7,6 +8,7 @@
 #include <boost/optional.hpp>
 
 #include "core/ContextMemoryManager.h"
+#include "core/FunctionMemoTable.h"
 #include "core/AST.h"
 #include "core/function.h"
 #include "core/module.h"
@@ -14,6 +16,12 @@
 
 class ContextFrame;
 
+struct EvaluationStatistic
+{
+  GarbageCollectionStatistic garbageCollection;
+  FunctionMemoStatistic functionMemo;
+};
+
 class EvaluationSession
 {
 public:
@@ -32,10 +40,36 @@ public:
 
   [[nodiscard]] const std::string& documentRoot() const { return document_root; }
   ContextMemoryManager& contextMemoryManager() { return context_memory_manager; }
+  [[nodiscard]] const ContextMemoryManager& contextMemoryManager() const { return context_memory_manager; }
   HeapSizeAccounting& accounting() { return context_memory_manager.accounting(); }
+  FunctionMemoTable& functionMemoTable() { return function_memo_table; }
+
+  /*
+   * Side effects that make a function call impure, i.e. unsafe to memoize:
+   * reading special variables or undefined variables, random number
+   * generation and calling out to Python. Printed messages (echo, warnings)
+   * are counted as well.
+   */
+  void registerSideEffect() const { side_effect_count++; }
+  [[nodiscard]] size_t sideEffectCount() const;
+
+  [[nodiscard]] EvaluationStatistic statistic() const;
+
+  /*
+   * Cooperative cancellation, e.g. when the GUI's source changed. The flag
+   * is owned by whoever runs the evaluation; checkCancel() is called
+   * regularly and throws ProgressCancelException once it is set.
+   */
+  void setCancelFlag(const std::atomic<bool> *flag) { cancel_flag = flag; }
+  void checkCancel() const;
 
 private:
   std::string document_root;
   std::vector<ContextFrame *> stack;
   ContextMemoryManager context_memory_manager;
+  // Declared after context_memory_manager, as memoized values must be
+  // released before the memory manager checks for leaks.
+  FunctionMemoTable function_memo_table;
+  mutable size_t side_effect_count = 0;
+  const std::atomic<bool> *cancel_flag = nullptr;
 };
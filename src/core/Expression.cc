@@ -43,10 +43,16 @@
 #include "utils/printutils.h"
 #include "utils/StackCheck.h"
 #include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/FunctionMemoTable.h"
+#include "core/NumericKernel.h"
+#include "core/Profiler.h"
+#include "Feature.h"
 #include "utils/exceptions.h"
 #include "core/Parameters.h"
 #include "utils/printutils.h"
 #include "utils/boost-utils.h"
+#include "utils/parallel.h"
 #include <boost/regex.hpp>
 #include <boost/assign/std/vector.hpp>
 #ifdef ENABLE_PYTHON
@@ -560,6 +566,9 @@ struct SimplifiedExpression {
   const Expression *expression;
   boost::optional<ContextHandle<Context>> new_context = boost::none;
   boost::optional<const FunctionCall *> new_active_function_call = boost::none;
+  // Set when entering the body of a user defined function, for memoization
+  const UserFunction *user_function = nullptr;
+  std::shared_ptr<const Context> defining_context = nullptr;
 };
 using SimplificationResult = std::variant<SimplifiedExpression, Value>;
 
@@ -589,11 +598,13 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       const Expression *function_body;
       const AssignmentList *required_parameters;
       std::shared_ptr<const Context> defining_context;
+      const UserFunction *user_function = nullptr;
 
       auto f = call->evaluate_function_expression(context);
 #ifdef ENABLE_PYTHON    
       if(f == boost::none)
       {
+        context->session()->registerSideEffect();
         int error = 0;	      
         Value v = python_functionfunc(call,context, error);
         if(!error) return v;
@@ -611,6 +622,7 @@ static SimplificationResult simplify_function_body(const Expression *expression,
           function_body = callable.function->expr.get();
           required_parameters = &callable.function->parameters;
           defining_context = callable.defining_context;
+          user_function = callable.function;
         } else {
           const FunctionType *function;
           if (index == 2) {
@@ -631,7 +643,7 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       Parameters parameters = Parameters::parse(std::move(arguments), call->location(), *required_parameters, defining_context);
       body_context->apply_variables(std::move(parameters).to_context_frame());
 
-      return SimplifiedExpression{function_body, std::move(body_context), call};
+      return SimplifiedExpression{function_body, std::move(body_context), call, user_function, defining_context};
     } else {
       return expression->evaluate(context);
     }
@@ -645,6 +657,7 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
     print_err(name.c_str(), loc, context);
     throw RecursionException::create("function", name, this->loc);
   }
+  const Profiler::Scope profile("function", name, this->loc);
 
   // Repeatedly simplify expr until it reduces to either a tail call,
   // or an expression that cannot be simplified in-place. If the latter,
@@ -655,10 +668,23 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
 
   ContextHandle<Context> expression_context{Context::create<Context>(context)};
   const Expression *expression = this;
+
+  // Memoization only applies to the function called by this expression;
+  // tail calls are part of evaluating its result.
+  EvaluationSession *session = context->session();
+  std::string memo_key;
+  std::shared_ptr<const Context> memo_defining_context;
+  size_t memo_side_effects = 0;
+
   while (true) {
+    // Checked per call, so tail recursive loops can be cancelled as well
+    session->checkCancel();
     try {
       auto result = simplify_function_body(expression, *expression_context);
       if (Value *value = std::get_if<Value>(&result)) {
+        if (memo_defining_context && session->sideEffectCount() == memo_side_effects) {
+          session->functionMemoTable().insert(memo_key, memo_defining_context, *value);
+        }
         return std::move(*value);
       }
 
@@ -669,6 +695,19 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
       if (simplified_expression->new_context) {
         expression_context = std::move(*simplified_expression->new_context);
       }
+      if (recursion_depth == 0 && simplified_expression->user_function &&
+          Feature::ExperimentalFunctionMemoization.is_enabled()) {
+        FunctionMemoTable& memo = session->functionMemoTable();
+        if (memo.shouldMemoize(simplified_expression->user_function) &&
+            FunctionMemoTable::makeKey(simplified_expression->user_function, simplified_expression->defining_context,
+                                       *expression_context, memo_key)) {
+          if (auto memoized = memo.lookup(memo_key, simplified_expression->defining_context)) {
+            return std::move(*memoized);
+          }
+          memo_defining_context = simplified_expression->defining_context;
+          memo_side_effects = session->sideEffectCount();
+        }
+      }
       if (simplified_expression->new_active_function_call) {
         current_call = *simplified_expression->new_active_function_call;
         if (recursion_depth++ == 1000000) {
@@ -979,6 +1018,16 @@ static inline ContextHandle<Context> forContext(const std::shared_ptr<const Cont
   return innerContext;
 }
 
+static void doForEachValues(
+  const AssignmentList& assignments,
+  const Location& location,
+  const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+  size_t assignment_index,
+  const std::shared_ptr<const Context>& context,
+  Value variable_values,
+  const std::function<void(size_t)> *pReserve = nullptr
+  );
+
 static void doForEach(
   const AssignmentList& assignments,
   const Location& location,
@@ -992,8 +1041,21 @@ static void doForEach(
     return;
   }
 
-  const std::string& variable_name = assignments[assignment_index]->getName();
   Value variable_values = assignments[assignment_index]->getExpr()->evaluate(context);
+  doForEachValues(assignments, location, operation, assignment_index, context, std::move(variable_values), pReserve);
+}
+
+// Iterates over the already evaluated values of assignments[assignment_index]
+static void doForEachValues(
+  const AssignmentList& assignments,
+  const Location& location,
+  const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+  size_t assignment_index,
+  const std::shared_ptr<const Context>& context,
+  Value variable_values,
+  const std::function<void(size_t)> *pReserve
+  ) {
+  const std::string& variable_name = assignments[assignment_index]->getName();
 
   if (variable_values.type() == Value::Type::RANGE) {
     const RangeType& range = variable_values.toRange();
@@ -1053,16 +1115,67 @@ void LcFor::forEach(const AssignmentList& assignments, const Location& loc, cons
   doForEach(assignments, loc, operation, 0, context, pReserve);
 }
 
+// Minimum number of iterations worth compiling a NumericKernel for
+static constexpr size_t parallelKernelThreshold = 256;
+
+// Collects the loop values if all of them are numbers
+static bool numericLoopValues(const Value& values, std::vector<double>& out)
+{
+  if (values.type() == Value::Type::RANGE) {
+    const RangeType& range = values.toRange();
+    uint32_t steps = range.numValues();
+    if (steps >= 1000000) return false; // let doForEachValues() warn
+    out.reserve(steps);
+    for (double value : range) {
+      out.push_back(value);
+    }
+    return true;
+  }
+  if (values.type() == Value::Type::VECTOR) {
+    const auto& vec = values.toVector();
+    out.reserve(vec.size());
+    for (const auto& value : vec) {
+      if (value.type() != Value::Type::NUMBER) return false;
+      out.push_back(value.toDouble());
+    }
+    return true;
+  }
+  return false;
+}
+
 Value LcFor::evaluate(const std::shared_ptr<const Context>& context) const
 {
   EmbeddedVectorType vec(context->session());
   std::function<void(size_t)> reserve = [&vec](size_t capacity) {
     vec.reserve(capacity);
   };
-  forEach(this->arguments, this->loc, context,
-          [&vec, expression = expr.get()] (const std::shared_ptr<const Context>& iterationContext) {
+  auto operation = [&vec, expression = expr.get()] (const std::shared_ptr<const Context>& iterationContext) {
     vec.emplace_back(expression->evaluate(iterationContext));
-  }, &reserve);
+  };
+  if (this->arguments.size() != 1) {
+    forEach(this->arguments, this->loc, context, operation, &reserve);
+    return {std::move(vec)};
+  }
+
+  // Single variable loops over many numbers with a purely numeric body are
+  // compiled and evaluated in parallel; everything else takes the generic path.
+  Value variable_values = this->arguments[0]->getExpr()->evaluate(context);
+  std::vector<double> loop_values;
+  if (numericLoopValues(variable_values, loop_values) && loop_values.size() >= parallelKernelThreshold) {
+    if (auto kernel = NumericKernel::compile(expr.get(), this->arguments[0]->getName(), context)) {
+      const size_t stride = kernel->resultSize();
+      std::vector<double> results(loop_values.size() * stride);
+      parallelizable_for(0, loop_values.size(), [&](size_t i) {
+        kernel->evaluate(loop_values[i], results.data() + i * stride);
+      });
+      vec.reserve(loop_values.size());
+      for (size_t i = 0; i < loop_values.size(); ++i) {
+        vec.emplace_back(kernel->toValue(results.data() + i * stride, context->session()));
+      }
+      return {std::move(vec)};
+    }
+  }
+  doForEachValues(this->arguments, this->loc, operation, 0, context, std::move(variable_values), &reserve);
   return {std::move(vec)};
 }
 
@@ -34,6 +34,8 @@ public:
   };
   [[nodiscard]] bool isLiteral() const override;
   UnaryOp(Op op, Expression *expr, const Location& loc);
+  [[nodiscard]] Op getOp() const { return op; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -70,6 +72,9 @@ public:
   };
 
   BinaryOp(Expression *left, Op op, Expression *right, const Location& loc);
+  [[nodiscard]] Op getOp() const { return op; }
+  [[nodiscard]] const Expression *getLeft() const { return left.get(); }
+  [[nodiscard]] const Expression *getRight() const { return right.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -86,6 +91,9 @@ class TernaryOp : public Expression
 {
 public:
   TernaryOp(Expression *cond, Expression *ifexpr, Expression *elseexpr, const Location& loc);
+  [[nodiscard]] const Expression *getCond() const { return cond.get(); }
+  [[nodiscard]] const Expression *getIfExpr() const { return ifexpr.get(); }
+  [[nodiscard]] const Expression *getElseExpr() const { return elseexpr.get(); }
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
@@ -100,6 +108,8 @@ class ArrayLookup : public Expression
 {
 public:
   ArrayLookup(Expression *array, Expression *index, const Location& loc);
+  [[nodiscard]] const Expression *getArray() const { return array.get(); }
+  [[nodiscard]] const Expression *getIndex() const { return index.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -178,6 +188,8 @@ class MemberLookup : public Expression
 {
 public:
   MemberLookup(Expression *expr, std::string member, const Location& loc);
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
+  [[nodiscard]] const std::string& getMember() const { return member; }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -220,6 +232,8 @@ class Assert : public Expression
 {
 public:
   Assert(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   static void performAssert(const AssignmentList& arguments, const Location& location, const std::shared_ptr<const Context>& context);
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
@@ -234,6 +248,8 @@ class Echo : public Expression
 {
 public:
   Echo(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
@@ -247,6 +263,8 @@ class Texture : public Expression
 {
 public:
   Texture(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] const Expression *evaluateStep(const std::shared_ptr<const Context>& context) const;
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
@@ -259,6 +277,8 @@ class Let : public Expression
 {
 public:
   Let(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   static void doSequentialAssignment(const AssignmentList& assignments, const Location& location, ContextHandle<Context>& targetContext);
   static ContextHandle<Context> sequentialAssignmentContext(const AssignmentList& assignments, const Location& location, const std::shared_ptr<const Context>& context);
   const Expression *evaluateStep(ContextHandle<Context>& targetContext) const;
@@ -280,6 +300,9 @@ class LcIf : public ListComprehension
 {
 public:
   LcIf(Expression *cond, Expression *ifexpr, Expression *elseexpr, const Location& loc);
+  [[nodiscard]] const Expression *getCond() const { return cond.get(); }
+  [[nodiscard]] const Expression *getIfExpr() const { return ifexpr.get(); }
+  [[nodiscard]] const Expression *getElseExpr() const { return elseexpr.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -293,6 +316,8 @@ class LcFor : public ListComprehension
 {
 public:
   LcFor(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   static void forEach(const AssignmentList& assignments, const Location& loc, const std::shared_ptr<const Context>& context, const std::function<void(const std::shared_ptr<const Context>&)>& operation, const std::function<void(size_t)>* pReserve = nullptr);
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
@@ -306,6 +331,10 @@ class LcForC : public ListComprehension
 {
 public:
   LcForC(AssignmentList args, AssignmentList incrargs, Expression *cond, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const AssignmentList& getIncrArguments() const { return incr_arguments; }
+  [[nodiscard]] const Expression *getCond() const { return cond.get(); }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -320,6 +349,7 @@ class LcEach : public ListComprehension
 {
 public:
   LcEach(Expression *expr, const Location& loc);
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
@@ -332,6 +362,8 @@ class LcLet : public ListComprehension
 {
 public:
   LcLet(AssignmentList args, Expression *expr, const Location& loc);
+  [[nodiscard]] const AssignmentList& getArguments() const { return arguments; }
+  [[nodiscard]] const Expression *getExpr() const { return expr.get(); }
   [[nodiscard]] Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void print_python(std::ostream& stream, std::ostream& stream_def, const std::string& indent) const override;
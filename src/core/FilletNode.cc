@@ -34,6 +34,8 @@
 #include "Builtins.h"
 #include "handle_dep.h"
 #include "src/geometry/PolySetBuilder.h"
+#include "src/geometry/HalfEdgeMesh.h"
+#include "src/geometry/PointInPolyhedron.h"
 
 #include <cmath>
 #include <sstream>
@@ -69,29 +71,6 @@ std::shared_ptr<const PolySet> childToPolySet( std::shared_ptr<AbstractNode> chi
   return PolySetUtils::getGeometryAsPolySet(geom);
 }
 
-int point_in_polyhedron(const PolySet & ps, const Vector3d &pt) 
-{
-  // polygons are clockwise     
-  int cuts=0;
-  Vector3d vc(1,0,0);
-  Vector3d res;
-  for(size_t i=0;i<ps.indices.size();i++) {
-    const IndexedFace &f=ps.indices[i];	  
-    Vector3d va=ps.vertices[f[1]]-ps.vertices[f[0]];
-    Vector3d vb=ps.vertices[f[2]]-ps.vertices[f[0]];
-    if(linsystem(va, vb, vc,pt-ps.vertices[f[0]],res,nullptr)) continue;
-    if(res[2] < 0) continue;
-    if(res[0] >= -1e-6 && res[1] > -1e-6 && res[0]+res[1] <1+1e-6){
-	    if(res[0] > 0 && res[1] > 0 && res[0]+res[1] <1 ) cuts += 2;
-	    if(fabs(res[0]) < 1e-6 ) cuts++;
-	    if(fabs(res[1]) < 1e-6 ) cuts++;
-	    if(fabs(res[0]+res[1]-1) < 1e-6) cuts++;
-    }
-  }
-  cuts /=2;
-  return cuts&1;
-}
-
 // Credit: inphase Ryan Colyer
 Vector3d Bezier(double t, Vector3d a, Vector3d b, Vector3d c)
 {
@@ -175,6 +154,26 @@ void debug_pt(const char *msg, Vector3d pt) {
   printf("%s %g/%g/%g\n",msg, pt[0], pt[1], pt[2]);	
 }
 
+// Edges between two faces of mesh, one per half-edge pair of the HalfEdgeMesh:
+// facea/posa locate the half-edge h, faceb/posb its twin
+static std::vector<std::pair<EdgeKey, EdgeVal>> createFilletEdges(const HalfEdgeMesh& mesh)
+{
+  std::vector<std::pair<EdgeKey, EdgeVal>> edges;
+  edges.reserve(mesh.edges().size());
+  for(const int h : mesh.edges()) {
+    const int t=mesh.twin(h);
+    if(t == -1) continue;
+    EdgeVal val;
+    val.sel=0;
+    val.facea=mesh.face(h);
+    val.posa=mesh.position(h);
+    val.faceb=mesh.face(t);
+    val.posb=mesh.position(t);
+    edges.emplace_back(EdgeKey(mesh.origin(h), mesh.target(h)), val);
+  }
+  return edges;
+}
+
 std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> ps,  std::vector<bool> corner_selected, double r_, int bn, double minang)
 {
   double cos_minang=cos(minang*3.1415/180.0);	
@@ -189,36 +188,21 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
   auto vertices_copy = ps->vertices;
 
   bool improved=false;
-  std::unordered_map<EdgeKey, EdgeVal, boost::hash<EdgeKey> > edge_db;
-  std::vector<intList> polinds, polposs;
+  std::vector<std::pair<EdgeKey, EdgeVal>> edge_db;
+  std::unique_ptr<HalfEdgeMesh> mesh;
 
   std::vector<std::vector<int>> corner_rounds ; 
   do {
     improved=false; // fix short edges until happy
     std::vector<int> lockouts;		    
 
-    polinds.clear();
-    polposs.clear();
-    intList empty;
-    for(size_t i=0;i<vertices_copy.size();i++) {
-      polinds.push_back(empty);	  
-      polposs.push_back(empty);	  
-    }
-    for(size_t i=0;i<merged.size();i++) {
-      for(size_t j=0;j<merged[i].size();j++) {
-        int ind=merged[i][j];	    
-        polinds[ind].push_back(i);
-        polposs[ind].push_back(j);
-      }	    
-    }
-
-    // create Edge DB
-
-    edge_db= createEdgeDb(merged); 
+    // faces around each vertex and the edges between faces
+    mesh = std::make_unique<HalfEdgeMesh>(merged, vertices_copy.size());
+    edge_db = createFilletEdges(*mesh);
 
     // which rounded edges in a corner coner_rounds[vert]=[other_verts]
     corner_rounds.clear();
-    for(size_t i=0;i<vertices_copy.size();i++) corner_rounds.push_back(empty);				  
+    corner_rounds.resize(vertices_copy.size());
 
   
     for(auto &e: edge_db) {
@@ -233,8 +217,8 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
         double d=fan.dot(fbn);
         e.second.sel=0;
         if(d >= cos_minang) continue; // dont create facets when the angle conner is too small
-        if(polinds[e.first.ind1].size() != 3) continue; // start must be 3edge corner
-        if(polinds[e.first.ind2].size() != 3) continue; // start must be 3edge corner
+        if(mesh->outgoing(e.first.ind1).size() != 3) continue; // start must be 3edge corner
+        if(mesh->outgoing(e.first.ind2).size() != 3) continue; // start must be 3edge corner
 
         e.second.sel=1;
         corner_rounds[e.first.ind1].push_back(e.first.ind2);
@@ -365,7 +349,7 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
   }
 
   SearchReplace s;
-  std::vector<SearchReplace> sp;
+  std::vector<std::vector<SearchReplace>> sp(merged.size()); // modifications per face
 
   // plan fillets of all edges now
   for(auto &e: edge_db) {
@@ -516,45 +500,45 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
       s.pol=e.second.facea; // laengsseite1
       s.search=e.first.ind1;
       s.replace={e.second.bez1[0]};
-      sp.push_back(s);
+      sp[s.pol].push_back(s);
       s.pol=e.second.facea; // laengsseite1
       s.search=e.first.ind2 ;
       s.replace={ e.second.bez2[0]};
-      sp.push_back(s);
+      sp[s.pol].push_back(s);
 
       s.pol=e.second.faceb; // laengsseite2
       s.search=e.first.ind2 ;
       s.replace={e.second.bez2[bn-1]};
-      sp.push_back(s);
+      sp[s.pol].push_back(s);
       s.pol=e.second.faceb; // laengsseite2
       s.search=e.first.ind1 ;
       s.replace={e.second.bez1[bn-1]};
-      sp.push_back(s);
+      sp[s.pol].push_back(s);
 
       // stirnseite 1
       if(corner_rounds[e.first.ind1].size() == 1) {
-        for(size_t i=0;i<polinds[e.first.ind1].size();i++) { 
-          int faceid=polinds[e.first.ind1][i];
+        for(const int h : mesh->outgoing(e.first.ind1)) { 
+          int faceid=mesh->face(h);
           if(faceid == e.second.facea) continue;       
           if(faceid == e.second.faceb) continue;       
 	  s.pol=faceid; // stirnseite1
           s.search=e.first.ind1 ;
           s.replace={e.second.bez1};
 	  std::reverse(s.replace.begin(), s.replace.end());
-          sp.push_back(s);
+          sp[s.pol].push_back(s);
         }   
       }	
       
       //stirnseite2
       if(corner_rounds[e.first.ind2].size() == 1) {
-        for(size_t i=0;i<polinds[e.first.ind2].size();i++) {
-          int faceid=polinds[e.first.ind2][i];
+        for(const int h : mesh->outgoing(e.first.ind2)) {
+          int faceid=mesh->face(h);
           if(faceid == e.second.facea) continue;       
           if(faceid == e.second.faceb) continue;       
 	  s.pol=faceid; // stirnseite2
           s.search=e.first.ind2 ;
           s.replace={e.second.bez2};
-          sp.push_back(s);
+          sp[s.pol].push_back(s);
         }   
      }	
 //     printf("\nNum=%d\n",debug);
@@ -574,22 +558,20 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
     }      
     int fn=newface.size();
     // does newface need any mods ?
-    for(size_t j=0;j<sp.size();j++){ // TODO effektiver, sp sortiren und 0 groesser machen
-      if((size_t) sp[j].pol == i) {
-        int needle=sp[j].search;
-	for(int k=0;k<fn;k++) { // all possible shifts
-          if(newface[k] == needle) {
-	    // match bei shift k gefunden
-	    IndexedFace tmp=sp[j].replace;
-	    for(int l=0;l<fn-1;l++) {
-             tmp.push_back(newface[(k+1+l)%fn]);		    
-	    }
-	    newface=tmp;
-	    fn=newface.size();
-	    break;
-	  }  
-	}
-      }	      
+    for(const auto &mod : sp[i]) {
+      int needle=mod.search;
+      for(int k=0;k<fn;k++) { // all possible shifts
+        if(newface[k] == needle) {
+	  // match bei shift k gefunden
+	  IndexedFace tmp=mod.replace;
+	  for(int l=0;l<fn-1;l++) {
+            tmp.push_back(newface[(k+1+l)%fn]);		    
+	  }
+	  newface=tmp;
+	  fn=newface.size();
+	  break;
+	}  
+      }
     }
 
     newfaces.push_back(newface);
@@ -633,19 +615,20 @@ std::unique_ptr<const Geometry> createFilletInt(std::shared_ptr<const PolySet> p
     }
     else if(corner_rounds[i].size() == 3) {
       // now get the right ordering of corner_rounds[i]
+      const auto corner = mesh->outgoing(i);
       IndexedFace face[3];
       Vector3d facenorm[3];
       for(int j=0;j<3;j++) {
-        face[j] =merged[polinds[i][j]];
+        face[j] =merged[mesh->face(corner[j])];
         facenorm[j] = calcTriangleNormal(vertices_copy, face[j]).head<3>();
-        if(faceParents[polinds[i][j]]  != -1) facenorm[j] = -facenorm[j];
+        if(faceParents[mesh->face(corner[j])]  != -1) facenorm[j] = -facenorm[j];
       }
 
       int facebeg[3];
       int faceend[3];
       for(int j=0;j<3;j++){	     
-        facebeg[j]=face[j][(polposs[i][j]+face[j].size()-1)%face[j].size()];
-        faceend[j]=face[j][(polposs[i][j]+1)%face[j].size()];
+        facebeg[j]=mesh->origin(mesh->prev(corner[j]));
+        faceend[j]=mesh->target(corner[j]);
       }
 
       std::vector<int> angle;
@@ -710,9 +693,9 @@ std::unique_ptr<const Geometry> FilletNode::createGeometry() const
   if(this->children.size() >= 2) {
     std::shared_ptr<const PolySet> sel = childToPolySet(this->children[1]);
     if(sel != nullptr) {
-      auto sel_tess=PolySetUtils::tessellate_faces(*sel);
+      auto inside = PointInPolyhedron::get(sel);
       for(size_t i=0;i<ps->vertices.size();i++) {
-        corner_selected.push_back(point_in_polyhedron(*sel_tess, ps->vertices[i]));
+        corner_selected.push_back(inside->contains(ps->vertices[i]));
       }
     }
 
@@ -31,6 +31,7 @@
 #include <memory>
 #include <cmath>
 #include <cstdio>
+#include <string>
 #include <vector>
 
 
@@ -42,6 +43,7 @@
 
 #include "FontCache.h"
 #include "core/DrawingCallback.h"
+#include "core/GlyphCache.h"
 #include "utils/calc.h"
 
 #include FT_OUTLINE_H
@@ -101,9 +103,9 @@ void FreetypeRenderer::ShapeResults::calc_offsets_horiz(
   const FreetypeRenderer::Params& params)
 {
   if (params.halign == "right") {
-    x_offset = -advance_x;
+    x_offset = -shape->advance_x;
   } else if (params.halign == "center") {
-    x_offset = -advance_x / 2.0;
+    x_offset = -shape->advance_x / 2.0;
   } else if (params.halign == "left" || params.halign == "default") {
     x_offset = 0;
   } else {
@@ -115,12 +117,12 @@ void FreetypeRenderer::ShapeResults::calc_offsets_horiz(
   }
 
   if (params.valign == "top") {
-    y_offset = -ascent;
+    y_offset = -shape->ascent;
   } else if (params.valign == "center") {
-    double height = ascent - descent;
-    y_offset = -height / 2 - descent;
+    double height = shape->ascent - shape->descent;
+    y_offset = -height / 2 - shape->descent;
   } else if (params.valign == "bottom") {
-    y_offset = -descent;
+    y_offset = -shape->descent;
   } else if (params.valign == "baseline" || params.valign == "default") {
     y_offset = 0;
   } else {
@@ -137,9 +139,9 @@ void FreetypeRenderer::ShapeResults::calc_offsets_vert(
   const FreetypeRenderer::Params& params)
 {
   if (params.halign == "right") {
-    x_offset = -right;
+    x_offset = -shape->right;
   } else if (params.halign == "left") {
-    x_offset = -left;
+    x_offset = -shape->left;
   } else if (params.halign == "center" || params.halign == "default") {
     x_offset = 0;
   } else {
@@ -156,9 +158,9 @@ void FreetypeRenderer::ShapeResults::calc_offsets_vert(
         params.valign);
     y_offset = 0;
   } else if (params.valign == "center") {
-    y_offset = -advance_y / 2.0;
+    y_offset = -shape->advance_y / 2.0;
   } else if (params.valign == "bottom") {
-    y_offset = -advance_y;
+    y_offset = -shape->advance_y;
   } else if (params.valign == "top" || params.valign == "default") {
     // Note that in vertical mode HarfBuzz sets the glyphs
     // below their origins, so this results in the entire string
@@ -319,17 +321,31 @@ void FreetypeRenderer::Params::set(Parameters& parameters)
 }
 
 
-FreetypeRenderer::ShapeResults::ShapeResults(
+std::shared_ptr<const ShapedText> FreetypeRenderer::shape_text(
   const FreetypeRenderer::Params& params)
 {
+  // Alignment is applied per call, so halign/valign are not part of the key
+  char spacing[32];
+  snprintf(spacing, sizeof(spacing), "%a", params.spacing);
+  std::string key = params.font;
+  for (const auto& part : {params.text, params.direction, params.language, params.script, std::string(spacing)}) {
+    key += '\0';
+    key += part;
+  }
+
+  if (auto cached = GlyphCache::instance()->getShape(key)) {
+    return cached;
+  }
+  const size_t messages = print_messages_count;
+
   const FontFacePtr face = params.get_font_face();
   if (!face) {
-    return;
+    return nullptr;
   }
 
-  hb_ft_font = hb_ft_font_create(face->face_, nullptr);
+  hb_font_t *hb_ft_font = hb_ft_font_create(face->face_, nullptr);
 
-  hb_buf = hb_buffer_create();
+  hb_buffer_t *hb_buf = hb_buffer_create();
   hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
   hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
   hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
@@ -375,7 +391,17 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
   hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
 
-  glyph_array.reserve(glyph_count);
+  auto shape = std::make_shared<ShapedText>();
+  shape->glyphs.reserve(glyph_count);
+  shape->horizontal = HB_DIRECTION_IS_HORIZONTAL(hb_buffer_get_direction(hb_buf));
+
+  shape->ascent = std::numeric_limits<double>::lowest();
+  shape->descent = std::numeric_limits<double>::max();
+  shape->left = std::numeric_limits<double>::max();
+  shape->right = std::numeric_limits<double>::lowest();
+  shape->bottom = std::numeric_limits<double>::max();
+  shape->top = std::numeric_limits<double>::lowest();
+
   for (unsigned int idx = 0; idx < glyph_count; ++idx) {
     FT_Error error;
     FT_UInt glyph_index = glyph_info[idx].codepoint;
@@ -398,21 +424,14 @@ FreetypeRenderer::ShapeResults::ShapeResults(
       continue;
     }
 
-    glyph_array.emplace_back(glyph, idx, &glyph_pos[idx]);
-  }
-
-  ascent = std::numeric_limits<double>::lowest();
-  descent = std::numeric_limits<double>::max();
-  advance_x = 0;
-  advance_y = 0;
-  left = std::numeric_limits<double>::max();
-  right = std::numeric_limits<double>::lowest();
-  bottom = std::numeric_limits<double>::max();
-  top = std::numeric_limits<double>::lowest();
-
-  for (const auto& glyph : glyph_array) {
     FT_BBox bbox;
-    FT_Glyph_Get_CBox(glyph.get_glyph(), FT_GLYPH_BBOX_GRIDFIT, &bbox);
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_GRIDFIT, &bbox);
+    FT_Done_Glyph(glyph);
+
+    const ShapedText::Glyph g{glyph_index,
+                              glyph_pos[idx].x_offset / scale, glyph_pos[idx].y_offset / scale,
+                              glyph_pos[idx].x_advance / scale, glyph_pos[idx].y_advance / scale};
+    shape->glyphs.push_back(g);
 
     // Note that glyphs can extend left of their origin
     // and right of their advance-width, into the next
@@ -424,61 +443,111 @@ FreetypeRenderer::ShapeResults::ShapeResults(
     // ink and so do not contribute to the bounding box or
     // ascent and descent.
     if (bbox.xMax > bbox.xMin && bbox.yMax > bbox.yMin) {
-      ascent = std::max(ascent, bbox.yMax / scale);
-      descent = std::min(descent, bbox.yMin / scale);
-
-      const double gxoff = glyph.get_x_offset();
-      const double gyoff = glyph.get_y_offset();
-
-      left = std::min(left,
-                      advance_x + gxoff + bbox.xMin / scale);
-      right = std::max(right,
-                       advance_x + gxoff + bbox.xMax / scale);
-
-      top = std::max(top,
-                     advance_y + gyoff + bbox.yMax / scale);
-      bottom = std::min(bottom,
-                        advance_y + gyoff + bbox.yMin / scale);
+      shape->ascent = std::max(shape->ascent, bbox.yMax / scale);
+      shape->descent = std::min(shape->descent, bbox.yMin / scale);
+
+      shape->left = std::min(shape->left,
+                             shape->advance_x + g.x_offset + bbox.xMin / scale);
+      shape->right = std::max(shape->right,
+                              shape->advance_x + g.x_offset + bbox.xMax / scale);
+
+      shape->top = std::max(shape->top,
+                            shape->advance_y + g.y_offset + bbox.yMax / scale);
+      shape->bottom = std::min(shape->bottom,
+                               shape->advance_y + g.y_offset + bbox.yMin / scale);
     }
 
-    advance_x += glyph.get_x_advance() * params.spacing;
-    advance_y += glyph.get_y_advance() * params.spacing;
+    shape->advance_x += g.x_advance * params.spacing;
+    shape->advance_y += g.y_advance * params.spacing;
   }
 
+  hb_buffer_destroy(hb_buf);
+  hb_font_destroy(hb_ft_font);
+
   // Right and left start out reversed.  If any ink is ever
   // contributed they will flip.  If they're still reversed,
   // there was no ink.
-  if (right >= left) {
-    if (HB_DIRECTION_IS_HORIZONTAL(
-          hb_buffer_get_direction(hb_buf))) {
+  shape->ink = shape->right >= shape->left;
+  if (!shape->ink) {
+    shape->left = 0;
+    shape->right = 0;
+    shape->top = 0;
+    shape->bottom = 0;
+    shape->ascent = 0;
+    shape->descent = 0;
+  }
+
+  // Warnings can't be replayed from the cache, so only clean results are kept
+  if (print_messages_count == messages) {
+    GlyphCache::instance()->insertShape(key, shape);
+  }
+  return shape;
+}
+
+FreetypeRenderer::ShapeResults::ShapeResults(
+  const FreetypeRenderer::Params& params)
+{
+  shape = shape_text(params);
+  if (!shape) {
+    return;
+  }
+
+  if (shape->ink) {
+    if (shape->horizontal) {
       calc_offsets_horiz(params);
     } else {
       calc_offsets_vert(params);
     }
-  } else {
-    left = 0;
-    right = 0;
-    top = 0;
-    bottom = 0;
-    ascent = 0;
-    descent = 0;
-    x_offset = 0;
-    y_offset = 0;
   }
 
   ok = true;
 }
 
-FreetypeRenderer::ShapeResults::~ShapeResults()
+std::shared_ptr<const GlyphOutline> FreetypeRenderer::glyph_outline(
+  const FreetypeRenderer::Params& params, FontFacePtr& face, unsigned int glyph_index) const
 {
-  if (hb_buf != nullptr) {
-    hb_buffer_destroy(hb_buf);
-    hb_buf = nullptr;
+  // Outlines are em-relative; size only scales them at replay time
+  std::string key = params.font;
+  key += '\0';
+  key += std::to_string(glyph_index);
+  key += '\0';
+  key += std::to_string(params.segments);
+
+  if (auto cached = GlyphCache::instance()->getOutline(key)) {
+    return cached;
   }
-  if (hb_ft_font != nullptr) {
-    hb_font_destroy(hb_ft_font);
-    hb_ft_font = nullptr;
+
+  if (!face) {
+    face = params.get_font_face();
+    if (!face) {
+      return nullptr;
+    }
+  }
+
+  if (FT_Load_Glyph(face->face_, glyph_index, FT_LOAD_DEFAULT)) {
+    return nullptr;
+  }
+  FT_Glyph glyph;
+  if (FT_Get_Glyph(face->face_->glyph, &glyph)) {
+    return nullptr;
   }
+
+  auto outline = std::make_shared<GlyphOutline>();
+  if (glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+    // Record the flattened contours at unit size and without offset
+    DrawingCallback recorder(params.segments, 1.0);
+    recorder.start_glyph();
+    FT_Outline ft_outline = reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
+    FT_Outline_Decompose(&ft_outline, &funcs, &recorder);
+    recorder.finish_glyph();
+    for (const auto& polygon : recorder.get_result()) {
+      outline->insert(outline->end(), polygon->outlines().begin(), polygon->outlines().end());
+    }
+  }
+  FT_Done_Glyph(glyph);
+
+  GlyphCache::instance()->insertOutline(key, outline);
+  return outline;
 }
 
 FreetypeRenderer::FontMetrics::FontMetrics(
@@ -535,21 +604,21 @@ FreetypeRenderer::TextMetrics::TextMetrics(
   // Nothing bad will happen below as a result of these zeroes.
   // We will return a zero-size bounding box at the origin.
   // The advance_[xy] values will be valid and may be non-zero.
-  bbox_x = (sr.x_offset + sr.left) * params.size;
-  bbox_y = (sr.y_offset + sr.bottom) * params.size;
-  bbox_w = (sr.right - sr.left) * params.size;
-  bbox_h = (sr.top - sr.bottom) * params.size;
+  bbox_x = (sr.x_offset + sr.shape->left) * params.size;
+  bbox_y = (sr.y_offset + sr.shape->bottom) * params.size;
+  bbox_w = (sr.shape->right - sr.shape->left) * params.size;
+  bbox_h = (sr.shape->top - sr.shape->bottom) * params.size;
 
-  advance_x = sr.advance_x * params.size;
-  advance_y = sr.advance_y * params.size;
+  advance_x = sr.shape->advance_x * params.size;
+  advance_y = sr.shape->advance_y * params.size;
 
   // As with the bounding box, these can be [0,0] if there
   // would be no ink produced.
   // Note: Strictly, I don't know think ascent and descent are needed.
   // I think they are derivable from the bounding box and the
   // offsets.
-  ascent = sr.ascent * params.size;
-  descent = sr.descent * params.size;
+  ascent = sr.shape->ascent * params.size;
+  descent = sr.shape->descent * params.size;
 
   // The offset values reflect what halign/valign *actually do*
   // to the text.
@@ -567,17 +636,19 @@ std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(const Fre
     return {};
   }
 
+  FontFacePtr face;
   DrawingCallback callback(params.segments, params.size);
-  for (const auto& glyph : sr.glyph_array) {
+  for (const auto& glyph : sr.shape->glyphs) {
     callback.start_glyph();
     callback.set_glyph_offset(
-      sr.x_offset + glyph.get_x_offset(),
-      sr.y_offset + glyph.get_y_offset());
-    FT_Outline outline = reinterpret_cast<FT_OutlineGlyph>(glyph.get_glyph())->outline;
-    FT_Outline_Decompose(&outline, &funcs, &callback);
+      sr.x_offset + glyph.x_offset,
+      sr.y_offset + glyph.y_offset);
+    if (const auto outline = glyph_outline(params, face, glyph.index)) {
+      callback.add_outlines(*outline);
+    }
 
-    double adv_x = glyph.get_x_advance() * params.spacing;
-    double adv_y = glyph.get_y_advance() * params.spacing;
+    double adv_x = glyph.x_advance * params.spacing;
+    double adv_y = glyph.y_advance * params.spacing;
     callback.add_glyph_advance(adv_x, adv_y);
     callback.finish_glyph();
   }
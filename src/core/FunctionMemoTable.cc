@@ -0,0 +1,135 @@
+#include "core/FunctionMemoTable.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <boost/optional.hpp>
+
+#include "core/Context.h"
+#include "core/function.h"
+#include "core/Value.h"
+
+namespace {
+
+template <typename T>
+void appendBytes(std::string& key, const T& data)
+{
+  key.append(reinterpret_cast<const char *>(&data), sizeof(data));
+}
+
+/*
+ * Appends a bitwise exact encoding of value to key. Numbers are encoded by
+ * their bit pattern so e.g. 0 and -0 are kept apart.
+ * Returns false for values that cannot take part in memoization.
+ */
+bool appendValueKey(const Value& value, std::string& key)
+{
+  switch (value.type()) {
+  case Value::Type::UNDEFINED:
+    key += 'u';
+    return true;
+  case Value::Type::BOOL:
+    key += value.toBool() ? 't' : 'f';
+    return true;
+  case Value::Type::NUMBER:
+    key += 'n';
+    appendBytes(key, value.toDouble());
+    return true;
+  case Value::Type::STRING: {
+    const std::string& str = value.toStrUtf8Wrapper().toString();
+    key += 's';
+    appendBytes(key, str.size());
+    key += str;
+    return true;
+  }
+  case Value::Type::VECTOR: {
+    const VectorType& vec = value.toVector();
+    key += 'v';
+    appendBytes(key, vec.size());
+    for (const auto& element : vec) {
+      if (!appendValueKey(element, key)) return false;
+    }
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+/*
+ * Approximate memory used by value, or boost::none if value cannot be
+ * stored in the memo table.
+ */
+boost::optional<size_t> valueSize(const Value& value)
+{
+  switch (value.type()) {
+  case Value::Type::UNDEFINED:
+  case Value::Type::BOOL:
+  case Value::Type::NUMBER:
+    return sizeof(Value);
+  case Value::Type::STRING:
+    return sizeof(Value) + value.toStrUtf8Wrapper().toString().size();
+  case Value::Type::VECTOR: {
+    size_t size = sizeof(Value);
+    for (const auto& element : value.toVector()) {
+      auto elementSize = valueSize(element);
+      if (!elementSize) return boost::none;
+      size += *elementSize;
+    }
+    return size;
+  }
+  default:
+    return boost::none;
+  }
+}
+
+} // namespace
+
+bool FunctionMemoTable::shouldMemoize(const UserFunction *function)
+{
+  return ++callCounts[function] > 1;
+}
+
+bool FunctionMemoTable::makeKey(const UserFunction *function, const std::shared_ptr<const Context>& defining_context,
+                                const std::shared_ptr<const Context>& body_context, std::string& key)
+{
+  key.clear();
+  appendBytes(key, function);
+  appendBytes(key, defining_context.get());
+  for (const auto& parameter : function->parameters) {
+    boost::optional<const Value&> value = body_context->lookup_local_variable(parameter->getName());
+    if (!value || !appendValueKey(*value, key)) return false;
+  }
+  return true;
+}
+
+boost::optional<Value> FunctionMemoTable::lookup(const std::string& key, const std::shared_ptr<const Context>& defining_context)
+{
+  memo_entry *entry = cache[key];
+  // The defining context address is part of the key; make sure it has not
+  // been reused by a different context since the entry was stored.
+  if (entry && entry->defining_context.lock() == defining_context) {
+    hits++;
+    return entry->result.clone();
+  }
+  misses++;
+  return boost::none;
+}
+
+void FunctionMemoTable::insert(const std::string& key, const std::shared_ptr<const Context>& defining_context, const Value& result)
+{
+  auto size = valueSize(result);
+  if (!size) return;
+  cache.insert(key, new memo_entry(defining_context, result.clone()), key.size() + *size);
+}
+
+FunctionMemoStatistic FunctionMemoTable::statistic() const
+{
+  FunctionMemoStatistic statistic;
+  statistic.hits = hits;
+  statistic.misses = misses;
+  statistic.entries = cache.size();
+  statistic.bytes = cache.totalCost();
+  return statistic;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <boost/optional.hpp>
+
+#include "Cache.h"
+#include "core/Value.h"
+
+class Context;
+class UserFunction;
+
+struct FunctionMemoStatistic
+{
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+};
+
+/*
+ * Memo table for user defined functions, owned by an EvaluationSession.
+ *
+ * Results are keyed by the function, the context it was defined in, and a
+ * bitwise exact encoding of the parameter values. Only calls whose arguments
+ * and result consist of plain data (undef, booleans, numbers, strings and
+ * vectors thereof) are memoized. A result is only stored when evaluating the
+ * call had no observable side effects, see EvaluationSession::sideEffectCount().
+ *
+ * Memory use is bounded; least recently used results are evicted first.
+ */
+class FunctionMemoTable
+{
+public:
+  FunctionMemoTable(size_t memorylimit = 64ul * 1024ul * 1024ul) : cache(memorylimit) {}
+
+  /*
+   * Returns true if calls to the given function should be memoized.
+   * Functions are only memoized from their second call on, to avoid paying
+   * for key construction on functions called just once.
+   */
+  bool shouldMemoize(const UserFunction *function);
+
+  /*
+   * Builds the memo key for a call of function, whose parameters have been
+   * bound in body_context. Returns false if the call cannot be memoized.
+   */
+  static bool makeKey(const UserFunction *function, const std::shared_ptr<const Context>& defining_context,
+                      const std::shared_ptr<const Context>& body_context, std::string& key);
+
+  boost::optional<Value> lookup(const std::string& key, const std::shared_ptr<const Context>& defining_context);
+  void insert(const std::string& key, const std::shared_ptr<const Context>& defining_context, const Value& result);
+
+  [[nodiscard]] FunctionMemoStatistic statistic() const;
+
+private:
+  struct memo_entry {
+    std::weak_ptr<const Context> defining_context;
+    Value result;
+    memo_entry(const std::shared_ptr<const Context>& defining_context, Value result)
+      : defining_context(defining_context), result(std::move(result)) {}
+  };
+
+  Cache<std::string, memo_entry> cache;
+  std::unordered_map<const UserFunction *, size_t> callCounts;
+  size_t hits = 0;
+  size_t misses = 0;
+};
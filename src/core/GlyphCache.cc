@@ -0,0 +1,96 @@
+#include "core/GlyphCache.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "utils/printutils.h"
+
+GlyphCache *GlyphCache::inst = nullptr;
+
+std::shared_ptr<const ShapedText> GlyphCache::getShape(const std::string& key) const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (const auto *entry = this->shapes[key]) {
+    ++shape_hits;
+    return entry->shape;
+  }
+  ++shape_misses;
+  return nullptr;
+}
+
+void GlyphCache::insertShape(const std::string& key, const std::shared_ptr<const ShapedText>& shape)
+{
+  const size_t cost = key.size() + sizeof(ShapedText) + shape->glyphs.size() * sizeof(ShapedText::Glyph);
+  const std::lock_guard<std::mutex> lock(mutex);
+  this->shapes.insert(key, new shape_entry{shape}, cost);
+}
+
+std::shared_ptr<const GlyphOutline> GlyphCache::getOutline(const std::string& key) const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (const auto *entry = this->outlines[key]) {
+    ++outline_hits;
+    return entry->outline;
+  }
+  ++outline_misses;
+  return nullptr;
+}
+
+void GlyphCache::insertOutline(const std::string& key, const std::shared_ptr<const GlyphOutline>& outline)
+{
+  size_t cost = key.size() + sizeof(GlyphOutline);
+  for (const auto& o : *outline) {
+    cost += sizeof(Outline2d) + o.vertices.size() * sizeof(Vector2d);
+  }
+  const std::lock_guard<std::mutex> lock(mutex);
+  this->outlines.insert(key, new outline_entry{outline}, cost);
+}
+
+size_t GlyphCache::size() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return shapes.size() + outlines.size();
+}
+
+size_t GlyphCache::totalCost() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return shapes.totalCost() + outlines.totalCost();
+}
+
+size_t GlyphCache::maxSizeMB() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return (shapes.maxCost() + outlines.maxCost()) / (1024ul * 1024ul);
+}
+
+size_t GlyphCache::hits() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return shape_hits + outline_hits;
+}
+
+size_t GlyphCache::misses() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return shape_misses + outline_misses;
+}
+
+void GlyphCache::clear()
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  this->shapes.clear();
+  this->outlines.clear();
+}
+
+void GlyphCache::print()
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  // Only report once text has actually been rendered
+  if (shape_hits + outline_hits + shape_misses + outline_misses == 0) return;
+  LOG("Shaped texts in cache: %1$d (%2$d hits, %3$d misses)", this->shapes.size(), shape_hits, shape_misses);
+  LOG("Glyph outlines in cache: %1$d (%2$d hits, %3$d misses)", this->outlines.size(), outline_hits, outline_misses);
+  LOG("Glyph cache size in bytes: %1$d", shapes.totalCost() + outlines.totalCost());
+}
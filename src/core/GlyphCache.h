@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Cache.h"
+#include "geometry/Polygon2d.h"
+
+/*
+ * Result of shaping a string with HarfBuzz. All values are in fractions of
+ * the font size. Alignment is not part of the shape, it is applied by the
+ * caller from the bounding box.
+ */
+struct ShapedText
+{
+  struct Glyph {
+    unsigned int index; // glyph index in the font face
+    double x_offset;
+    double y_offset;
+    double x_advance;
+    double y_advance;
+  };
+  std::vector<Glyph> glyphs;
+  bool horizontal{true};
+  bool ink{false}; // false if no glyph has a non-empty bounding box
+  double left{0.0};
+  double right{0.0};
+  double top{0.0};
+  double bottom{0.0};
+  double advance_x{0.0};
+  double advance_y{0.0};
+  double ascent{0.0};
+  double descent{0.0};
+};
+
+/*
+ * Flattened contours of a single glyph, in fractions of the font size and
+ * relative to the glyph origin.
+ */
+using GlyphOutline = std::vector<Outline2d>;
+
+/*
+ * Caches text shaping results per (font, text, layout parameters) and
+ * flattened glyph outlines per (font, glyph, segments), so repeated text()
+ * calls neither reshape nor re-tessellate the same glyphs. Safe to use from
+ * several threads.
+ */
+class GlyphCache
+{
+public:
+  GlyphCache(size_t memorylimit = 16ul * 1024ul * 1024ul) : shapes(memorylimit / 2), outlines(memorylimit / 2) {}
+
+  static GlyphCache *instance() { if (!inst) inst = new GlyphCache; return inst; }
+
+  std::shared_ptr<const ShapedText> getShape(const std::string& key) const;
+  void insertShape(const std::string& key, const std::shared_ptr<const ShapedText>& shape);
+  std::shared_ptr<const GlyphOutline> getOutline(const std::string& key) const;
+  void insertOutline(const std::string& key, const std::shared_ptr<const GlyphOutline>& outline);
+
+  size_t size() const;
+  size_t totalCost() const;
+  size_t maxSizeMB() const;
+  size_t hits() const;
+  size_t misses() const;
+  void clear();
+  void print();
+
+private:
+  static GlyphCache *inst;
+
+  struct shape_entry {
+    std::shared_ptr<const ShapedText> shape;
+  };
+  struct outline_entry {
+    std::shared_ptr<const GlyphOutline> outline;
+  };
+
+  mutable std::mutex mutex;
+  Cache<std::string, shape_entry> shapes;
+  Cache<std::string, outline_entry> outlines;
+  mutable size_t shape_hits{0}, shape_misses{0};
+  mutable size_t outline_hits{0}, outline_misses{0};
+};
@@ -8,6 +8,7 @@
 #include "utils/compiler_specific.h"
 #include "core/Context.h"
 #include "core/Expression.h"
+#include "core/Profiler.h"
 #include "utils/exceptions.h"
 #include "utils/printutils.h"
 #ifdef ENABLE_PYTHON
@@ -114,6 +115,8 @@ static void NOINLINE print_trace(const ModuleInstantiation *mod, const std::shar
 
 std::shared_ptr<AbstractNode> ModuleInstantiation::evaluate(const std::shared_ptr<const Context>& context) const
 {
+  context->session()->checkCancel();
+  const Profiler::Scope profile("module", this->name(), this->loc);
   boost::optional<InstantiableModule> module = context->lookup_module(this->name(), this->loc);
   if (!module) {
     std::shared_ptr<AbstractNode> result=nullptr;
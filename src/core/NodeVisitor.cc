@@ -9,6 +9,14 @@ Response NodeVisitor::traverse(const AbstractNode& node, const State& state)
   newstate.setNumChildren(node.getChildren().size());
 
   Response response = Response::ContinueTraversal;
+  // Leaves the node on every way out, including aborts and exceptions
+  struct NodeGuard {
+    NodeVisitor& visitor;
+    const AbstractNode& node;
+    ~NodeGuard() { visitor.leaveNode(node); }
+  };
+  enterNode(node);
+  const NodeGuard guard{*this, node};
   newstate.setPrefix(true);
   newstate.setParent(state.parent());
   response = node.accept(newstate, *this);
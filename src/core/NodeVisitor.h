@@ -41,6 +41,13 @@ public:
 
   Response traverse(const AbstractNode& node, const State& state = NodeVisitor::nullstate);
 
+protected:
+  // Called before the prefix and after the postfix visit of each traversed node
+  virtual void enterNode(const AbstractNode& /*node*/) {}
+  virtual void leaveNode(const AbstractNode& /*node*/) {}
+
+public:
+
   Response visit(State& state, const AbstractNode& node) override = 0;
   Response visit(State& state, const AbstractIntersectionNode& node) override {
     return visit(state, (const AbstractNode&) node);
@@ -0,0 +1,345 @@
+#include "core/NumericKernel.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/Builtins.h"
+#include "core/Context.h"
+#include "core/Expression.h"
+#include "utils/degree_trig.h"
+
+namespace {
+
+// Upper bound on let() variables (plus the loop variable) in a kernel
+constexpr int maxSlots = 32;
+
+const std::unordered_map<std::string, double (*)(double)> unaryFunctions = {
+  {"sin", sin_degrees},
+  {"cos", cos_degrees},
+  {"tan", tan_degrees},
+  {"asin", asin_degrees},
+  {"acos", acos_degrees},
+  {"atan", atan_degrees},
+  {"abs", [](double x) { return std::fabs(x); }},
+  {"sign", [](double x) { return (x < 0) ? -1.0 : ((x > 0) ? 1.0 : 0.0); }},
+  {"sqrt", [](double x) { return std::sqrt(x); }},
+  {"exp", [](double x) { return std::exp(x); }},
+  {"ln", [](double x) { return std::log(x); }},
+  {"floor", [](double x) { return std::floor(x); }},
+  {"ceil", [](double x) { return std::ceil(x); }},
+  {"round", [](double x) { return std::round(x); }},
+};
+
+const std::unordered_map<std::string, double (*)(double, double)> binaryFunctions = {
+  {"atan2", atan2_degrees},
+  {"pow", [](double x, double y) { return std::pow(x, y); }},
+};
+
+} // namespace
+
+class NumericKernel::Compiler
+{
+public:
+  Compiler(NumericKernel& kernel, const std::shared_ptr<const Context>& context) : kernel(kernel), context(context) {}
+
+  int declare(const std::string& name, Type type) {
+    if (kernel.num_slots == maxSlots) return -1;
+    int slot = kernel.num_slots++;
+    scope.push_back({name, slot, type});
+    return slot;
+  }
+
+  int compileOutput(const Expression *expression) {
+    if (const auto *vector = dynamic_cast<const Vector *>(expression)) {
+      Node node{Op::Vector, Type::Vector};
+      for (const auto& child : vector->getChildren()) {
+        if (dynamic_cast<const ListComprehension *>(child.get())) return -1;
+        int index = compileOutput(child.get());
+        if (index < 0) return -1;
+        node.children.push_back(index);
+      }
+      return add(std::move(node));
+    }
+    if (const auto *let = dynamic_cast<const LcLet *>(expression)) {
+      return compileLet(let->getArguments(), let->getExpr(), true);
+    }
+    if (const auto *let = dynamic_cast<const Let *>(expression)) {
+      return compileLet(let->getArguments(), let->getExpr(), true);
+    }
+    int index = compileScalar(expression);
+    if (index >= 0) kernel.result_size++;
+    return index;
+  }
+
+  int compileScalar(const Expression *expression) {
+    if (const auto *literal = dynamic_cast<const Literal *>(expression)) {
+      if (literal->isDouble()) return constant(literal->toDouble(), Type::Number);
+      if (literal->isBool()) return constant(literal->toBool() ? 1.0 : 0.0, Type::Bool);
+      return -1;
+    }
+    if (const auto *lookup = dynamic_cast<const Lookup *>(expression)) {
+      return compileLookup(lookup->get_name());
+    }
+    if (const auto *unary = dynamic_cast<const UnaryOp *>(expression)) {
+      int operand = compileScalar(unary->getExpr());
+      if (operand < 0) return -1;
+      switch (unary->getOp()) {
+      case UnaryOp::Op::Negate:
+        return typeOf(operand) == Type::Number ? add({Op::Negate, Type::Number, 0, -1, nullptr, nullptr, {}, {operand}}) : -1;
+      case UnaryOp::Op::Not:
+        return add({Op::Not, Type::Bool, 0, -1, nullptr, nullptr, {}, {operand}});
+      default:
+        return -1;
+      }
+    }
+    if (const auto *binary = dynamic_cast<const BinaryOp *>(expression)) {
+      return compileBinary(binary);
+    }
+    if (const auto *ternary = dynamic_cast<const TernaryOp *>(expression)) {
+      int cond = compileScalar(ternary->getCond());
+      int ifexpr = cond < 0 ? -1 : compileScalar(ternary->getIfExpr());
+      int elseexpr = ifexpr < 0 ? -1 : compileScalar(ternary->getElseExpr());
+      if (elseexpr < 0 || typeOf(ifexpr) != typeOf(elseexpr)) return -1;
+      return add({Op::Ternary, typeOf(ifexpr), 0, -1, nullptr, nullptr, {}, {cond, ifexpr, elseexpr}});
+    }
+    if (const auto *call = dynamic_cast<const FunctionCall *>(expression)) {
+      return compileCall(call);
+    }
+    if (const auto *let = dynamic_cast<const Let *>(expression)) {
+      return compileLet(let->getArguments(), let->getExpr(), false);
+    }
+    return -1;
+  }
+
+private:
+  struct ScopeEntry {
+    std::string name;
+    int slot;
+    Type type;
+  };
+
+  int add(Node&& node) {
+    kernel.nodes.push_back(std::move(node));
+    return static_cast<int>(kernel.nodes.size()) - 1;
+  }
+
+  int constant(double value, Type type) {
+    Node node{Op::Constant, type};
+    node.constant = value;
+    return add(std::move(node));
+  }
+
+  [[nodiscard]] Type typeOf(int index) const { return kernel.nodes[index].type; }
+
+  int compileLookup(const std::string& name) {
+    // Special variables are dynamically scoped; leave them to the evaluator.
+    if (ContextFrame::is_config_variable(name)) return -1;
+    for (auto it = scope.rbegin(); it != scope.rend(); ++it) {
+      if (it->name == name) {
+        Node node{Op::Slot, it->type};
+        node.slot = it->slot;
+        return add(std::move(node));
+      }
+    }
+    boost::optional<const Value&> value = context->try_lookup_variable(name);
+    if (!value) return -1;
+    if (value->type() == Value::Type::NUMBER) return constant(value->toDouble(), Type::Number);
+    if (value->type() == Value::Type::BOOL) return constant(value->toBool() ? 1.0 : 0.0, Type::Bool);
+    return -1;
+  }
+
+  int compileBinary(const BinaryOp *binary) {
+    int left = compileScalar(binary->getLeft());
+    int right = left < 0 ? -1 : compileScalar(binary->getRight());
+    if (right < 0) return -1;
+    const bool numbers = typeOf(left) == Type::Number && typeOf(right) == Type::Number;
+    Op op;
+    Type type = Type::Bool;
+    switch (binary->getOp()) {
+    case BinaryOp::Op::LogicalAnd:   op = Op::LogicalAnd; break;
+    case BinaryOp::Op::LogicalOr:    op = Op::LogicalOr; break;
+    case BinaryOp::Op::Exponent:     op = Op::Exponent; type = Type::Number; break;
+    case BinaryOp::Op::Multiply:     op = Op::Multiply; type = Type::Number; break;
+    case BinaryOp::Op::Divide:       op = Op::Divide; type = Type::Number; break;
+    case BinaryOp::Op::Modulo:       op = Op::Modulo; type = Type::Number; break;
+    case BinaryOp::Op::Plus:         op = Op::Plus; type = Type::Number; break;
+    case BinaryOp::Op::Minus:        op = Op::Minus; type = Type::Number; break;
+    case BinaryOp::Op::Less:         op = Op::Less; break;
+    case BinaryOp::Op::LessEqual:    op = Op::LessEqual; break;
+    case BinaryOp::Op::Greater:      op = Op::Greater; break;
+    case BinaryOp::Op::GreaterEqual: op = Op::GreaterEqual; break;
+    case BinaryOp::Op::Equal:        op = Op::Equal; break;
+    case BinaryOp::Op::NotEqual:     op = Op::NotEqual; break;
+    default:
+      return -1;
+    }
+    if (op == Op::Equal || op == Op::NotEqual) {
+      // Mixed type comparisons are always false in OpenSCAD; not worth supporting.
+      if (typeOf(left) != typeOf(right)) return -1;
+    } else if (op != Op::LogicalAnd && op != Op::LogicalOr && !numbers) {
+      return -1;
+    }
+    return add({op, type, 0, -1, nullptr, nullptr, {}, {left, right}});
+  }
+
+  int compileCall(const FunctionCall *call) {
+    if (!call->isLookup) return -1;
+    const auto unary = unaryFunctions.find(call->name);
+    const auto binary = binaryFunctions.find(call->name);
+    size_t arity;
+    if (unary != unaryFunctions.end()) arity = 1;
+    else if (binary != binaryFunctions.end()) arity = 2;
+    else return -1;
+    if (call->arguments.size() != arity) return -1;
+
+    // Make sure the name is not shadowed by a user defined function.
+    const auto& builtins = Builtins::instance()->getFunctions();
+    const auto builtin = builtins.find(call->name);
+    if (builtin == builtins.end()) return -1;
+    boost::optional<CallableFunction> function = context->lookup_function(call->name, call->location());
+    if (!function || function->index() != 0 || std::get<const BuiltinFunction *>(*function) != builtin->second) return -1;
+
+    Node node{arity == 1 ? Op::Call1 : Op::Call2, Type::Number};
+    for (const auto& argument : call->arguments) {
+      if (!argument->getName().empty()) return -1;
+      int index = compileScalar(argument->getExpr().get());
+      if (index < 0 || typeOf(index) != Type::Number) return -1;
+      node.children.push_back(index);
+    }
+    if (arity == 1) node.function1 = unary->second;
+    else node.function2 = binary->second;
+    return add(std::move(node));
+  }
+
+  int compileLet(const AssignmentList& assignments, const Expression *body, bool output) {
+    const size_t scopeSize = scope.size();
+    Node node{Op::Let, Type::Number};
+    for (const auto& assignment : assignments) {
+      const std::string& name = assignment->getName();
+      if (name.empty() || ContextFrame::is_config_variable(name)) return -1;
+      for (size_t i = scopeSize; i < scope.size(); ++i) {
+        if (scope[i].name == name) return -1; // duplicate assignment warning
+      }
+      int index = compileScalar(assignment->getExpr().get());
+      if (index < 0) return -1;
+      int slot = declare(name, typeOf(index));
+      if (slot < 0) return -1;
+      node.children.push_back(index);
+      node.slots.push_back(slot);
+    }
+    int index = output ? compileOutput(body) : compileScalar(body);
+    scope.resize(scopeSize);
+    if (index < 0) return -1;
+    node.type = typeOf(index);
+    node.children.push_back(index);
+    return add(std::move(node));
+  }
+
+  NumericKernel& kernel;
+  const std::shared_ptr<const Context>& context;
+  std::vector<ScopeEntry> scope;
+};
+
+std::unique_ptr<NumericKernel> NumericKernel::compile(const Expression *expression, const std::string& variable,
+                                                      const std::shared_ptr<const Context>& context)
+{
+  if (variable.empty() || ContextFrame::is_config_variable(variable)) return nullptr;
+  auto kernel = std::make_unique<NumericKernel>();
+  Compiler compiler(*kernel, context);
+  compiler.declare(variable, Type::Number);
+  kernel->root = compiler.compileOutput(expression);
+  if (kernel->root < 0) return nullptr;
+  return kernel;
+}
+
+double NumericKernel::evaluateScalar(int index, double *slots) const
+{
+  const Node& node = nodes[index];
+  const auto arg = [&](size_t i) { return evaluateScalar(node.children[i], slots); };
+  switch (node.op) {
+  case Op::Constant:     return node.constant;
+  case Op::Slot:         return slots[node.slot];
+  case Op::Negate:       return -arg(0);
+  case Op::Not:          return arg(0) != 0 ? 0.0 : 1.0;
+  case Op::LogicalAnd:   return (arg(0) != 0 && arg(1) != 0) ? 1.0 : 0.0;
+  case Op::LogicalOr:    return (arg(0) != 0 || arg(1) != 0) ? 1.0 : 0.0;
+  case Op::Plus:         return arg(0) + arg(1);
+  case Op::Minus:        return arg(0) - arg(1);
+  case Op::Multiply:     return arg(0) * arg(1);
+  case Op::Divide:       return arg(0) / arg(1);
+  case Op::Modulo:       return fmod(arg(0), arg(1));
+  case Op::Exponent:     return pow(arg(0), arg(1));
+  case Op::Less:         return arg(0) < arg(1) ? 1.0 : 0.0;
+  case Op::LessEqual:    return arg(0) <= arg(1) ? 1.0 : 0.0;
+  case Op::Greater:      return arg(0) > arg(1) ? 1.0 : 0.0;
+  case Op::GreaterEqual: return arg(0) >= arg(1) ? 1.0 : 0.0;
+  case Op::Equal:        return arg(0) == arg(1) ? 1.0 : 0.0;
+  case Op::NotEqual:     return arg(0) != arg(1) ? 1.0 : 0.0;
+  case Op::Ternary:      return arg(0) != 0 ? arg(1) : arg(2);
+  case Op::Call1:        return node.function1(arg(0));
+  case Op::Call2:        return node.function2(arg(0), arg(1));
+  case Op::Let:
+    for (size_t i = 0; i < node.slots.size(); ++i) {
+      slots[node.slots[i]] = arg(i);
+    }
+    return arg(node.children.size() - 1);
+  case Op::Vector:
+    break;
+  }
+  assert(false && "Vector in scalar kernel expression");
+  return 0;
+}
+
+void NumericKernel::evaluateOutput(int index, double *slots, double *& result) const
+{
+  const Node& node = nodes[index];
+  if (node.op == Op::Vector) {
+    for (int child : node.children) {
+      evaluateOutput(child, slots, result);
+    }
+  } else if (node.op == Op::Let && node.type == Type::Vector) {
+    for (size_t i = 0; i < node.slots.size(); ++i) {
+      slots[node.slots[i]] = evaluateScalar(node.children[i], slots);
+    }
+    evaluateOutput(node.children.back(), slots, result);
+  } else {
+    *result++ = evaluateScalar(index, slots);
+  }
+}
+
+void NumericKernel::evaluate(double variable, double *result) const
+{
+  std::array<double, maxSlots> slots;
+  slots[0] = variable;
+  evaluateOutput(root, slots.data(), result);
+}
+
+Value NumericKernel::outputValue(int index, const double *& result, EvaluationSession *session) const
+{
+  const Node& node = nodes[index];
+  if (node.op == Op::Vector) {
+    VectorType vec(session);
+    vec.reserve(node.children.size());
+    for (int child : node.children) {
+      vec.emplace_back(outputValue(child, result, session));
+    }
+    return std::move(vec);
+  }
+  if (node.op == Op::Let && node.type == Type::Vector) {
+    return outputValue(node.children.back(), result, session);
+  }
+  const double value = *result++;
+  if (node.type == Type::Bool) return value != 0;
+  return value;
+}
+
+Value NumericKernel::toValue(const double *result, EvaluationSession *session) const
+{
+  return outputValue(root, result, session);
+}
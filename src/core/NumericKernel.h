@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Value.h"
+
+class Context;
+class Expression;
+
+/*
+ * A compiled form of a simple, side effect free expression over numbers and
+ * booleans, as commonly found in the body of large list comprehensions, e.g.
+ *
+ *   [for (i = [0:n]) let(a = i * step) [r * cos(a), r * sin(a)]]
+ *
+ * Supported are number and boolean literals, arithmetic, comparison and
+ * logical operators, the ternary operator, let(), vector literals of the
+ * above, a set of builtin math functions, the loop variable, and any other
+ * variables holding numbers or booleans (resolved once at compile time).
+ *
+ * Evaluation does not touch any Context or EvaluationSession state, so it is
+ * safe to evaluate a kernel concurrently for different loop variable values.
+ * Evaluation writes a flat list of scalars; toValue() then reassembles the
+ * resulting Value, which must happen on the evaluating thread.
+ */
+class NumericKernel
+{
+public:
+  /*
+   * Returns nullptr if expression cannot be expressed as a kernel of the
+   * given loop variable in the given context.
+   */
+  static std::unique_ptr<NumericKernel> compile(const Expression *expression, const std::string& variable,
+                                                const std::shared_ptr<const Context>& context);
+
+  // Number of scalars written by evaluate()
+  [[nodiscard]] size_t resultSize() const { return result_size; }
+  void evaluate(double variable, double *result) const;
+  [[nodiscard]] Value toValue(const double *result, EvaluationSession *session) const;
+
+private:
+  enum class Op {
+    Constant, Slot, Negate, Not, LogicalAnd, LogicalOr,
+    Plus, Minus, Multiply, Divide, Modulo, Exponent,
+    Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+    Ternary, Call1, Call2, Let, Vector
+  };
+  enum class Type { Number, Bool, Vector };
+
+  struct Node {
+    Op op;
+    Type type;
+    double constant = 0;
+    int slot = -1;
+    double (*function1)(double) = nullptr;
+    double (*function2)(double, double) = nullptr;
+    // Let: assigned slots for children[0..n-2], body is children.back()
+    std::vector<int> slots;
+    std::vector<int> children;
+  };
+
+  class Compiler;
+
+  double evaluateScalar(int index, double *slots) const;
+  void evaluateOutput(int index, double *slots, double *& result) const;
+  Value outputValue(int index, const double *& result, EvaluationSession *session) const;
+
+  std::vector<Node> nodes;
+  int root = -1;
+  int num_slots = 0;
+  size_t result_size = 0;
+};
@@ -31,6 +31,7 @@
 #include "core/Children.h"
 #include "core/Parameters.h"
 #include "core/Builtins.h"
+#include "utils/printutils.h"
 
 #include <clipper2/clipper.offset.h>
 #include <ios>
@@ -44,7 +45,7 @@ static std::shared_ptr<AbstractNode> builtin_offset(const ModuleInstantiation *i
 {
   auto node = std::make_shared<OffsetNode>(inst);
 
-  Parameters parameters = Parameters::parse(std::move(arguments), inst->location(), {"r"}, {"delta", "chamfer"});
+  Parameters parameters = Parameters::parse(std::move(arguments), inst->location(), {"r"}, {"delta", "chamfer", "method", "resolution"});
 
   node->fn = parameters["$fn"].toDouble();
   node->fs = parameters["$fs"].toDouble();
@@ -65,6 +66,18 @@ static std::shared_ptr<AbstractNode> builtin_offset(const ModuleInstantiation *i
       node->join_type = Clipper2Lib::JoinType::Square;
     }
   }
+  if (!parameters["method"].isUndefined()) {
+    node->method = parameters["method"].toString();
+    // method can only be one of...
+    if (node->method != "prisms" && node->method != "levelset") {
+      LOG(message_group::Warning, inst->location(), parameters.documentRoot(),
+          "Unknown offset method '" + node->method + "'. Using 'prisms'.");
+      node->method = "prisms";
+    }
+  }
+  if (parameters["resolution"].isDefinedAs(Value::Type::NUMBER)) {
+    node->resolution = parameters["resolution"].toDouble();
+  }
 
   return children.instantiate(node);
 }
@@ -80,6 +93,12 @@ std::string OffsetNode::toString() const
   if (!isRadius) {
     stream << ", chamfer = " << (this->chamfer ? "true" : "false");
   }
+  if (this->method != "prisms") {
+    stream << ", method = \"" << this->method << "\"";
+  }
+  if (this->resolution > 0) {
+    stream << ", resolution = " << this->resolution;
+  }
   stream << ", $fn = " << this->fn
          << ", $fa = " << this->fa
          << ", $fs = " << this->fs << ")";
@@ -94,5 +113,6 @@ void register_builtin_offset()
     "offset(r = number)",
     "offset(delta = number)",
     "offset(delta = number, chamfer = false)",
+    "offset(r = number, method = \"levelset\", resolution = number)",
   });
 }
@@ -18,4 +18,7 @@ public:
   double fn{0}, fs{0}, fa{0}, delta{1};
   double miter_limit{1000000.0}; // currently fixed high value to disable chamfers with jtMiter
   Clipper2Lib::JoinType join_type{Clipper2Lib::JoinType::Round};
+  // 3D only: "prisms" unions prisms over the faces, "levelset" samples the signed distance
+  std::string method{"prisms"};
+  double resolution{0}; // levelset grid spacing, 0 derives it from the size of the object
 };
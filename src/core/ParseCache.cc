@@ -0,0 +1,706 @@
+#include "core/ParseCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "Feature.h"
+#include "core/AST.h"
+#include "core/Assignment.h"
+#include "core/Expression.h"
+#include "core/ModuleInstantiation.h"
+#include "core/SourceFile.h"
+#include "core/UserModule.h"
+#include "core/function.h"
+#include "core/parsersettings.h"
+#include "handle_dep.h"
+#include "openscad.h"
+#include "platform/PlatformUtils.h"
+#include "utils/printutils.h"
+#include "version.h"
+
+namespace fs = std::filesystem;
+
+ParseCache *ParseCache::inst = nullptr;
+
+namespace {
+
+// Bump whenever the encoding below changes
+constexpr uint32_t formatVersion = 1;
+constexpr char formatMagic[4] = {'O', 'S', 'P', 'C'};
+
+uint64_t contentHash(const std::string& data)
+{
+  // 64 bit FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool readFile(const std::string& path, std::string& contents)
+{
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  if (!ifs.is_open()) return false;
+  contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+  return !ifs.bad();
+}
+
+enum class ExpressionTag : uint8_t {
+  None, Literal, UnaryOp, BinaryOp, TernaryOp, ArrayLookup, Range, Vector, Lookup, MemberLookup,
+  FunctionCall, FunctionDefinition, Assert, Echo, Texture, Let, LcIf, LcFor, LcForC, LcEach, LcLet
+};
+
+enum class LiteralTag : uint8_t { Undefined, Bool, Number, String };
+
+enum InstantiationFlags : uint8_t { Root = 1, Highlight = 2, Background = 4, IfElse = 8, HasElse = 16 };
+
+/*
+   Encodes a parsed SourceFile. All paths referenced by Locations are
+   collected in a table, which is written ahead of the encoded AST.
+ */
+class Writer
+{
+public:
+  void u8(uint8_t v) { buffer.push_back(static_cast<char>(v)); }
+  void u32(uint32_t v) { raw(&v, sizeof(v)); }
+  void i32(int32_t v) { raw(&v, sizeof(v)); }
+  void u64(uint64_t v) { raw(&v, sizeof(v)); }
+  void f64(double v) { raw(&v, sizeof(v)); }
+  void str(const std::string& s) { u32(s.size()); buffer.append(s); }
+  void raw(const void *data, size_t size) { buffer.append(static_cast<const char *>(data), size); }
+
+  void location(const Location& loc) {
+    i32(loc.firstLine());
+    i32(loc.firstColumn());
+    i32(loc.lastLine());
+    i32(loc.lastColumn());
+    const std::string path = loc.fileName();
+    auto it = path_index.find(path);
+    if (it == path_index.end()) {
+      it = path_index.emplace(path, paths.size()).first;
+      paths.push_back(path);
+    }
+    u32(it->second);
+  }
+
+  void tag(ExpressionTag tag, const Expression *expr) {
+    u8(static_cast<uint8_t>(tag));
+    location(expr->location());
+  }
+
+  void expression(const Expression *expr) {
+    if (!expr) {
+      u8(static_cast<uint8_t>(ExpressionTag::None));
+    } else if (const auto *e = dynamic_cast<const Literal *>(expr)) {
+      tag(ExpressionTag::Literal, e);
+      if (e->isUndefined()) {
+        u8(static_cast<uint8_t>(LiteralTag::Undefined));
+      } else if (e->isBool()) {
+        u8(static_cast<uint8_t>(LiteralTag::Bool));
+        u8(e->toBool());
+      } else if (e->isDouble()) {
+        u8(static_cast<uint8_t>(LiteralTag::Number));
+        f64(e->toDouble());
+      } else if (e->isString()) {
+        u8(static_cast<uint8_t>(LiteralTag::String));
+        str(e->toString());
+      } else {
+        ok = false;
+      }
+    } else if (const auto *e = dynamic_cast<const UnaryOp *>(expr)) {
+      tag(ExpressionTag::UnaryOp, e);
+      u8(static_cast<uint8_t>(e->getOp()));
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const BinaryOp *>(expr)) {
+      tag(ExpressionTag::BinaryOp, e);
+      expression(e->getLeft());
+      u8(static_cast<uint8_t>(e->getOp()));
+      expression(e->getRight());
+    } else if (const auto *e = dynamic_cast<const TernaryOp *>(expr)) {
+      tag(ExpressionTag::TernaryOp, e);
+      expression(e->getCond());
+      expression(e->getIfExpr());
+      expression(e->getElseExpr());
+    } else if (const auto *e = dynamic_cast<const ArrayLookup *>(expr)) {
+      tag(ExpressionTag::ArrayLookup, e);
+      expression(e->getArray());
+      expression(e->getIndex());
+    } else if (const auto *e = dynamic_cast<const Range *>(expr)) {
+      tag(ExpressionTag::Range, e);
+      expression(e->getBegin());
+      expression(e->getStep());
+      expression(e->getEnd());
+    } else if (const auto *e = dynamic_cast<const Vector *>(expr)) {
+      tag(ExpressionTag::Vector, e);
+      u32(e->getChildren().size());
+      for (const auto& child : e->getChildren()) expression(child.get());
+    } else if (const auto *e = dynamic_cast<const Lookup *>(expr)) {
+      tag(ExpressionTag::Lookup, e);
+      str(e->get_name());
+    } else if (const auto *e = dynamic_cast<const MemberLookup *>(expr)) {
+      tag(ExpressionTag::MemberLookup, e);
+      expression(e->getExpr());
+      str(e->getMember());
+    } else if (const auto *e = dynamic_cast<const FunctionCall *>(expr)) {
+      tag(ExpressionTag::FunctionCall, e);
+      expression(e->expr.get());
+      assignments(e->arguments);
+    } else if (const auto *e = dynamic_cast<const FunctionDefinition *>(expr)) {
+      tag(ExpressionTag::FunctionDefinition, e);
+      assignments(e->parameters);
+      expression(e->expr.get());
+    } else if (const auto *e = dynamic_cast<const Assert *>(expr)) {
+      tag(ExpressionTag::Assert, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const Echo *>(expr)) {
+      tag(ExpressionTag::Echo, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const Texture *>(expr)) {
+      tag(ExpressionTag::Texture, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const Let *>(expr)) {
+      tag(ExpressionTag::Let, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const LcIf *>(expr)) {
+      tag(ExpressionTag::LcIf, e);
+      expression(e->getCond());
+      expression(e->getIfExpr());
+      expression(e->getElseExpr());
+    } else if (const auto *e = dynamic_cast<const LcFor *>(expr)) {
+      tag(ExpressionTag::LcFor, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const LcForC *>(expr)) {
+      tag(ExpressionTag::LcForC, e);
+      assignments(e->getArguments());
+      assignments(e->getIncrArguments());
+      expression(e->getCond());
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const LcEach *>(expr)) {
+      tag(ExpressionTag::LcEach, e);
+      expression(e->getExpr());
+    } else if (const auto *e = dynamic_cast<const LcLet *>(expr)) {
+      tag(ExpressionTag::LcLet, e);
+      assignments(e->getArguments());
+      expression(e->getExpr());
+    } else {
+      ok = false;
+    }
+  }
+
+  void assignment(const Assignment& assignment) {
+    str(assignment.getName());
+    location(assignment.location());
+    location(assignment.locationOfOverwrite());
+    expression(assignment.getExpr().get());
+  }
+
+  void assignments(const AssignmentList& list) {
+    u32(list.size());
+    for (const auto& a : list) assignment(*a);
+  }
+
+  void scope(const LocalScope& scope) {
+    assignments(scope.assignments);
+    u32(scope.astFunctions.size());
+    for (const auto& [name, function] : scope.astFunctions) {
+      str(function->name);
+      location(function->location());
+      assignments(function->parameters);
+      expression(function->expr.get());
+    }
+    u32(scope.astModules.size());
+    for (const auto& [name, module] : scope.astModules) {
+      str(module->name);
+      location(module->location());
+      assignments(module->parameters);
+      this->scope(module->body);
+    }
+    u32(scope.moduleInstantiations.size());
+    for (const auto& inst : scope.moduleInstantiations) instantiation(*inst);
+  }
+
+  void instantiation(const ModuleInstantiation& inst) {
+    const auto *ifelse = dynamic_cast<const IfElseModuleInstantiation *>(&inst);
+    uint8_t flags = (inst.tag_root ? Root : 0) | (inst.tag_highlight ? Highlight : 0) | (inst.tag_background ? Background : 0);
+    if (ifelse) {
+      flags |= IfElse | (ifelse->getElseScope() ? HasElse : 0);
+      if (inst.arguments.size() != 1) ok = false;
+    }
+    u8(flags);
+    location(inst.location());
+    if (ifelse) {
+      expression(inst.arguments.empty() ? nullptr : inst.arguments[0]->getExpr().get());
+    } else {
+      str(inst.name());
+      assignments(inst.arguments);
+    }
+    scope(inst.scope);
+    if (ifelse && ifelse->getElseScope()) scope(*ifelse->getElseScope());
+  }
+
+  void sourceFile(const SourceFile& file) {
+    str(file.modulePath());
+    str(file.getFilename());
+    u32(file.registrations().size());
+    for (const auto& registration : file.registrations()) {
+      u8(registration.include);
+      str(registration.localpath);
+      str(registration.fullpath);
+      location(registration.location);
+    }
+    scope(file.scope);
+  }
+
+  std::string buffer;
+  std::vector<std::string> paths;
+  bool ok = true;
+
+private:
+  std::unordered_map<std::string, uint32_t> path_index;
+};
+
+/*
+   Decodes what Writer produced. Any truncated or inconsistent input makes
+   ok() return false; the partially decoded AST must then be discarded.
+ */
+class Reader
+{
+public:
+  Reader(const std::string& data) : pos(data.data()), end(data.data() + data.size()) {}
+
+  [[nodiscard]] bool ok() const { return valid; }
+  [[nodiscard]] bool atEnd() const { return pos == end; }
+
+  uint8_t u8() { uint8_t v = 0; raw(&v, sizeof(v)); return v; }
+  uint32_t u32() { uint32_t v = 0; raw(&v, sizeof(v)); return v; }
+  int32_t i32() { int32_t v = 0; raw(&v, sizeof(v)); return v; }
+  uint64_t u64() { uint64_t v = 0; raw(&v, sizeof(v)); return v; }
+  double f64() { double v = 0; raw(&v, sizeof(v)); return v; }
+
+  std::string str() {
+    const uint32_t size = u32();
+    if (!check(size)) return {};
+    std::string s(pos, size);
+    pos += size;
+    return s;
+  }
+
+  // Reads a string and compares it to the expected one without copying
+  bool matches(const std::string& expected) {
+    const uint32_t size = u32();
+    if (!check(size)) return false;
+    const bool equal = size == expected.size() && std::memcmp(pos, expected.data(), size) == 0;
+    pos += size;
+    return equal;
+  }
+
+  bool matches(const char *expected, size_t size) {
+    if (!check(size)) return false;
+    const bool equal = std::memcmp(pos, expected, size) == 0;
+    pos += size;
+    return equal;
+  }
+
+  void readPaths() {
+    const uint32_t count = u32();
+    for (uint32_t i = 0; i < count && valid; ++i) {
+      paths.push_back(std::make_shared<fs::path>(str()));
+    }
+  }
+
+  Location location() {
+    const int32_t firstLine = i32();
+    const int32_t firstCol = i32();
+    const int32_t lastLine = i32();
+    const int32_t lastCol = i32();
+    const uint32_t path = u32();
+    if (path >= paths.size()) {
+      valid = false;
+      return Location::NONE;
+    }
+    return {firstLine, firstCol, lastLine, lastCol, paths[path]};
+  }
+
+  std::unique_ptr<Expression> expression() {
+    const auto tag = static_cast<ExpressionTag>(u8());
+    if (!valid || tag == ExpressionTag::None) return nullptr;
+    const Location loc = location();
+    switch (tag) {
+    case ExpressionTag::Literal: {
+      switch (static_cast<LiteralTag>(u8())) {
+      case LiteralTag::Undefined: return std::make_unique<Literal>(loc);
+      case LiteralTag::Bool:      return std::make_unique<Literal>(u8() != 0, loc);
+      case LiteralTag::Number:    return std::make_unique<Literal>(f64(), loc);
+      case LiteralTag::String:    return std::make_unique<Literal>(str(), loc);
+      }
+      break;
+    }
+    case ExpressionTag::UnaryOp: {
+      const uint8_t op = u8();
+      auto expr = required();
+      if (op > static_cast<uint8_t>(UnaryOp::Op::Negate) || !valid) break;
+      return std::make_unique<UnaryOp>(static_cast<UnaryOp::Op>(op), expr.release(), loc);
+    }
+    case ExpressionTag::BinaryOp: {
+      auto left = required();
+      const uint8_t op = u8();
+      auto right = required();
+      if (op > static_cast<uint8_t>(BinaryOp::Op::NotEqual) || !valid) break;
+      return std::make_unique<BinaryOp>(left.release(), static_cast<BinaryOp::Op>(op), right.release(), loc);
+    }
+    case ExpressionTag::TernaryOp: {
+      auto cond = required();
+      auto ifexpr = required();
+      auto elseexpr = required();
+      if (!valid) break;
+      return std::make_unique<TernaryOp>(cond.release(), ifexpr.release(), elseexpr.release(), loc);
+    }
+    case ExpressionTag::ArrayLookup: {
+      auto array = required();
+      auto index = required();
+      if (!valid) break;
+      return std::make_unique<ArrayLookup>(array.release(), index.release(), loc);
+    }
+    case ExpressionTag::Range: {
+      auto begin = required();
+      auto step = expression();
+      auto end = required();
+      if (!valid) break;
+      if (step) return std::make_unique<Range>(begin.release(), step.release(), end.release(), loc);
+      return std::make_unique<Range>(begin.release(), end.release(), loc);
+    }
+    case ExpressionTag::Vector: {
+      auto vec = std::make_unique<Vector>(loc);
+      for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+        if (auto child = required()) vec->emplace_back(child.release());
+      }
+      if (!valid) break;
+      return vec;
+    }
+    case ExpressionTag::Lookup: {
+      std::string name = str();
+      if (!valid) break;
+      return std::make_unique<Lookup>(std::move(name), loc);
+    }
+    case ExpressionTag::MemberLookup: {
+      auto expr = required();
+      std::string member = str();
+      if (!valid) break;
+      return std::make_unique<MemberLookup>(expr.release(), std::move(member), loc);
+    }
+    case ExpressionTag::FunctionCall: {
+      auto expr = required();
+      AssignmentList arguments = assignments();
+      if (!valid) break;
+      return std::make_unique<FunctionCall>(expr.release(), std::move(arguments), loc);
+    }
+    case ExpressionTag::FunctionDefinition: {
+      AssignmentList parameters = assignments();
+      auto expr = required();
+      if (!valid) break;
+      return std::make_unique<FunctionDefinition>(expr.release(), std::move(parameters), loc);
+    }
+    case ExpressionTag::Assert: {
+      AssignmentList arguments = assignments();
+      auto expr = expression();
+      if (!valid) break;
+      return std::make_unique<Assert>(std::move(arguments), expr.release(), loc);
+    }
+    case ExpressionTag::Echo: {
+      AssignmentList arguments = assignments();
+      auto expr = expression();
+      if (!valid) break;
+      return std::make_unique<Echo>(std::move(arguments), expr.release(), loc);
+    }
+    case ExpressionTag::Texture: {
+      AssignmentList arguments = assignments();
+      auto expr = expression();
+      if (!valid) break;
+      return std::make_unique<Texture>(std::move(arguments), expr.release(), loc);
+    }
+    case ExpressionTag::Let: {
+      AssignmentList arguments = assignments();
+      auto expr = expression();
+      if (!valid) break;
+      return std::make_unique<Let>(std::move(arguments), expr.release(), loc);
+    }
+    case ExpressionTag::LcIf: {
+      auto cond = required();
+      auto ifexpr = required();
+      auto elseexpr = expression();
+      if (!valid) break;
+      return std::make_unique<LcIf>(cond.release(), ifexpr.release(), elseexpr.release(), loc);
+    }
+    case ExpressionTag::LcFor: {
+      AssignmentList arguments = assignments();
+      auto expr = required();
+      if (!valid) break;
+      return std::make_unique<LcFor>(std::move(arguments), expr.release(), loc);
+    }
+    case ExpressionTag::LcForC: {
+      AssignmentList arguments = assignments();
+      AssignmentList incr_arguments = assignments();
+      auto cond = required();
+      auto expr = required();
+      if (!valid) break;
+      return std::make_unique<LcForC>(std::move(arguments), std::move(incr_arguments), cond.release(), expr.release(), loc);
+    }
+    case ExpressionTag::LcEach: {
+      auto expr = required();
+      if (!valid) break;
+      return std::make_unique<LcEach>(expr.release(), loc);
+    }
+    case ExpressionTag::LcLet: {
+      AssignmentList arguments = assignments();
+      auto expr = required();
+      if (!valid) break;
+      return std::make_unique<LcLet>(std::move(arguments), expr.release(), loc);
+    }
+    default:
+      break;
+    }
+    valid = false;
+    return nullptr;
+  }
+
+  AssignmentList assignments() {
+    AssignmentList list;
+    for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+      std::string name = str();
+      const Location loc = location();
+      const Location locOfOverwrite = location();
+      std::shared_ptr<Expression> expr = expression();
+      auto a = std::make_shared<Assignment>(std::move(name), std::move(expr), loc);
+      a->setLocationOfOverwrite(locOfOverwrite);
+      list.push_back(std::move(a));
+    }
+    return list;
+  }
+
+  void scope(LocalScope& scope) {
+    for (auto& a : assignments()) scope.addAssignment(a);
+    for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+      std::string name = str();
+      const Location loc = location();
+      AssignmentList parameters = assignments();
+      std::shared_ptr<Expression> expr = required();
+      if (!valid) return;
+      scope.addFunction(std::make_shared<UserFunction>(name.c_str(), parameters, std::move(expr), loc));
+    }
+    for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+      std::string name = str();
+      const Location loc = location();
+      auto module = std::make_shared<UserModule>(name.c_str(), loc);
+      module->parameters = assignments();
+      this->scope(module->body);
+      scope.addModule(module);
+    }
+    for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+      if (auto inst = instantiation()) scope.addModuleInst(inst);
+    }
+  }
+
+  std::shared_ptr<ModuleInstantiation> instantiation() {
+    const uint8_t flags = u8();
+    const Location loc = location();
+    std::shared_ptr<ModuleInstantiation> inst;
+    if (flags & IfElse) {
+      std::shared_ptr<Expression> cond = required();
+      auto ifelse = std::make_shared<IfElseModuleInstantiation>(std::move(cond), loc);
+      scope(ifelse->scope);
+      if (flags & HasElse) scope(*ifelse->makeElseScope());
+      inst = ifelse;
+    } else {
+      std::string name = str();
+      AssignmentList arguments = assignments();
+      inst = std::make_shared<ModuleInstantiation>(std::move(name), std::move(arguments), loc);
+      scope(inst->scope);
+    }
+    inst->tag_root = flags & Root;
+    inst->tag_highlight = flags & Highlight;
+    inst->tag_background = flags & Background;
+    return valid ? inst : nullptr;
+  }
+
+  std::unique_ptr<SourceFile> sourceFile(std::vector<SourceFile::Registration>& registrations) {
+    std::string path = str();
+    std::string filename = str();
+    for (uint32_t i = 0, count = u32(); i < count && valid; ++i) {
+      const bool include = u8() != 0;
+      std::string localpath = str();
+      std::string fullpath = str();
+      registrations.push_back({include, std::move(localpath), std::move(fullpath), location()});
+    }
+    auto file = std::make_unique<SourceFile>(std::move(path), std::move(filename));
+    scope(file->scope);
+    return file;
+  }
+
+private:
+  bool check(size_t size) {
+    if (valid && static_cast<size_t>(end - pos) < size) valid = false;
+    return valid;
+  }
+
+  void raw(void *data, size_t size) {
+    if (!check(size)) return;
+    std::memcpy(data, pos, size);
+    pos += size;
+  }
+
+  std::unique_ptr<Expression> required() {
+    auto expr = expression();
+    if (!expr) valid = false;
+    return expr;
+  }
+
+  const char *pos;
+  const char *end;
+  bool valid = true;
+  std::vector<std::shared_ptr<fs::path>> paths;
+};
+
+} // namespace
+
+bool ParseCache::parse(SourceFile *& file, const std::string& text, const std::string& filename, const std::string& mainFile)
+{
+  std::string entry, fullname, fullmain;
+  if (Feature::ExperimentalParseCache.is_enabled() && !filename.empty()) {
+    try {
+      fullname = fs::absolute(fs::path{filename}).generic_string();
+      fullmain = (mainFile.empty() ? fs::current_path() : fs::absolute(fs::path{mainFile})).generic_string();
+      const std::string dir = PlatformUtils::userPath("parse-cache");
+      if (!dir.empty()) {
+        const uint64_t key = contentHash(fullname + '\n' + fullmain);
+        entry = (fs::path(dir) / str(boost::format("%016x.ast") % key)).generic_string();
+      }
+    } catch (const fs::filesystem_error&) {
+      entry.clear();
+    }
+  }
+  if (entry.empty()) return ::parse(file, text, filename, mainFile, false);
+
+  if ((file = load(entry, text, fullname, fullmain))) {
+    PRINTDB("Using cached parse result for '%s'", filename);
+    return true;
+  }
+
+  const size_t messages = print_messages_count;
+  if (!::parse(file, text, filename, mainFile, false)) return false;
+  if (print_messages_count == messages) store(entry, *file, text, fullname, fullmain);
+  return true;
+}
+
+SourceFile *ParseCache::load(const std::string& entry, const std::string& text, const std::string& filename, const std::string& mainFile)
+{
+  std::string data;
+  if (!readFile(entry, data)) return nullptr;
+
+  Reader in(data);
+  if (!in.matches(formatMagic, sizeof(formatMagic)) || in.u32() != formatVersion) return nullptr;
+  if (!in.matches(openscad_detailedversionnumber) || !in.matches(filename) || !in.matches(mainFile)) return nullptr;
+  const auto& libraryPath = get_library_path();
+  if (in.u32() != libraryPath.size()) return nullptr;
+  for (const auto& path : libraryPath) {
+    if (!in.matches(path)) return nullptr;
+  }
+  if (!in.matches(text)) return nullptr;
+
+  for (uint32_t i = 0, count = in.u32(); i < count && in.ok(); ++i) {
+    const std::string path = in.str();
+    const uint64_t size = in.u64();
+    const uint64_t hash = in.u64();
+    std::string contents;
+    if (!in.ok() || !readFile(path, contents) || contents.size() != size || contentHash(contents) != hash) return nullptr;
+  }
+
+  in.readPaths();
+  std::vector<SourceFile::Registration> registrations;
+  auto file = in.sourceFile(registrations);
+  if (!in.ok() || !in.atEnd()) {
+    LOG(message_group::Warning, "Ignoring corrupt parse cache entry '%1$s'", entry);
+    return nullptr;
+  }
+
+  // Replay what the lexer and parser would have done for use<> and include<>
+  for (const auto& registration : registrations) {
+    handle_dep(registration.fullpath);
+    if (registration.include) {
+      file->registerInclude(registration.localpath, registration.fullpath, registration.location);
+    } else {
+      file->registerUse(registration.fullpath, registration.location);
+    }
+  }
+  return file.release();
+}
+
+void ParseCache::store(const std::string& entry, const SourceFile& file, const std::string& text, const std::string& filename, const std::string& mainFile)
+{
+  Writer body;
+  body.sourceFile(file);
+  if (!body.ok) return;
+
+  Writer out;
+  out.raw(formatMagic, sizeof(formatMagic));
+  out.u32(formatVersion);
+  out.str(openscad_detailedversionnumber);
+  out.str(filename);
+  out.str(mainFile);
+  const auto& libraryPath = get_library_path();
+  out.u32(libraryPath.size());
+  for (const auto& path : libraryPath) out.str(path);
+  out.str(text);
+
+  std::vector<const SourceFile::Registration *> includes;
+  for (const auto& registration : file.registrations()) {
+    if (registration.include) includes.push_back(&registration);
+  }
+  out.u32(includes.size());
+  for (const auto *include : includes) {
+    std::string contents;
+    if (!readFile(include->fullpath, contents)) return;
+    out.str(include->fullpath);
+    out.u64(contents.size());
+    out.u64(contentHash(contents));
+  }
+
+  out.u32(body.paths.size());
+  for (const auto& path : body.paths) out.str(path);
+  out.buffer += body.buffer;
+
+  // Write to a temporary file first so concurrent readers never see a partial entry
+  std::error_code ec;
+  const fs::path path{entry};
+  fs::create_directories(path.parent_path(), ec);
+  const fs::path tmp = fs::path(entry + ".tmp");
+  {
+    std::ofstream ofs(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) return;
+    ofs.write(out.buffer.data(), out.buffer.size());
+    if (!ofs.good()) {
+      ofs.close();
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+  fs::rename(tmp, path, ec);
+  if (ec) fs::remove(tmp, ec);
+}
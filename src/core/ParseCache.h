@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+class SourceFile;
+
+/*!
+   Persistent cache of parsed SourceFiles, enabled by the "parse-cache"
+   experimental feature.
+
+   There is one cache entry per source file, stored in the user's OpenSCAD
+   folder. An entry holds the exact text that was parsed (including any
+   command line assignments), the library path, and the contents hashes of
+   all files pulled in by include<>. The cached AST is only used if all of
+   these still match, so editing the file or any of its includes
+   invalidates the entry.
+
+   Only parses which succeed without printing any message are cached, as
+   parser warnings cannot be reproduced from a cached AST.
+ */
+class ParseCache
+{
+public:
+  static ParseCache *instance() { if (!inst) inst = new ParseCache; return inst; }
+
+  // Same contract as parse(), consulting the cache first if enabled
+  bool parse(SourceFile *& file, const std::string& text, const std::string& filename, const std::string& mainFile);
+
+private:
+  ParseCache() = default;
+
+  static SourceFile *load(const std::string& entry, const std::string& text, const std::string& filename, const std::string& mainFile);
+  static void store(const std::string& entry, const SourceFile& file, const std::string& text, const std::string& filename, const std::string& mainFile);
+
+  static ParseCache *inst;
+};
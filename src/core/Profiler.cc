@@ -0,0 +1,218 @@
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "core/AST.h"
+#include "utils/printutils.h"
+
+Profiler *Profiler::inst = nullptr;
+
+std::vector<Profiler::Frame>& Profiler::frames()
+{
+  static thread_local std::vector<Frame> stack;
+  return stack;
+}
+
+void Profiler::begin(const char *category, const std::string& name, const std::string& location)
+{
+  auto& stack = frames();
+  const std::lock_guard<std::mutex> lock(mutex);
+  Entry *parent = stack.empty() ? &root : stack.back().entry;
+  auto& child = parent->children[std::make_tuple(std::string(category), name, location)];
+  if (!child) {
+    child = std::make_unique<Entry>();
+    child->category = category;
+    child->name = name;
+    child->location = location;
+  }
+  stack.push_back({child.get(), std::chrono::steady_clock::now()});
+}
+
+void Profiler::begin(const char *category, const std::string& name, const Location& location)
+{
+  std::string where;
+  if (!location.isNone()) {
+    const auto file = location.fileName();
+    where = (file.empty() ? std::string() : fs::path(file).filename().string() + ":") + std::to_string(location.firstLine());
+  }
+  begin(category, name, where);
+}
+
+void Profiler::setCacheHit(bool hit)
+{
+  auto& stack = frames();
+  if (stack.empty()) return;
+  stack.back().has_cache = true;
+  stack.back().cache_hit = hit;
+}
+
+void Profiler::addOutput(size_t facets, size_t bytes)
+{
+  auto& stack = frames();
+  if (stack.empty()) return;
+  stack.back().output_facets += facets;
+  stack.back().bytes += bytes;
+}
+
+void Profiler::end()
+{
+  auto& stack = frames();
+  if (stack.empty()) return;
+  const auto now = std::chrono::steady_clock::now();
+  const Frame frame = stack.back();
+  stack.pop_back();
+  // Results of the children are the input of their parent
+  if (!stack.empty()) stack.back().input_facets += frame.output_facets;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  Entry *entry = frame.entry;
+  entry->calls++;
+  entry->total += std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start);
+  if (frame.has_cache) {
+    if (frame.cache_hit) entry->cache_hits++;
+    else entry->cache_misses++;
+  }
+  entry->input_facets += frame.input_facets;
+  entry->output_facets += frame.output_facets;
+  entry->bytes += frame.bytes;
+
+  if (trace.size() < maxTraceEvents) {
+    trace.push_back({
+      entry,
+      std::chrono::duration_cast<std::chrono::microseconds>(frame.start - epoch).count(),
+      std::chrono::duration_cast<std::chrono::microseconds>(now - frame.start).count(),
+      std::hash<std::thread::id>{}(std::this_thread::get_id())
+    });
+  }
+}
+
+std::chrono::nanoseconds Profiler::Entry::self() const
+{
+  auto result = total;
+  for (const auto& child : children) result -= child.second->total;
+  return std::max(result, std::chrono::nanoseconds{0});
+}
+
+nlohmann::json Profiler::Entry::toJson() const
+{
+  nlohmann::json json;
+  json["category"] = category;
+  json["name"] = name;
+  if (!location.empty()) json["location"] = location;
+  json["calls"] = calls;
+  json["total_us"] = std::chrono::duration_cast<std::chrono::microseconds>(total).count();
+  json["self_us"] = std::chrono::duration_cast<std::chrono::microseconds>(self()).count();
+  if (cache_hits + cache_misses > 0) {
+    json["cache_hits"] = cache_hits;
+    json["cache_misses"] = cache_misses;
+  }
+  if (input_facets + output_facets > 0) {
+    json["input_facets"] = input_facets;
+    json["output_facets"] = output_facets;
+  }
+  if (bytes > 0) json["bytes"] = bytes;
+  if (!children.empty()) {
+    // Most expensive first
+    std::vector<const Entry *> sorted;
+    for (const auto& child : children) sorted.push_back(child.second.get());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b) { return a->total > b->total; });
+    auto& childrenJson = json["children"] = nlohmann::json::array();
+    for (const auto *child : sorted) childrenJson.push_back(child->toJson());
+  }
+  return json;
+}
+
+void Profiler::Entry::fold(const std::string& prefix, std::ostream& stream) const
+{
+  // Frame names must not contain the ';' separator
+  std::string frame = name + (location.empty() ? "" : " (" + location + ")");
+  std::replace(frame.begin(), frame.end(), ';', ',');
+  const std::string path = prefix.empty() ? frame : prefix + ";" + frame;
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(self()).count();
+  if (us > 0) stream << path << " " << us << "\n";
+  for (const auto& child : children) child.second->fold(path, stream);
+}
+
+nlohmann::json Profiler::toJson() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  nlohmann::json json = nlohmann::json::array();
+  for (const auto& child : root.children) json.push_back(child.second->toJson());
+  return json;
+}
+
+void Profiler::print(size_t count) const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  std::vector<const Entry *> entries;
+  std::function<void(const Entry&)> collect = [&](const Entry& entry) {
+    for (const auto& child : entry.children) {
+      entries.push_back(child.second.get());
+      collect(*child.second);
+    }
+  };
+  collect(root);
+  if (entries.empty()) return;
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) { return a->self() > b->self(); });
+
+  LOG("Profile (by self time):");
+  for (size_t i = 0; i < std::min(count, entries.size()); i++) {
+    const auto *entry = entries[i];
+    LOG("   %1$10.3f ms %2$8d x  %3$s %4$s %5$s",
+        std::chrono::duration<double, std::milli>(entry->self()).count(), entry->calls,
+        entry->category, entry->name, entry->location);
+  }
+}
+
+void Profiler::writeTrace(std::ostream& stream) const
+{
+  nlohmann::json events = nlohmann::json::array();
+  for (const auto& event : trace) {
+    nlohmann::json json;
+    json["name"] = event.entry->name;
+    json["cat"] = event.entry->category;
+    json["ph"] = "X";
+    json["ts"] = event.start_us;
+    json["dur"] = event.duration_us;
+    json["pid"] = 1;
+    json["tid"] = event.thread;
+    if (!event.entry->location.empty()) json["args"]["location"] = event.entry->location;
+    events.push_back(std::move(json));
+  }
+  nlohmann::json json;
+  json["traceEvents"] = std::move(events);
+  json["displayTimeUnit"] = "ms";
+  stream << json;
+}
+
+bool Profiler::write(const std::string& filename) const
+{
+  std::ofstream stream(filename, std::ios::out | std::ios::trunc);
+  if (!stream.is_open()) {
+    LOG(message_group::Error, "Can't open profile file '%1$s' for writing", filename);
+    return false;
+  }
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (boost::algorithm::iends_with(filename, ".folded") || boost::algorithm::iends_with(filename, ".txt")) {
+    for (const auto& child : root.children) child.second->fold("", stream);
+  } else {
+    if (trace.size() >= maxTraceEvents) {
+      LOG(message_group::Warning, "Profile trace truncated to the first %1$d scopes", maxTraceEvents);
+    }
+    writeTrace(stream);
+  }
+  return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "json/json.hpp"
+
+class Location;
+
+/*
+ * Hierarchical profiler for evaluation and geometry rendering, enabled by
+ * "--summary profile".
+ *
+ * Each profiled scope (a module instantiation, a function call, or a node
+ * evaluated by the GeometryEvaluator) is aggregated into a call tree keyed
+ * by the path of scope names and source locations, so repeated calls from
+ * the same place, e.g. in a loop, share one entry. Nodes of the geometry tree also record
+ * cache hits and misses, facet counts of their children and of their
+ * result, and the memory used by the result.
+ *
+ * The call tree is reported as JSON with the render summary. The raw scope
+ * timings can additionally be written as folded stacks (flamegraph.pl,
+ * speedscope) or as a Chrome trace (chrome://tracing, Perfetto).
+ */
+class Profiler
+{
+public:
+  static Profiler *instance() { if (!inst) inst = new Profiler; return inst; }
+
+  [[nodiscard]] bool isEnabled() const { return enabled; }
+  void enable() { enabled = true; }
+
+  // Opens a scope on the calling thread. Scopes must be closed in reverse order.
+  void begin(const char *category, const std::string& name, const std::string& location);
+  void begin(const char *category, const std::string& name, const Location& location);
+  // Records details of the innermost open scope
+  void setCacheHit(bool hit);
+  void addOutput(size_t facets, size_t bytes);
+  void end();
+
+  // RAII helper for scopes which are only profiled when enabled
+  class Scope
+  {
+public:
+    template <typename LocationType>
+    Scope(const char *category, const std::string& name, const LocationType& location) {
+      if (Profiler::instance()->isEnabled()) {
+        Profiler::instance()->begin(category, name, location);
+        active = true;
+      }
+    }
+    ~Scope() { if (active) Profiler::instance()->end(); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+private:
+    bool active{false};
+  };
+
+  [[nodiscard]] nlohmann::json toJson() const;
+  // The hottest entries by self time, for the console summary
+  void print(size_t count = 10) const;
+  // Writes folded stacks if filename ends in .folded or .txt, a Chrome trace otherwise
+  bool write(const std::string& filename) const;
+
+private:
+  Profiler() = default;
+
+  struct Entry {
+    std::string category;
+    std::string name;
+    std::string location;
+    size_t calls{0};
+    std::chrono::nanoseconds total{0};
+    size_t cache_hits{0};
+    size_t cache_misses{0};
+    size_t input_facets{0};
+    size_t output_facets{0};
+    size_t bytes{0};
+    std::map<std::tuple<std::string, std::string, std::string>, std::unique_ptr<Entry>> children;
+
+    [[nodiscard]] std::chrono::nanoseconds self() const;
+    [[nodiscard]] nlohmann::json toJson() const;
+    void fold(const std::string& prefix, std::ostream& stream) const;
+  };
+
+  struct Frame {
+    Entry *entry;
+    std::chrono::steady_clock::time_point start;
+    bool cache_hit{false};
+    bool has_cache{false};
+    size_t input_facets{0};
+    size_t output_facets{0};
+    size_t bytes{0};
+  };
+
+  struct TraceEvent {
+    const Entry *entry;
+    int64_t start_us;
+    int64_t duration_us;
+    size_t thread;
+  };
+
+  std::vector<Frame>& frames();
+  void writeTrace(std::ostream& stream) const;
+
+  static Profiler *inst;
+  static constexpr size_t maxTraceEvents = 1000000;
+
+  bool enabled{false};
+  mutable std::mutex mutex;
+  Entry root;
+  std::vector<TraceEvent> trace;
+  std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+};
@@ -76,6 +76,7 @@ void SourceFile::registerUse(const std::string& path, const Location& loc)
           loc.fileName() %
           path);
 
+  this->registered.push_back({false, path, path, loc});
   auto ext = fs::path(path).extension().generic_string();
 #ifdef ENABLE_PYTHON  
   if (boost::iequals(ext, ".py")) {
@@ -131,6 +132,7 @@ void SourceFile::registerInclude(const std::string& localpath, const std::string
           localpath %
           fullpath);
 
+  this->registered.push_back({true, localpath, fullpath, loc});
   this->includes[localpath] = fullpath;
   if (!loc.isNone()) {
     indicatorData.emplace_back(loc.firstLine(), loc.firstColumn(), loc.lastLine(), loc.lastColumn(), fullpath);
@@ -35,6 +35,15 @@ public:
   const std::string& getFilename() const { return this->filename; }
   const std::string getFullpath() const;
 
+  // use<> and include<> statements in the order they were registered
+  struct Registration {
+    bool include;
+    std::string localpath;
+    std::string fullpath;
+    Location location;
+  };
+  const std::vector<Registration>& registrations() const { return this->registered; }
+
   LocalScope scope;
   std::vector<std::string> usedlibs;
 
@@ -44,6 +53,7 @@ private:
   std::time_t include_modified(const std::string& filename) const;
 
   std::unordered_map<std::string, std::string> includes;
+  std::vector<Registration> registered;
   bool is_handling_dependencies{false};
 
   std::string path;
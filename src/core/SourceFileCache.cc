@@ -1,4 +1,5 @@
 #include "core/SourceFileCache.h"
+#include "core/ParseCache.h"
 #include "core/StatCache.h"
 #include "core/SourceFile.h"
 #include "utils/printutils.h"
@@ -103,7 +104,7 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
     print_messages_push();
 
     delete cacheEntry.parsed_file;
-    file = parse(cacheEntry.parsed_file, text, filename, mainFile, false) ? cacheEntry.parsed_file : nullptr;
+    file = ParseCache::instance()->parse(cacheEntry.parsed_file, text, filename, mainFile) ? cacheEntry.parsed_file : nullptr;
     PRINTDB("compiled file: %s", filename);
     cacheEntry.file = file;
     cacheEntry.cache_id = cache_id;
@@ -143,6 +143,9 @@ Value builtin_rands(Arguments arguments, const Location& loc)
     }
   }
 
+  // rands() advances the shared random number generator
+  arguments.session()->registerSideEffect();
+
   double min = arguments[0]->toDouble();
   if (std::isinf(min) || std::isnan(min)) {
     LOG(message_group::Warning, loc, arguments.documentRoot(), "rands() range min cannot be infinite");
@@ -1,13 +1,20 @@
 #include "geometry/ClipperUtils.h"
+#include "geometry/ConversionCache.h"
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
 #include "clipper2/clipper.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 #include <algorithm>
+#include <array>
 #include <clipper2/clipper.engine.h>
 #include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 #include <utility>
 #include <memory>
 #include <cstddef>
@@ -104,6 +111,192 @@ void SimplifyPolyTree(const Clipper2Lib::PolyPath64& polytree, double epsilon, C
   }
 }
 
+// Below this number of points, a single Clipper operation is faster than a tree of them
+constexpr size_t unionLeafPoints = 4096;
+
+/*
+   Consecutive paths which have to be processed together, e.g. an outline
+   and its holes. Each group on its own has a winding number >= 0 everywhere,
+   so the NonZero union of several groups can be computed in any grouping.
+ */
+struct PathGroup {
+  const Clipper2Lib::Path64 *begin;
+  const Clipper2Lib::Path64 *end;
+};
+
+PathGroup wholePaths(const Clipper2Lib::Paths64& paths)
+{
+  return {paths.data(), paths.data() + paths.size()};
+}
+
+struct Bounds {
+  int64_t min_x{std::numeric_limits<int64_t>::max()};
+  int64_t min_y{std::numeric_limits<int64_t>::max()};
+  int64_t max_x{std::numeric_limits<int64_t>::min()};
+  int64_t max_y{std::numeric_limits<int64_t>::min()};
+
+  explicit Bounds(const PathGroup& group) {
+    for (auto path = group.begin; path != group.end; ++path) {
+      for (const auto& p : *path) {
+        min_x = std::min(min_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_x = std::max(max_x, p.x);
+        max_y = std::max(max_y, p.y);
+      }
+    }
+  }
+  [[nodiscard]] bool isEmpty() const { return min_x > max_x; }
+  // True if the bounds are closer than gap to each other
+  [[nodiscard]] bool overlaps(const Bounds& other, int64_t gap) const {
+    return min_x <= other.max_x + gap && other.min_x <= max_x + gap &&
+           min_y <= other.max_y + gap && other.min_y <= max_y + gap;
+  }
+};
+
+/*
+   Partitions the groups into clusters whose bounds, grown by margin, don't
+   overlap those of any other cluster, so each cluster can be processed on
+   its own. Empty groups are dropped. Clusters, and the groups in them, are
+   ordered from left to right.
+ */
+std::vector<std::vector<PathGroup>> clusterByBounds(const std::vector<PathGroup>& groups, int64_t margin = 0)
+{
+  std::vector<Bounds> bounds;
+  bounds.reserve(groups.size());
+  std::vector<size_t> order;
+  for (const auto& group : groups) {
+    bounds.emplace_back(group);
+    if (!bounds.back().isEmpty()) order.push_back(bounds.size() - 1);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return bounds[a].min_x < bounds[b].min_x; });
+
+  std::vector<size_t> parent(groups.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](size_t i) {
+      while (parent[i] != i) i = parent[i] = parent[parent[i]];
+      return i;
+    };
+
+  // Sweep from left to right, comparing each group with those it overlaps in x
+  const int64_t gap = 2 * margin;
+  std::vector<size_t> active;
+  for (const size_t i : order) {
+    active.erase(std::remove_if(active.begin(), active.end(), [&](size_t a) {
+      return bounds[a].max_x + gap < bounds[i].min_x;
+    }), active.end());
+    for (const size_t a : active) {
+      if (bounds[a].overlaps(bounds[i], gap)) parent[find(a)] = find(i);
+    }
+    active.push_back(i);
+  }
+
+  std::vector<std::vector<PathGroup>> clusters;
+  std::unordered_map<size_t, size_t> cluster_of_root;
+  for (const size_t i : order) {
+    auto [it, inserted] = cluster_of_root.emplace(find(i), clusters.size());
+    if (inserted) clusters.emplace_back();
+    clusters[it->second].push_back(groups[i]);
+  }
+  return clusters;
+}
+
+/*
+   NonZero union of the groups as a balanced tree of unions, the two halves
+   of each being computed in parallel. Spatially sorted groups keep the
+   intermediate results small.
+ */
+template <class Result>
+void unionTree(const PathGroup *begin, const PathGroup *end, Result& result)
+{
+  size_t num_points = 0;
+  for (auto group = begin; group != end && num_points <= unionLeafPoints; ++group) {
+    for (auto path = group->begin; path != group->end; ++path) num_points += path->size();
+  }
+
+  Clipper2Lib::Clipper64 clipper;
+  clipper.PreserveCollinear(false);
+  if (end - begin < 2 || num_points <= unionLeafPoints) {
+    Clipper2Lib::Paths64 paths;
+    for (auto group = begin; group != end; ++group) paths.insert(paths.end(), group->begin, group->end);
+    clipper.AddSubject(paths);
+  } else {
+    const PathGroup *mid = begin + (end - begin) / 2;
+    std::array<Clipper2Lib::Paths64, 2> halves;
+    parallelizable_for(0, 2, [&](size_t i) {
+      if (i == 0) unionTree(begin, mid, halves[0]);
+      else unionTree(mid, end, halves[1]);
+    });
+    clipper.AddSubject(halves[0]);
+    clipper.AddSubject(halves[1]);
+  }
+  clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, result);
+}
+
+// Concatenates polygons which don't overlap
+std::unique_ptr<Polygon2d> mergeDisjoint(std::vector<std::unique_ptr<Polygon2d>>& parts)
+{
+  if (parts.size() == 1) return std::move(parts[0]);
+  auto result = std::make_unique<Polygon2d>();
+  for (const auto& part : parts) {
+    for (const auto& outline : part->outlines()) result->addOutline(outline);
+  }
+  result->setSanitized(true);
+  return result;
+}
+
+// Union of the groups as paths, with independent clusters processed in parallel
+Clipper2Lib::Paths64 unionPaths(const std::vector<PathGroup>& groups)
+{
+  const auto clusters = clusterByBounds(groups);
+  std::vector<Clipper2Lib::Paths64> parts(clusters.size());
+  parallelizable_for(0, clusters.size(), [&](size_t i) {
+    unionTree(clusters[i].data(), clusters[i].data() + clusters[i].size(), parts[i]);
+  });
+  Clipper2Lib::Paths64 result;
+  for (auto& part : parts) result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+  return result;
+}
+
+// Union of the groups as a polygon, with independent clusters processed in parallel
+std::unique_ptr<Polygon2d> unionPolygon(const std::vector<PathGroup>& groups, int scale_bits)
+{
+  const auto clusters = clusterByBounds(groups);
+  std::vector<std::unique_ptr<Polygon2d>> parts(clusters.size());
+  parallelizable_for(0, clusters.size(), [&](size_t i) {
+    Clipper2Lib::PolyTree64 polytree;
+    unionTree(clusters[i].data(), clusters[i].data() + clusters[i].size(), polytree);
+    parts[i] = toPolygon2d(polytree, scale_bits);
+  });
+  return mergeDisjoint(parts);
+}
+
+/*
+   Scaled paths of a polygon, sanitized and oriented positive if requested.
+   Polygons are shared between nodes and operators, so the same one is often
+   converted many times.
+ */
+std::shared_ptr<const Clipper2Lib::Paths64> getPaths(const std::shared_ptr<const Polygon2d>& poly, int scale_bits, bool sanitized)
+{
+  static ConversionCache<Polygon2d, Clipper2Lib::Paths64> converted;
+  const int variant = 2 * scale_bits + (sanitized ? 1 : 0);
+  if (auto paths = converted.get(poly, variant)) return paths;
+
+  auto paths = std::make_shared<Clipper2Lib::Paths64>(fromPolygon2d(*poly, scale_bits));
+  if (sanitized) {
+    if (!poly->isSanitized()) {
+      *paths = Clipper2Lib::PolyTreeToPaths64(*sanitize(*paths));
+    } else if (Clipper2Lib::Area(*paths) < 0) {
+      // Mirrored, make the outlines positive again so it adds to unions
+      for (auto& path : *paths) std::reverse(path.begin(), path.end());
+    }
+  }
+
+  size_t cost = sizeof(Clipper2Lib::Paths64) + paths->size() * sizeof(Clipper2Lib::Path64);
+  for (const auto& path : *paths) cost += path.size() * sizeof(Clipper2Lib::Point64);
+  converted.insert(poly, variant, paths, cost);
+  return paths;
+}
+
 }  // namespace
 
 // Using 1 bit less precision than the maximum possible, to limit the chance
@@ -218,19 +411,38 @@ std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree,
 
    May return an empty Polygon2d, but will not return nullptr.
  */
-std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsvector,
+std::unique_ptr<Polygon2d> apply(const std::vector<std::shared_ptr<const Clipper2Lib::Paths64>>& pathsvector,
 				 Clipper2Lib::ClipType clipType, int scale_bits)
 {
+  if (clipType == Clipper2Lib::ClipType::Union) {
+    // Disjoint parts of a union are independent, and many children are merged pairwise
+    std::vector<PathGroup> groups;
+    groups.reserve(pathsvector.size());
+    for (const auto& paths : pathsvector) groups.push_back(wholePaths(*paths));
+    return unionPolygon(groups, scale_bits);
+  }
+
   Clipper2Lib::Clipper64 clipper;
   clipper.PreserveCollinear(false);
 
   if (clipType == Clipper2Lib::ClipType::Intersection && pathsvector.size() >= 2) {
+    // Nothing to intersect if any two children are apart
+    const Bounds first(wholePaths(*pathsvector[0]));
+    for (const auto& paths : pathsvector) {
+      const Bounds bounds(wholePaths(*paths));
+      if (bounds.isEmpty() || !bounds.overlaps(first, 0)) {
+        auto empty = std::make_unique<Polygon2d>();
+        empty->setSanitized(true);
+        return empty;
+      }
+    }
+
     // intersection operations must be split into a sequence of binary operations
-    auto source = pathsvector[0];
+    auto source = *pathsvector[0];
     Clipper2Lib::PolyTree64 result;
     for (unsigned int i = 1; i < pathsvector.size(); ++i) {
       clipper.AddSubject(source);
-      clipper.AddClip(pathsvector[i]);
+      clipper.AddClip(*pathsvector[i]);
       clipper.Execute(clipType, Clipper2Lib::FillRule::NonZero, result);
       if (i != pathsvector.size() - 1) {
         source = Clipper2Lib::PolyTreeToPaths64(result);
@@ -240,14 +452,16 @@ std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsv
     return ClipperUtils::toPolygon2d(result, scale_bits);
   }
 
+  // Only the children touching the first one can take something away from it
+  const Bounds subject_bounds(wholePaths(*pathsvector[0]));
   bool first = true;
   for (const auto& paths : pathsvector) {
     if (first) {
-      clipper.AddSubject(paths);
+      clipper.AddSubject(*paths);
       first = false;
     }
-    else {
-      clipper.AddClip(paths);
+    else if (clipType != Clipper2Lib::ClipType::Difference || Bounds(wholePaths(*paths)).overlaps(subject_bounds, 0)) {
+      clipper.AddClip(*paths);
     }
   }
   Clipper2Lib::PolyTree64 sumresult;
@@ -268,19 +482,15 @@ std::unique_ptr<Polygon2d> apply(const std::vector<std::shared_ptr<const Polygon
 {
   const int scale_bits = scaleBitsFromPrecision();
 
-  std::vector<Clipper2Lib::Paths64> pathsvector;
-  for (const auto& polygon : polygons) {
-    if (polygon) {
-      auto polypaths = fromPolygon2d(*polygon, scale_bits);
-      if (!polygon->isSanitized()) {
-        polypaths = Clipper2Lib::PolyTreeToPaths64(*sanitize(polypaths));
-      }
-      pathsvector.push_back(std::move(polypaths));
+  std::vector<std::shared_ptr<const Clipper2Lib::Paths64>> pathsvector(polygons.size());
+  parallelizable_for(0, polygons.size(), [&](size_t i) {
+    if (polygons[i]) {
+      pathsvector[i] = getPaths(polygons[i], scale_bits, true);
     } else {
       // Insert empty object as this could be the positive object in a difference
-      pathsvector.emplace_back();
+      pathsvector[i] = std::make_shared<Clipper2Lib::Paths64>();
     }
-  }
+  });
   auto res = apply(pathsvector, clipType, scale_bits);
   assert(res);
   return res;
@@ -297,41 +507,50 @@ std::unique_ptr<Polygon2d> applyMinkowski(const std::vector<std::shared_ptr<cons
   if (it == polygons.end()) return nullptr;
   const int scale_bits = scaleBitsFromPrecision();
 
-  Clipper2Lib::Clipper64 clipper;
-  clipper.PreserveCollinear(false);
-  auto lhs = fromPolygon2d(polygons[0] ? *polygons[0] : Polygon2d(), scale_bits);
+  auto lhs = polygons[0] ? *getPaths(polygons[0], scale_bits, false) : Clipper2Lib::Paths64();
 
   for (size_t i = 1; i < polygons.size(); ++i) {
     if (!polygons[i]) continue;
-    Clipper2Lib::Paths64 minkowski_terms;
-    auto rhs = fromPolygon2d(*polygons[i], scale_bits);
+    const auto rhs_ptr = getPaths(polygons[i], scale_bits, false);
+    const auto& rhs = *rhs_ptr;
 
     // First, convolve each outline of lhs with the outlines of rhs
-    for (auto const& rhs_path : rhs) {
-      for (auto const& lhs_path : lhs) {
-        Clipper2Lib::Paths64 result;
-        minkowski_outline(lhs_path, rhs_path, result, true, true);
-        minkowski_terms.insert(minkowski_terms.end(), result.begin(), result.end());
-      }
-    }
+    std::vector<Clipper2Lib::Paths64> outline_terms(rhs.size() * lhs.size());
+    parallelizable_cross_product_transform(rhs, lhs, outline_terms.begin(),
+                                           [](const Clipper2Lib::Path64& rhs_path, const Clipper2Lib::Path64& lhs_path) {
+      Clipper2Lib::Paths64 result;
+      minkowski_outline(lhs_path, rhs_path, result, true, true);
+      return result;
+    });
 
     // Then, fill the central parts
-    fill_minkowski_insides(lhs, rhs, minkowski_terms);
-    fill_minkowski_insides(rhs, lhs, minkowski_terms);
+    Clipper2Lib::Paths64 lhs_insides, rhs_insides;
+    fill_minkowski_insides(lhs, rhs, lhs_insides);
+    fill_minkowski_insides(rhs, lhs, rhs_insides);
 
-    // This union operation must be performed at each iteration since the minkowski_terms
+    // Each quad is positive on its own, while the translated copies have to keep their holes.
+    // This union operation must be performed at each iteration since the terms
     // now contain lots of small quads
-    clipper.Clear();
-    clipper.AddSubject(minkowski_terms);
+    std::vector<PathGroup> groups;
+    for (const auto& quads : outline_terms) {
+      for (const auto& quad : quads) groups.push_back({&quad, &quad + 1});
+    }
+    for (size_t start = 0; !lhs.empty() && start < lhs_insides.size(); start += lhs.size()) {
+      groups.push_back({lhs_insides.data() + start, lhs_insides.data() + start + lhs.size()});
+    }
+    for (size_t start = 0; !rhs.empty() && start < rhs_insides.size(); start += rhs.size()) {
+      groups.push_back({rhs_insides.data() + start, rhs_insides.data() + start + rhs.size()});
+    }
 
     if (i != polygons.size() - 1) {
-      clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, lhs);
+      lhs = unionPaths(groups);
+    } else {
+      return unionPolygon(groups, scale_bits);
     }
   }
 
-  Clipper2Lib::PolyTree64 polytree;
-  clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, polytree);
-  return toPolygon2d(polytree, scale_bits);
+  // The last polygon was missing
+  return unionPolygon({wholePaths(lhs)}, scale_bits);
 }
 
 std::unique_ptr<Polygon2d> applyOffset(const Polygon2d& poly, double offset, Clipper2Lib::JoinType joinType,
@@ -340,15 +559,33 @@ std::unique_ptr<Polygon2d> applyOffset(const Polygon2d& poly, double offset, Cli
   const bool isMiter = joinType == Clipper2Lib::JoinType::Miter;
   const bool isRound = joinType == Clipper2Lib::JoinType::Round;
   const int scale_bits = scaleBitsFromPrecision();
-  Clipper2Lib::ClipperOffset co(
-    isMiter ? miter_limit : 2.0,
-    isRound ? std::ldexp(arc_tolerance, scale_bits) : 1.0
-    );
-  auto p = ClipperUtils::fromPolygon2d(poly, scale_bits); 
-  co.AddPaths(p, joinType, Clipper2Lib::EndType::Polygon);
-  Clipper2Lib::PolyTree64 result;
-  co.Execute(std::ldexp(offset, scale_bits), result);
-  auto r = toPolygon2d(result, scale_bits);
+  auto p = ClipperUtils::fromPolygon2d(poly, scale_bits);
+
+  // Outlines only grow by offset, or miter_limit times that at sharp corners,
+  // so outlines further apart than that can be offset independently. Holes
+  // lie within the bounds of their outline and end up in its cluster.
+  const double max_growth = std::max(offset, 0.0) * (isMiter ? std::max(miter_limit, 2.0) : 2.0);
+  const auto margin = static_cast<int64_t>(std::ceil(std::ldexp(max_growth, scale_bits))) + 1;
+  std::vector<PathGroup> groups;
+  groups.reserve(p.size());
+  for (const auto& path : p) groups.push_back({&path, &path + 1});
+  const auto clusters = clusterByBounds(groups, margin);
+
+  std::vector<std::unique_ptr<Polygon2d>> parts(clusters.size());
+  parallelizable_for(0, clusters.size(), [&](size_t i) {
+    Clipper2Lib::ClipperOffset co(
+      isMiter ? miter_limit : 2.0,
+      isRound ? std::ldexp(arc_tolerance, scale_bits) : 1.0
+      );
+    Clipper2Lib::Paths64 paths;
+    paths.reserve(clusters[i].size());
+    for (const auto& group : clusters[i]) paths.push_back(*group.begin);
+    co.AddPaths(paths, joinType, Clipper2Lib::EndType::Polygon);
+    Clipper2Lib::PolyTree64 result;
+    co.Execute(std::ldexp(offset, scale_bits), result);
+    parts[i] = toPolygon2d(result, scale_bits);
+  });
+  auto r = mergeDisjoint(parts);
   r->transform3d(poly.getTransform3d());	  
   return r;
 }
@@ -0,0 +1,233 @@
+#include "geometry/CompressedPolySet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "geometry/PolySet.h"
+
+namespace {
+
+class Writer
+{
+public:
+  Writer(std::vector<uint8_t>& data) : data(data) {}
+
+  void byte(uint8_t value) { data.push_back(value); }
+
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      data.push_back(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+  }
+
+  void zigzag(int64_t value) {
+    varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  // Stores the XOR difference to the previous value as a header byte
+  // (trailing zero bytes << 4 | stored bytes) followed by the stored bytes.
+  // Bits is the unsigned integer type of the size of Value.
+  template <typename Value, typename Bits>
+  void coordinate(Value value, Bits& prev) {
+    static_assert(sizeof(Value) == sizeof(Bits));
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Bits diff = bits ^ prev;
+    prev = bits;
+    if (diff == 0) {
+      byte(0);
+      return;
+    }
+    uint8_t trailing = 0;
+    while ((diff & 0xff) == 0) {
+      diff >>= 8;
+      trailing++;
+    }
+    uint8_t stored = 0;
+    for (Bits rest = diff; rest != 0; rest >>= 8) stored++;
+    byte(static_cast<uint8_t>(trailing << 4 | stored));
+    for (uint8_t i = 0; i < stored; i++) {
+      byte(static_cast<uint8_t>(diff));
+      diff >>= 8;
+    }
+  }
+
+private:
+  std::vector<uint8_t>& data;
+};
+
+class Reader
+{
+public:
+  Reader(const std::vector<uint8_t>& data) : ptr(data.data()) {}
+
+  uint8_t byte() { return *ptr++; }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+      b = *ptr++;
+      value |= static_cast<uint64_t>(b & 0x7f) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    return value;
+  }
+
+  int64_t zigzag() {
+    const uint64_t value = varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  template <typename Value, typename Bits>
+  Value coordinate(Bits& prev) {
+    static_assert(sizeof(Value) == sizeof(Bits));
+    const uint8_t header = byte();
+    Bits diff = 0;
+    const int stored = header & 0x0f;
+    for (int i = 0; i < stored; i++) diff |= static_cast<Bits>(byte()) << (8 * i);
+    prev ^= diff << (8 * (header >> 4));
+    Value value;
+    std::memcpy(&value, &prev, sizeof(value));
+    return value;
+  }
+
+private:
+  const uint8_t *ptr;
+};
+
+// True if all coordinates survive a round trip through float, as those of
+// meshes imported from single precision formats like STL do
+bool hasFloatVertices(const PolySet& ps)
+{
+  for (const auto& v : ps.vertices) {
+    for (int i = 0; i < 3; i++) {
+      if (static_cast<double>(static_cast<float>(v[i])) != v[i]) return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+std::unique_ptr<CompressedPolySet> CompressedPolySet::encode(const PolySet& ps)
+{
+  if (!ps.curves.empty() || !ps.surfaces.empty()) return nullptr;
+
+  std::unique_ptr<CompressedPolySet> result(new CompressedPolySet);
+  result->dim = ps.getDimension();
+  result->convexity = ps.getConvexity();
+  result->convex = ps.convexValue();
+  result->triangular = ps.isTriangular();
+  result->num_vertices = ps.vertices.size();
+  result->num_faces = ps.indices.size();
+  result->colors = ps.colors;
+
+  auto& data = result->data;
+  data.reserve(ps.indices.size() * 4 + ps.vertices.size() * 12);
+  Writer writer(data);
+
+  // Face sizes, unless all faces have the same size
+  size_t uniform = ps.indices.empty() ? 0 : ps.indices.front().size();
+  for (const auto& face : ps.indices) {
+    if (face.size() != uniform) {
+      uniform = 0;
+      break;
+    }
+  }
+  writer.varint(uniform);
+  if (uniform == 0) {
+    for (const auto& face : ps.indices) writer.varint(face.size());
+  }
+
+  // Indices as differences to the previous index; consecutive indices are usually close
+  int64_t prev_index = 0;
+  for (const auto& face : ps.indices) {
+    for (const auto index : face) {
+      writer.zigzag(index - prev_index);
+      prev_index = index;
+    }
+  }
+
+  // Single precision vertices are stored as floats, which is still lossless
+  result->float_vertices = hasFloatVertices(ps);
+  if (result->float_vertices) {
+    uint32_t prev[3] = {0, 0, 0};
+    for (const auto& v : ps.vertices) {
+      for (int i = 0; i < 3; i++) writer.coordinate(static_cast<float>(v[i]), prev[i]);
+    }
+  } else {
+    uint64_t prev[3] = {0, 0, 0};
+    for (const auto& v : ps.vertices) {
+      for (int i = 0; i < 3; i++) writer.coordinate(v[i], prev[i]);
+    }
+  }
+
+  // Color indices as (index, run length), they are mostly constant over long runs
+  for (size_t i = 0; i < ps.color_indices.size();) {
+    size_t run = 1;
+    while (i + run < ps.color_indices.size() && ps.color_indices[i + run] == ps.color_indices[i]) run++;
+    writer.zigzag(ps.color_indices[i]);
+    writer.varint(run);
+    result->num_color_runs++;
+    i += run;
+  }
+
+  data.shrink_to_fit();
+  return result;
+}
+
+std::shared_ptr<PolySet> CompressedPolySet::decode() const
+{
+  auto ps = std::make_shared<PolySet>(dim, convex);
+  ps->setConvexity(static_cast<int>(convexity));
+  ps->setTriangular(triangular);
+  ps->colors = colors;
+
+  Reader reader(data);
+  const size_t uniform = reader.varint();
+  ps->indices.resize(num_faces);
+  if (uniform != 0) {
+    for (auto& face : ps->indices) face.resize(uniform);
+  } else {
+    for (auto& face : ps->indices) face.resize(reader.varint());
+  }
+
+  int64_t prev_index = 0;
+  for (auto& face : ps->indices) {
+    for (auto& index : face) {
+      prev_index += reader.zigzag();
+      index = static_cast<int>(prev_index);
+    }
+  }
+
+  ps->vertices.resize(num_vertices);
+  if (float_vertices) {
+    uint32_t prev[3] = {0, 0, 0};
+    for (auto& v : ps->vertices) {
+      for (int i = 0; i < 3; i++) v[i] = reader.coordinate<float>(prev[i]);
+    }
+  } else {
+    uint64_t prev[3] = {0, 0, 0};
+    for (auto& v : ps->vertices) {
+      for (int i = 0; i < 3; i++) v[i] = reader.coordinate<double>(prev[i]);
+    }
+  }
+
+  for (size_t i = 0; i < num_color_runs; i++) {
+    const auto color_index = static_cast<int32_t>(reader.zigzag());
+    ps->color_indices.insert(ps->color_indices.end(), reader.varint(), color_index);
+  }
+  return ps;
+}
+
+size_t CompressedPolySet::memsize() const
+{
+  return sizeof(CompressedPolySet) + data.capacity() + colors.capacity() * sizeof(Color4f);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "utils/boost-utils.h"
+
+class PolySet;
+
+/*
+ * Compact, lossless encoding of a PolySet, used by the geometry cache to
+ * hold more entries in the same memory budget.
+ *
+ * Faces are stored as one flat buffer of face sizes and zigzag/varint
+ * encoded index deltas. Vertex coordinates are XORed with the same
+ * coordinate of the previous vertex, and only the non-zero bytes of the
+ * result are stored, which removes the shared sign, exponent and high
+ * mantissa bits of neighbouring vertices as well as the zero low bits of
+ * grid-aligned values. If every coordinate is exactly representable in
+ * single precision, as for meshes imported from STL, the same is done on
+ * their float representation. Decoding restores the exact same PolySet.
+ */
+class CompressedPolySet
+{
+public:
+  // Returns nullptr for PolySets which can't be encoded (with curves or surfaces)
+  static std::unique_ptr<CompressedPolySet> encode(const PolySet& ps);
+  [[nodiscard]] std::shared_ptr<PolySet> decode() const;
+  [[nodiscard]] size_t memsize() const;
+
+private:
+  CompressedPolySet() = default;
+
+  unsigned int dim{3};
+  unsigned int convexity{1};
+  boost::tribool convex;
+  bool triangular{false};
+  bool float_vertices{false};
+  size_t num_vertices{0};
+  size_t num_faces{0};
+  size_t num_color_runs{0};
+  std::vector<uint8_t> data;
+  std::vector<Color4f> colors;
+};
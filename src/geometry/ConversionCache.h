@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/*
+ * Results of converting shared objects to another representation, e.g.
+ * Geometries to Manifolds. Sources are shared between nodes and operators,
+ * so the same one is often converted many times.
+ *
+ * Entries are keyed by the address of their source and a variant, for
+ * conversions which take parameters, and are only returned while their source
+ * is alive. The cache doesn't keep sources alive, but it does keep results
+ * alive: their total size is bounded, and the least recently used ones are
+ * dropped to stay within it. Safe to use from several threads.
+ */
+template <class Source, class Target>
+class ConversionCache
+{
+public:
+  explicit ConversionCache(size_t limit = 64ul * 1024ul * 1024ul) : limit(limit) {}
+
+  // Returns nullptr if source wasn't converted with this variant, or is gone
+  std::shared_ptr<const Target> get(const std::shared_ptr<const Source>& source, int variant = 0)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find({source.get(), variant});
+    if (it == index.end()) return nullptr;
+    auto entry = it->second;
+    if (entry->source.expired()) {
+      // The address is being reused by another object
+      unlink(it);
+      return nullptr;
+    }
+    entries.splice(entries.begin(), entries, entry);
+    return entry->target;
+  }
+
+  // cost is the size of target in bytes. Returns false if it's too large to keep.
+  bool insert(const std::shared_ptr<const Source>& source, int variant,
+              const std::shared_ptr<const Target>& target, size_t cost)
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const Key key{source.get(), variant};
+    auto it = index.find(key);
+    if (it != index.end()) unlink(it);
+    if (cost > limit) return false;
+    while (total + cost > limit) unlink(index.find(entries.back().key));
+    entries.push_front({key, source, target, cost});
+    index.emplace(key, entries.begin());
+    total += cost;
+    return true;
+  }
+
+  size_t size() const { const std::lock_guard<std::mutex> lock(mutex); return entries.size(); }
+  size_t totalCost() const { const std::lock_guard<std::mutex> lock(mutex); return total; }
+  void clear() { const std::lock_guard<std::mutex> lock(mutex); index.clear(); entries.clear(); total = 0; }
+
+private:
+  using Key = std::pair<const Source *, int>;
+  struct Entry {
+    Key key;
+    std::weak_ptr<const Source> source;
+    std::shared_ptr<const Target> target;
+    size_t cost;
+  };
+  using Entries = std::list<Entry>; // Most recently used first
+
+  void unlink(typename std::map<Key, typename Entries::iterator>::iterator it)
+  {
+    total -= it->second->cost;
+    entries.erase(it->second);
+    index.erase(it);
+  }
+
+  mutable std::mutex mutex;
+  Entries entries;
+  std::map<Key, typename Entries::iterator> index;
+  size_t limit;
+  size_t total{0};
+};
@@ -1,10 +1,14 @@
 #include "geometry/GeometryCache.h"
 #include "utils/printutils.h"
 #include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
+#include "Feature.h"
 
+#include <chrono>
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <utility>
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
@@ -14,16 +18,32 @@ GeometryCache *GeometryCache::inst = nullptr;
 
 std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
 {
-  const auto& geom = this->cache[id]->geom;
+  const auto *entry = this->cache[id];
+  const std::shared_ptr<const Geometry> geom = entry->compressed ? entry->compressed->decode() : entry->geom;
+  ++num_hits;
 #ifdef DEBUG
   PRINTDB("Geometry Cache hit: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
 #endif
   return geom;
 }
 
-bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
+bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+                           std::chrono::duration<double> computeTime)
 {
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+  // Only freshly computed results are inserted
+  ++num_misses;
+  const size_t memsize = geom ? geom->memsize() : 0;
+  if (Feature::ExperimentalCompactGeometryCache.is_enabled()) {
+    if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
+      auto compressed = CompressedPolySet::encode(*ps);
+      if (compressed && compressed->memsize() < memsize) {
+        const size_t cost = compressed->memsize();
+        // The value stays the compute time, so compact entries also rank higher per byte
+        return this->cache.insert(id, new cache_entry(std::move(compressed)), cost, computeTime.count());
+      }
+    }
+  }
+  auto inserted = this->cache.insert(id, new cache_entry(geom), memsize, computeTime.count());
 #if defined(ENABLE_CGAL) && defined(DEBUG)
   assert(!dynamic_cast<const CGALNefGeometry *>(geom.get()));
   if (inserted) PRINTDB("Geometry Cache insert: %s (%d bytes)",
@@ -58,6 +78,8 @@ void GeometryCache::print()
 {
   LOG("Geometries in cache: %1$d", this->cache.size());
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
+  LOG("Geometry cache: %1$d hits, %2$d misses, %3$d evictions, %4$d rejected",
+      num_hits, num_misses, evictions(), rejections());
 }
 
 GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom)
@@ -65,3 +87,9 @@ GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& g
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
+
+GeometryCache::cache_entry::cache_entry(std::unique_ptr<CompressedPolySet> compressed)
+  : compressed(std::move(compressed))
+{
+  if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
+}
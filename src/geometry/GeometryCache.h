@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <string>
 
 #include "Cache.h"
 #include "geometry/Geometry.h"
+#include "geometry/CompressedPolySet.h"
 
 class GeometryCache
 {
@@ -16,10 +18,16 @@ public:
 
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const class Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom);
+  // computeTime is the time it took to create geom, which makes it more valuable to keep
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+              std::chrono::duration<double> computeTime = std::chrono::duration<double>::zero());
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
+  size_t hits() const { return num_hits; }
+  size_t misses() const { return num_misses; }
+  size_t evictions() const { return cache.evictions(); }
+  size_t rejections() const { return cache.rejections(); }
   void setMaxSizeMB(size_t limit);
   void clear() { cache.clear(); }
   void print();
@@ -29,9 +37,13 @@ private:
 
   struct cache_entry {
     std::shared_ptr<const class Geometry> geom;
+    // Set instead of geom for PolySets stored in compact form
+    std::unique_ptr<CompressedPolySet> compressed;
     std::string msg;
     cache_entry(const std::shared_ptr<const Geometry>& geom);
+    cache_entry(std::unique_ptr<CompressedPolySet> compressed);
   };
 
   Cache<std::string, cache_entry> cache;
+  mutable size_t num_hits{0}, num_misses{0};
 };
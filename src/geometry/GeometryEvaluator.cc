@@ -4,9 +4,11 @@
 #include "geometry/linalg.h"
 #include "core/Tree.h"
 #include "geometry/GeometryCache.h"
+#include "geometry/HalfEdgeMesh.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/Barcode1d.h"
 #include "core/ModuleInstantiation.h"
+#include "core/Profiler.h"
 #include "core/State.h"
 #include "core/ColorNode.h"
 #include "core/OffsetNode.h"
@@ -202,59 +204,6 @@ int operator==(const EdgeKey &t1, const EdgeKey &t2)
         return 0;
 }
 
-
-std::unordered_map<EdgeKey, EdgeVal, boost::hash<EdgeKey> > createEdgeDb(const std::vector<IndexedFace> &indices)
-{
-  std::unordered_map<EdgeKey, EdgeVal, boost::hash<EdgeKey> > edge_db;
-  EdgeKey edge;                                                    
-  //
-  // Create EDGE DB
-  EdgeVal val;
-  val.sel=0;
-  val.facea=-1;
-  val.faceb=-1;
-  val.posa=-1;
-  val.posb=-1;
-  int ind1, ind2;
-  for(int i=0;i<indices.size();i++) {
-    int  n=indices[i].size();
-    for(int j=0;j<n;j++) {
-      ind1=indices[i][j];	    
-      ind2=indices[i][(j+1)%n];	    
-      if(ind2 > ind1){
-        edge.ind1=ind1;
-        edge.ind2=ind2;	
-	if(edge_db.count(edge) == 0) edge_db[edge]=val;
-	edge_db[edge].facea=i;
-	edge_db[edge].posa=j;
-      } else {
-        edge.ind1=ind2;
-        edge.ind2=ind1;	
-	if(edge_db.count(edge) == 0) edge_db[edge]=val;
-	edge_db[edge].faceb=i;
-	edge_db[edge].posb=j;
-      }
-    }    
-  }
-  int error=0;
-  for(auto &e: edge_db) {
-    if(e.second.facea == -1 || e.second.faceb == -1) {
-      printf("Mismatched EdgeDB ind1=%d idn2=%d facea=%d faceb=%d\n",e.first.ind1, e.first.ind2, e.second.facea, e.second.faceb);
-      error=1;
-    }
-  }
-  if(error) {
-    for(unsigned int i=0;i<indices.size();i++)
-    {
-      auto &face=indices[i];
-      printf("%d :",i);
-      for(unsigned int j=0;j<face.size();j++) printf("%d ",face[j]);
-      printf("\n");
-    } // tri 5-9-11 missing
-    assert(0);	      
-  }
-  return edge_db;
-}
 	
 bool GeometryEvaluator::isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const {
   if (!item.first->modinst->isBackground() && item.second) {
@@ -289,82 +238,30 @@ bool mergeTrianglesOpposite(const IndexedFace & poly1, const IndexedFace &poly2)
 typedef std::vector<int> intList;
 typedef std::vector<intList> intListList;
 
-class TriCombineStub
-{
-	public:
-		int ind1, ind2, ind3 ;
-		int operator==(const TriCombineStub ref)
-		{
-			if(this->ind1 == ref.ind1 && this->ind2 == ref.ind2) return 1;
-			return 0;
-		}
-};
-
-unsigned int hash_value(const TriCombineStub& r) {
-	unsigned int i;
-	i=r.ind1 |(r.ind2<<16) ;
-        return i;
-}
+static indexedFaceList mergeTrianglesSub(const HalfEdgeMesh &mesh, const std::vector<Vector3d> &vert);
 
-int operator==(const TriCombineStub &t1, const TriCombineStub &t2) 
+static indexedFaceList mergeTrianglesSub(const std::vector<IndexedFace> &triangles, const std::vector<Vector3d> &vert)
 {
-	if(t1.ind1 == t2.ind1 && t1.ind2 == t2.ind2) return 1;
-	return 0;
+	int num_vertices=0;
+	for(const auto &tri : triangles)
+		for(const auto ind : tri) num_vertices=std::max(num_vertices, ind+1);
+	return mergeTrianglesSub(HalfEdgeMesh(triangles, num_vertices), vert);
 }
 
-static indexedFaceList mergeTrianglesSub(const std::vector<IndexedFace> &triangles, const std::vector<Vector3d> &vert)
+// Merges the faces of mesh into the polygons outlined by its border half-edges
+static indexedFaceList mergeTrianglesSub(const HalfEdgeMesh &mesh, const std::vector<Vector3d> &vert)
 {
 	unsigned int i,j,n;
-	int ind1, ind2;
-	std::unordered_set<TriCombineStub, boost::hash<TriCombineStub> > stubs_pos;
-	std::unordered_set<TriCombineStub, boost::hash<TriCombineStub> > stubs_neg;
-
-	TriCombineStub e;
-	for(i=0;i<triangles.size();i++)
-	{
-		n=triangles[i].size();
-		for(j=0;j<n;j++)
-		{
-			ind1=triangles[i][j];
-			ind2=triangles[i][(j+1)%n];
-			if(ind2 > ind1) // positive edge
-			{
-				e.ind1=ind1;
-				e.ind2=ind2;
-				if(stubs_neg.find(e) != stubs_neg.end()) stubs_neg.erase(e);
-				else if(stubs_pos.find(e) != stubs_pos.end()) printf("Duplicate Edge %d->%d \n",ind1,ind2);
-				else stubs_pos.insert(e);
-			}
-			if(ind2 < ind1) // negative edge
-			{
-				e.ind1=ind2;
-				e.ind2=ind1;
-				if(stubs_pos.find(e) != stubs_pos.end() ) stubs_pos.erase(e);
-				else if(stubs_neg.find(e) != stubs_neg.end() ) printf("Duplicate Edge %d->%d \n",ind2,ind1);
-				else stubs_neg.insert(e);
-			}
-		}
-	}	
 
 	// now chain everything
 	std::unordered_map<int,int> stubs_chain;
-	std::vector<TriCombineStub> stubs;
-	std::vector<TriCombineStub> stubs_bak;
-	for( const auto& stubs : stubs_pos ) {
-		if(stubs_chain.count(stubs.ind1) > 0)
+	std::vector<std::pair<int,int>> stubs_bak;
+	for(const int h : mesh.borderHalfEdges()) {
+		const int ind1=mesh.origin(h), ind2=mesh.target(h);
+		if(stubs_chain.count(ind1) > 0)
 		{
-			stubs_bak.push_back(stubs);
-		} else stubs_chain[stubs.ind1]=stubs.ind2;
-	}
-
-	for( const auto& stubs : stubs_neg ) {
-		if(stubs_chain.count(stubs.ind2) > 0)
-		{
-			TriCombineStub ts;
-			ts.ind1=stubs.ind2;
-			ts.ind2=stubs.ind1;
-			stubs_bak.push_back(ts);
-		} else stubs_chain[stubs.ind2]=stubs.ind1;
+			stubs_bak.emplace_back(ind1, ind2);
+		} else stubs_chain[ind1]=ind2;
 	}
 	std::vector<IndexedFace> result;
 
@@ -386,10 +283,10 @@ static indexedFaceList mergeTrianglesSub(const std::vector<IndexedFace> &triangl
 				ind_new=-1;
 				for(i=0;ind_new == -1 && i<stubs_bak.size();i++)
 				{
-					if(stubs_bak[i].ind1 == ind)
+					if(stubs_bak[i].first == ind)
 					{
-						ind_new=stubs_bak[i].ind2;
-						std::vector<TriCombineStub>::iterator it=stubs_bak.begin();
+						ind_new=stubs_bak[i].second;
+						auto it=stubs_bak.begin();
 						std::advance(it,i);
 						stubs_bak.erase(it);
 						break;
@@ -903,26 +800,28 @@ int cut_face_line(Vector3d fp, Vector3d fn, Vector3d lp, Vector3d ld, Vector3d &
 }
 
 
-std::shared_ptr<Geometry> union_geoms(std::vector<std::shared_ptr<PolySet>> parts) // TODO use widely
+// Applies op to all parts in one batch, which lets manifold combine them in a balanced order.
+// Parts which can't be converted count as empty, so a Subtract keeps its first operand in place.
+static std::shared_ptr<Geometry> batch_geoms(const std::vector<std::shared_ptr<PolySet>>& parts, manifold::OpType op)
 {
-  std::shared_ptr<ManifoldGeometry> result = nullptr;
-  for(auto part: parts) {
-    std::shared_ptr<const ManifoldGeometry>part_mani = ManifoldUtils::createManifoldFromGeometry(part);
-    if(result == nullptr) result = std::make_shared<ManifoldGeometry>(*part_mani);
-    else *result = *result + *part_mani;
+  std::vector<manifold::Manifold> manifolds;
+  manifolds.reserve(parts.size());
+  for(const auto& part: parts) {
+    std::shared_ptr<const ManifoldGeometry> part_mani = ManifoldUtils::createManifoldFromGeometry(part);
+    manifolds.push_back(part_mani != nullptr ? part_mani->getManifold() : manifold::Manifold());
   }
-  return result;
+  return std::make_shared<ManifoldGeometry>(manifold::Manifold::BatchBoolean(manifolds, op));
 }
 
+std::shared_ptr<Geometry> union_geoms(std::vector<std::shared_ptr<PolySet>> parts) // TODO use widely
+{
+  return batch_geoms(parts, manifold::OpType::Add);
+}
+
+// Subtracts all other parts from the first one
 std::shared_ptr<Geometry> difference_geoms(std::vector<std::shared_ptr<PolySet>> parts) // TODO use widely
 {
-  std::shared_ptr<ManifoldGeometry> result = nullptr;
-  for(auto part: parts) {
-    std::shared_ptr<const ManifoldGeometry>part_mani = ManifoldUtils::createManifoldFromGeometry(part);
-    if(result == nullptr) result = std::make_shared<ManifoldGeometry>(*part_mani);
-    else *result = *result - *part_mani;
-  }
-  return result;
+  return batch_geoms(parts, manifold::OpType::Subtract);
 }
 
 class Offset3D_CornerContext
@@ -1063,27 +962,30 @@ std::shared_ptr<const Geometry> offset3D(const std::shared_ptr<const PolySet> &p
 
   }
 
- // create edge_db
-  std::unordered_map<EdgeKey, std::vector<Vector3d> ,boost::hash<EdgeKey>> edge_startarc;
-  std::unordered_map<EdgeKey, std::vector<Vector3d> ,boost::hash<EdgeKey>> edge_endarc;
-  auto edge_db =  createEdgeDb(indicesNew);
+ // arcs per edge at its lower to higher index half-edge, empty for edges which are not rounded
+  const HalfEdgeMesh mesh(indicesNew, ps->vertices.size());
+  std::vector<std::vector<Vector3d>> edge_startarc(mesh.numHalfEdges());
+  std::vector<std::vector<Vector3d>> edge_endarc(mesh.numHalfEdges());
   int abs_eff_fn=0;
-  for(auto &e: edge_db) {
-    Vector3d p1=ps->vertices[e.first.ind1];	  
-    Vector3d p2=ps->vertices[e.first.ind2];
+  for(const int h : mesh.edges()) {
+    if(mesh.twin(h) == -1) continue;
+    const int ind1=mesh.origin(h), ind2=mesh.target(h);
+    const int facea=mesh.face(h), faceb=mesh.face(mesh.twin(h));
+    Vector3d p1=ps->vertices[ind1];	  
+    Vector3d p2=ps->vertices[ind2];
     // schauen ob es eine konkave kante ist
 
 
-    Vector3d fan = faceNormals[e.second.facea].head<3>();
-    if(faceParents[e.second.facea] != -1) fan=-fan;
-    Vector3d fbn = faceNormals[e.second.faceb].head<3>();
-    if(faceParents[e.second.faceb] != -1) fbn=-fbn;
+    Vector3d fan = faceNormals[facea].head<3>();
+    if(faceParents[facea] != -1) fan=-fan;
+    Vector3d fbn = faceNormals[faceb].head<3>();
+    if(faceParents[faceb] != -1) fbn=-fbn;
     Vector3d axis=fan.cross(fbn);
     double conv = fan.cross(fbn).dot(p2-p1);
     if(conv*off < 0) continue;
 
-    corner_rounds[e.first.ind1].push_back(e.first.ind2);
-    corner_rounds[e.first.ind2].push_back(e.first.ind1);
+    corner_rounds[ind1].push_back(ind2);
+    corner_rounds[ind2].push_back(ind1);
     double totang=acos(fan.dot(fbn));
     std::vector<Vector3d> startarc, endarc;
     // create arcs for begin and end
@@ -1109,26 +1011,27 @@ std::shared_ptr<const Geometry> offset3D(const std::shared_ptr<const PolySet> &p
     startarc.push_back(p1+off*fbn);
     endarc.push_back(p2+off*fbn);
 
-    edge_startarc[e.first]= startarc;
-    edge_endarc[e.first]= endarc;
+    edge_startarc[h]= startarc;
+    edge_endarc[h]= endarc;
   }
 
-  for(auto &e: edge_db) {
-    if(!edge_startarc.count(e.first)) continue;	  
+  for(const int h : mesh.edges()) {
+    if(edge_startarc[h].empty()) continue;	  
+    const int ind1=mesh.origin(h), ind2=mesh.target(h);
     std::vector<Vector3d>  startarc; 
     std::vector<Vector3d>  endarc; 
     int startpt, endpt;
     PolySetBuilder builder;
     if(off > 0) {
-      startarc = edge_startarc[e.first];
-      endarc = edge_endarc[e.first];
-      startpt  = builder.vertexIndex(ps->vertices[e.first.ind1]);
-      endpt  = builder.vertexIndex(ps->vertices[e.first.ind2]);
+      startarc = edge_startarc[h];
+      endarc = edge_endarc[h];
+      startpt  = builder.vertexIndex(ps->vertices[ind1]);
+      endpt  = builder.vertexIndex(ps->vertices[ind2]);
     } else {
-      startarc = edge_endarc[e.first];
-      endarc = edge_startarc[e.first];
-      endpt  = builder.vertexIndex(ps->vertices[e.first.ind1]);
-      startpt  = builder.vertexIndex(ps->vertices[e.first.ind2]);
+      startarc = edge_endarc[h];
+      endarc = edge_startarc[h];
+      endpt  = builder.vertexIndex(ps->vertices[ind1]);
+      startpt  = builder.vertexIndex(ps->vertices[ind2]);
     }
     std::vector<int> start_inds, end_inds;
 
@@ -1175,11 +1078,11 @@ std::shared_ptr<const Geometry> offset3D(const std::shared_ptr<const PolySet> &p
     if(corner_rounds[i].size() < 3) continue;
     std::vector<IndexedFace> stubs;
     for(auto oth: corner_rounds[i]) {
-      EdgeKey key(i, oth);		
-      if(!edge_startarc.count(key)) continue;	  
+      const int h = mesh.find(std::min(i, oth), std::max(i, oth));
+      if(h == -1 || edge_startarc[h].empty()) continue;	  
       std::vector<Vector3d> arc;
-      if(i < oth) arc=edge_startarc[key]; else {
-        arc=edge_endarc[key];
+      if(i < oth) arc=edge_startarc[h]; else {
+        arc=edge_endarc[h];
         std::reverse(arc.begin(), arc.end());
       }
       IndexedFace stub;
@@ -1425,7 +1328,12 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
     }
     if (actualchildren.empty()) return {};
     if (actualchildren.size() == 1) return ResultObject::constResult(actualchildren.front().second);
-    return ResultObject::constResult(applyMinkowski(actualchildren));
+    std::vector<std::string> childIds;
+    childIds.reserve(actualchildren.size());
+    for (const auto& item : actualchildren) {
+      childIds.push_back(item.first ? this->tree.getIdString(*item.first) : std::string());
+    }
+    return ResultObject::constResult(applyMinkowski(actualchildren, childIds));
     break;
   }
   case OpenSCADOperator::UNION:
@@ -1487,7 +1395,15 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
  
     std::shared_ptr<const PolySet> ps= PolySetUtils::getGeometryAsPolySet(geom);
     if(ps != nullptr) {
-      auto ps_offset =  offset3D(ps,offNode->delta, offNode->fn, offNode->fa, offNode->fs);
+      std::shared_ptr<const Geometry> ps_offset;
+      if(offNode->method == "levelset" && offNode->delta != 0) {
+#ifdef ENABLE_MANIFOLD
+        ps_offset = ManifoldUtils::createOffsetLevelSet(ps, offNode->delta, offNode->resolution);
+#else
+        LOG(message_group::Warning, "offset method \"levelset\" requires a build with manifold support, using \"prisms\"");
+#endif
+      }
+      if(ps_offset == nullptr) ps_offset = offset3D(ps,offNode->delta, offNode->fn, offNode->fa, offNode->fs);
 
       geom = std::move(ps_offset);
       return ResultObject::mutableResult(geom);
@@ -1690,10 +1606,12 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
                                          const std::shared_ptr<const Geometry>& geom)
 {
   const std::string& key = this->tree.getIdString(node);
+  const auto time = this->compute_time.find(node.index());
+  const auto computeTime = time != this->compute_time.end() ? time->second : std::chrono::duration<double>::zero();
 
   if (CGALCache::acceptsGeometry(geom)) {
     if (!CGALCache::instance()->contains(key)) {
-      CGALCache::instance()->insert(key, geom);
+      CGALCache::instance()->insert(key, geom, computeTime);
     }
   } else if (!GeometryCache::instance()->contains(key)) {
     // FIXME: Sanity-check Polygon2d as well?
@@ -1702,7 +1620,9 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
     // }
 
     // Perhaps add acceptsGeometry() to GeometryCache as well?
-    if (!GeometryCache::instance()->insert(key, geom)) {
+    // Cheaper entries are rejected silently when the cache is full of more expensive ones
+    if (!GeometryCache::instance()->insert(key, geom, computeTime) &&
+        geom && geom->memsize() > GeometryCache::instance()->maxSizeMB() * 1024ul * 1024ul) {
       LOG(message_group::Warning, "GeometryEvaluator: Node didn't fit into cache.");
     }
   }
@@ -1840,6 +1760,10 @@ void GeometryEvaluator::addToParent(const State& state,
                                     const AbstractNode& node,
                                     const std::shared_ptr<const Geometry>& geom)
 {
+  if (geom && Profiler::instance()->isEnabled()) {
+    // Counting facets evaluates lazy results, so their cost is attributed to this node
+    Profiler::instance()->addOutput(geom->numFacets(), geom->memsize());
+  }
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
     this->visitedchildren[state.parent()->index()].push_back(std::make_pair(node.shared_from_this(), geom));
@@ -1850,6 +1774,26 @@ void GeometryEvaluator::addToParent(const State& state,
   }
 }
 
+void GeometryEvaluator::enterNode(const AbstractNode& node)
+{
+  this->node_start[node.index()] = std::chrono::steady_clock::now();
+  auto profiler = Profiler::instance();
+  if (!profiler->isEnabled()) return;
+  const bool named = node.modinst && !node.modinst->name().empty();
+  profiler->begin("geometry", named ? node.modinst->name() : node.name(), node.modinst ? node.modinst->location() : Location::NONE);
+  profiler->setCacheHit(isSmartCached(node));
+}
+
+void GeometryEvaluator::leaveNode(const AbstractNode& node)
+{
+  const auto start = this->node_start.find(node.index());
+  if (start != this->node_start.end()) {
+    this->compute_time[node.index()] = std::chrono::steady_clock::now() - start->second;
+    this->node_start.erase(start);
+  }
+  if (Profiler::instance()->isEnabled()) Profiler::instance()->end();
+}
+
 Response GeometryEvaluator::visit(State& state, const ColorNode& node)
 {
   if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
@@ -3122,7 +3066,7 @@ Response GeometryEvaluator::visit(State& state, const DebugNode& node)
 }
 
 
-static std::unique_ptr<PolySet> repairObject(const RepairNode& node, const PolySet *ps)
+static std::unique_ptr<PolySet> repairObject(const RepairNode& node, const std::shared_ptr<const PolySet>& ps)
 {
   auto psx  = std::make_unique<PolySet>(ps->getDimension(), ps->convexValue());	  
   *psx = *ps;
@@ -3138,7 +3082,7 @@ static std::unique_ptr<PolySet> repairObject(const RepairNode& node, const PolyS
     }
   }
 
-  indexedFaceList defects = mergeTrianglesSub(ps->indices, ps->vertices);
+  indexedFaceList defects = mergeTrianglesSub(*HalfEdgeMesh::get(ps), ps->vertices);
   for(int i=0;i<defects.size();i++) {
     auto face = defects[i];
     auto fence = defects[i];
@@ -3200,7 +3144,7 @@ Response GeometryEvaluator::visit(State& state, const RepairNode& node)
       ps=mani->toPolySet();
     else ps = std::dynamic_pointer_cast<const PolySet>(geom);
     if(ps != nullptr) {
-      std::unique_ptr<Geometry> ps_pulled =  repairObject(node,ps.get());
+      std::unique_ptr<Geometry> ps_pulled =  repairObject(node,ps);
       newgeom = std::move(ps_pulled);
       addToParent(state, node, newgeom);
       node.progress_report();
@@ -6,10 +6,12 @@
 #include "geometry/Geometry.h"
 
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include "GeometryUtils.h"
 #include <boost/functional/hash.hpp>
 
@@ -83,7 +85,6 @@ Vector4d calcTriangleNormal(const std::vector<Vector3d> &vertices,const IndexedF
 std::vector<Vector4d> calcTriangleNormals(const std::vector<Vector3d> &vertices, const std::vector<IndexedFace> &indices);
 std::vector<IndexedFace> mergeTriangles(const std::vector<IndexedFace> polygons,const std::vector<Vector4d> normals,std::vector<Vector4d> &newNormals, std::vector<int> &faceParents, const std::vector<Vector3d> &vert);
 std::vector<IndexedColorFace> mergeTriangles(const std::vector<IndexedColorFace> polygons,const std::vector<Vector4d> normals,std::vector<Vector4d> &newNormals, std::vector<int> &faceParents, const std::vector<Vector3d> &vert);
-std::unordered_map<EdgeKey, EdgeVal, boost::hash<EdgeKey> > createEdgeDb(const std::vector<IndexedFace> &indices);
 
 VectorOfVector2d alterprofile(VectorOfVector2d vertices,double scalex, double scaley, double origin_x, double origin_y,double offset_x, double offset_y, double rot);
 // This evaluates a node tree into concrete geometry usign an underlying geometry engine
@@ -126,6 +127,10 @@ public:
 
   [[nodiscard]] const Tree& getTree() const { return this->tree; }
 
+protected:
+  void enterNode(const AbstractNode& node) override;
+  void leaveNode(const AbstractNode& node) override;
+
 private:
   class ResultObject
   {
@@ -182,6 +187,9 @@ private:
   Response lazyEvaluateRootNode(State& state, const AbstractNode& node);
 
   std::map<int, Geometry::Geometries> visitedchildren;
+  // Evaluation time of each node including its children, used to rate cache entries
+  std::unordered_map<int, std::chrono::steady_clock::time_point> node_start;
+  std::unordered_map<int, std::chrono::duration<double>> compute_time;
   const Tree& tree;
   std::shared_ptr<const Geometry> root;
 
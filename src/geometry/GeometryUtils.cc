@@ -525,7 +525,7 @@ std::shared_ptr<const Geometry> GeometryUtils::getBackendSpecificGeometry(const
 #if ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
     if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
-      std::shared_ptr<ManifoldGeometry> mani = ManifoldUtils::createManifoldFromPolySet(*ps);
+      std::shared_ptr<const ManifoldGeometry> mani = ManifoldUtils::createManifoldFromGeometry(ps);
       if (mani == nullptr) {
          mani = std::make_shared<ManifoldGeometry>();
       }
@@ -0,0 +1,106 @@
+#include "geometry/HalfEdgeMesh.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "geometry/ConversionCache.h"
+#include "geometry/GeometryUtils.h"
+#include "geometry/PolygonIndexBuffer.h"
+#include "geometry/PolySet.h"
+#include "utils/parallel.h"
+
+HalfEdgeMesh::HalfEdgeMesh(const PolygonIndices& indices, size_t num_vertices)
+  : HalfEdgeMesh(PolygonIndexBuffer(indices), num_vertices)
+{
+}
+
+HalfEdgeMesh::HalfEdgeMesh(PolygonIndexBuffer indices, size_t num_vertices) : polygons(std::move(indices))
+{
+  const size_t num_faces = polygons.size();
+  const size_t num_half_edges = numHalfEdges();
+
+  faces.resize(num_half_edges);
+  twins.assign(num_half_edges, -1);
+  // Sort key of each half-edge: the vertex pair, lower index first
+  std::vector<std::pair<uint64_t, int>> keys(num_half_edges);
+  parallelizable_for(0, num_faces, [&](size_t f) {
+    const auto poly = polygons[f];
+    const size_t n = poly.size();
+    for (size_t j = 0; j < n; j++) {
+      const int h = faceStart(static_cast<int>(f)) + static_cast<int>(j);
+      const auto a = static_cast<uint32_t>(poly[j]);
+      const auto b = static_cast<uint32_t>(poly[(j + 1) % n]);
+      faces[h] = static_cast<int>(f);
+      keys[h] = {static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b), h};
+    }
+  });
+  std::sort(keys.begin(), keys.end());
+
+  // Pair opposite half-edges within each vertex pair, in face order
+  std::vector<int> forward, backward;
+  for (size_t begin = 0; begin < keys.size();) {
+    size_t end = begin + 1;
+    while (end < keys.size() && keys[end].first == keys[begin].first) end++;
+    forward.clear();
+    backward.clear();
+    for (size_t i = begin; i < end; i++) {
+      const int h = keys[i].second;
+      if (origin(h) < target(h)) forward.push_back(h);
+      else backward.push_back(h);
+    }
+    const size_t paired = std::min(forward.size(), backward.size());
+    for (size_t i = 0; i < paired; i++) {
+      twins[forward[i]] = backward[i];
+      twins[backward[i]] = forward[i];
+    }
+    for (const int h : forward) edge_list.push_back(h);
+    for (size_t i = paired; i < backward.size(); i++) edge_list.push_back(backward[i]);
+    begin = end;
+  }
+
+  // Outgoing half-edges per vertex, as offsets into one array
+  vertex_start.assign(num_vertices + 1, 0);
+  const auto& origins = polygons.data();
+  for (const int v : origins) vertex_start[v + 1]++;
+  for (size_t v = 0; v < num_vertices; v++) vertex_start[v + 1] += vertex_start[v];
+  outgoing_edges.resize(num_half_edges);
+  std::vector<int> fill(vertex_start.begin(), vertex_start.end() - 1);
+  for (size_t h = 0; h < num_half_edges; h++) outgoing_edges[fill[origins[h]]++] = static_cast<int>(h);
+}
+
+std::shared_ptr<const HalfEdgeMesh> HalfEdgeMesh::get(const std::shared_ptr<const PolySet>& ps)
+{
+  static ConversionCache<PolySet, HalfEdgeMesh> instances;
+  if (auto mesh = instances.get(ps)) return mesh;
+  auto mesh = std::make_shared<const HalfEdgeMesh>(ps->indices, ps->vertices.size());
+  instances.insert(ps, 0, mesh, mesh->memsize());
+  return mesh;
+}
+
+size_t HalfEdgeMesh::memsize() const
+{
+  return polygons.memsize() + sizeof(HalfEdgeMesh) +
+         (faces.capacity() + twins.capacity() + vertex_start.capacity() +
+          outgoing_edges.capacity() + edge_list.capacity()) * sizeof(int);
+}
+
+int HalfEdgeMesh::find(int from, int to) const
+{
+  for (const int h : outgoing(from)) {
+    if (target(h) == to) return h;
+  }
+  return -1;
+}
+
+std::vector<int> HalfEdgeMesh::borderHalfEdges() const
+{
+  std::vector<int> result;
+  for (size_t h = 0; h < twins.size(); h++) {
+    if (twins[h] == -1) result.push_back(static_cast<int>(h));
+  }
+  return result;
+}
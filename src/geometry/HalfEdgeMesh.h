@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry/GeometryUtils.h"
+#include "geometry/PolygonIndexBuffer.h"
+#include "geometry/PolySet.h"
+
+/*
+ * Array based half-edge topology of a polygon mesh.
+ *
+ * Half-edges are numbered in face order, so half-edge h of a face with
+ * first half-edge s is the edge from vertex position h - s to the following
+ * one. The faces are kept as a PolygonIndexBuffer, whose flat index array
+ * doubles as the origin of each half-edge; only the opposite half-edges and
+ * the per-vertex lists of outgoing half-edges are stored in addition.
+ * Opposite half-edges are paired per vertex pair, non-manifold surplus
+ * half-edges stay unpaired like border edges.
+ *
+ * The topology only depends on the face indices; operators which change
+ * faces build a new instance. Use get() to share the topology of a PolySet.
+ */
+class HalfEdgeMesh
+{
+public:
+  HalfEdgeMesh(const PolygonIndices& indices, size_t num_vertices);
+  HalfEdgeMesh(PolygonIndexBuffer indices, size_t num_vertices);
+
+  // Returns the topology of ps, reusing one built recently for the same PolySet
+  static std::shared_ptr<const HalfEdgeMesh> get(const std::shared_ptr<const PolySet>& ps);
+
+  class Range
+  {
+public:
+    Range(const int *begin, const int *end) : begin_(begin), end_(end) {}
+    [[nodiscard]] const int *begin() const { return begin_; }
+    [[nodiscard]] const int *end() const { return end_; }
+    [[nodiscard]] size_t size() const { return end_ - begin_; }
+    int operator[](size_t i) const { return begin_[i]; }
+private:
+    const int *begin_, *end_;
+  };
+
+  [[nodiscard]] size_t numFaces() const { return polygons.size(); }
+  [[nodiscard]] size_t numHalfEdges() const { return polygons.data().size(); }
+  [[nodiscard]] size_t numVertices() const { return vertex_start.size() - 1; }
+  [[nodiscard]] const PolygonIndexBuffer& polygonIndices() const { return polygons; }
+  [[nodiscard]] size_t memsize() const;
+
+  [[nodiscard]] int halfEdge(int face, int pos) const { return faceStart(face) + pos; }
+  [[nodiscard]] int face(int h) const { return faces[h]; }
+  // Index of origin(h) within its face
+  [[nodiscard]] int position(int h) const { return h - faceStart(faces[h]); }
+  [[nodiscard]] int origin(int h) const { return polygons.data()[h]; }
+  [[nodiscard]] int target(int h) const { return origin(next(h)); }
+  [[nodiscard]] int next(int h) const { return h + 1 < faceStart(faces[h] + 1) ? h + 1 : faceStart(faces[h]); }
+  [[nodiscard]] int prev(int h) const { return h > faceStart(faces[h]) ? h - 1 : faceStart(faces[h] + 1) - 1; }
+  // Opposite half-edge in the neighboring face, -1 on borders
+  [[nodiscard]] int twin(int h) const { return twins[h]; }
+  // Half-edge from vertex from to vertex to, -1 if there is none
+  [[nodiscard]] int find(int from, int to) const;
+
+  // Half-edges starting at vertex v, ordered by face
+  [[nodiscard]] Range outgoing(int v) const {
+    return {outgoing_edges.data() + vertex_start[v], outgoing_edges.data() + vertex_start[v + 1]};
+  }
+  // One half-edge per edge: the one from the lower to the higher vertex index if both exist
+  [[nodiscard]] const std::vector<int>& edges() const { return edge_list; }
+  // Half-edges without twin, i.e. the border of the mesh
+  [[nodiscard]] std::vector<int> borderHalfEdges() const;
+
+private:
+  [[nodiscard]] int faceStart(int face) const { return static_cast<int>(polygons.faceStart(face)); }
+
+  PolygonIndexBuffer polygons;
+  std::vector<int> faces;
+  std::vector<int> twins;
+  std::vector<int> vertex_start;
+  std::vector<int> outgoing_edges;
+  std::vector<int> edge_list;
+};
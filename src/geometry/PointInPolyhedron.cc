@@ -0,0 +1,153 @@
+#include "geometry/PointInPolyhedron.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+
+PointInPolyhedron::PointInPolyhedron(const PolySet& inps)
+{
+  const bool triangular = std::all_of(inps.indices.begin(), inps.indices.end(),
+                                      [](const IndexedFace& f) { return f.size() == 3; });
+  std::unique_ptr<PolySet> tessellated;
+  if (!triangular) tessellated = PolySetUtils::tessellate_faces(inps);
+  const PolySet& ps = tessellated ? *tessellated : inps;
+  this->vertices = ps.vertices;
+  this->triangles.reserve(ps.indices.size());
+  for (const auto& f : ps.indices) this->triangles.emplace_back(f[0], f[1], f[2]);
+
+  const auto& faces = this->triangles;
+  if (faces.empty()) return;
+
+  double min_y = vertices[faces[0][0]][1], max_y = min_y;
+  double min_z = vertices[faces[0][0]][2], max_z = min_z;
+  for (const auto& f : faces) {
+    for (const auto ind : f) {
+      min_y = std::min(min_y, vertices[ind][1]);
+      max_y = std::max(max_y, vertices[ind][1]);
+      min_z = std::min(min_z, vertices[ind][2]);
+      max_z = std::max(max_z, vertices[ind][2]);
+    }
+  }
+  // About one face per cell
+  const double width = std::max(max_y - min_y, 1e-9);
+  const double height = std::max(max_z - min_z, 1e-9);
+  this->cell_size = std::sqrt(width * height / faces.size());
+  this->cell_size = std::max({this->cell_size, width / faces.size(), height / faces.size()});
+  this->origin_y = min_y;
+  this->origin_z = min_z;
+  this->cols = static_cast<size_t>(width / this->cell_size) + 1;
+  this->rows = static_cast<size_t>(height / this->cell_size) + 1;
+
+  // Bin faces by their y/z bounds, grown by the tolerance of the crossing test
+  std::vector<size_t> col_range(2 * faces.size()), row_range(2 * faces.size());
+  this->face_min_x.resize(faces.size());
+  this->cell_start.assign(this->cols * this->rows + 1, 0);
+  for (size_t i = 0; i < faces.size(); i++) {
+    const Vector3d& a = vertices[faces[i][0]];
+    const Vector3d& b = vertices[faces[i][1]];
+    const Vector3d& c = vertices[faces[i][2]];
+    const double lo_y = std::min({a[1], b[1], c[1]}), hi_y = std::max({a[1], b[1], c[1]});
+    const double lo_z = std::min({a[2], b[2], c[2]}), hi_z = std::max({a[2], b[2], c[2]});
+    const double eps = 1e-6 * std::max(hi_y - lo_y, hi_z - lo_z);
+    this->face_min_x[i] = std::min({a[0], b[0], c[0]});
+    const size_t c0 = cell(lo_y - eps, lo_z - eps), c1 = cell(hi_y + eps, hi_z + eps);
+    col_range[2 * i] = c0 % this->cols;
+    col_range[2 * i + 1] = c1 % this->cols;
+    row_range[2 * i] = c0 / this->cols;
+    row_range[2 * i + 1] = c1 / this->cols;
+    for (size_t r = row_range[2 * i]; r <= row_range[2 * i + 1]; r++) {
+      for (size_t col = col_range[2 * i]; col <= col_range[2 * i + 1]; col++) this->cell_start[r * this->cols + col + 1]++;
+    }
+  }
+  for (size_t i = 1; i < this->cell_start.size(); i++) this->cell_start[i] += this->cell_start[i - 1];
+  this->cell_faces.resize(this->cell_start.back());
+  std::vector<size_t> fill(this->cell_start.begin(), this->cell_start.end() - 1);
+  for (size_t i = 0; i < faces.size(); i++) {
+    for (size_t r = row_range[2 * i]; r <= row_range[2 * i + 1]; r++) {
+      for (size_t col = col_range[2 * i]; col <= col_range[2 * i + 1]; col++) this->cell_faces[fill[r * this->cols + col]++] = i;
+    }
+  }
+}
+
+std::shared_ptr<const PointInPolyhedron> PointInPolyhedron::get(const std::shared_ptr<const PolySet>& ps)
+{
+  static std::mutex mutex;
+  static std::map<const PolySet *, std::pair<std::weak_ptr<const PolySet>, std::shared_ptr<const PointInPolyhedron>>> instances;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = instances.begin(); it != instances.end();) {
+    if (it->second.first.expired()) it = instances.erase(it);
+    else ++it;
+  }
+  auto& entry = instances[ps.get()];
+  if (!entry.second) entry = {ps, std::make_shared<const PointInPolyhedron>(*ps)};
+  return entry.second;
+}
+
+size_t PointInPolyhedron::cell(double y, double z) const
+{
+  const auto col = static_cast<size_t>(std::clamp((y - this->origin_y) / this->cell_size, 0.0, double(this->cols - 1)));
+  const auto row = static_cast<size_t>(std::clamp((z - this->origin_z) / this->cell_size, 0.0, double(this->rows - 1)));
+  return row * this->cols + col;
+}
+
+bool PointInPolyhedron::contains(const Vector3d& pt) const
+{
+  if (this->cell_faces.empty()) return false;
+  const double y = (pt[1] - this->origin_y) / this->cell_size;
+  const double z = (pt[2] - this->origin_z) / this->cell_size;
+  if (y < 0 || z < 0 || y > double(this->cols) || z > double(this->rows)) return false;
+
+  // polygons are clockwise
+  const size_t c = cell(pt[1], pt[2]);
+  int cuts = 0;
+  bool grazing = false;
+  const Vector3d vc(1, 0, 0);
+  Vector3d res;
+  for (size_t i = this->cell_start[c]; i < this->cell_start[c + 1]; i++) {
+    const size_t face = this->cell_faces[i];
+    if (this->face_min_x[face] > pt[0] + 1e-6) continue;
+    const IndexedTriangle& f = this->triangles[face];
+    const Vector3d va = vertices[f[1]] - vertices[f[0]];
+    const Vector3d vb = vertices[f[2]] - vertices[f[0]];
+    if (linsystem(va, vb, vc, pt - vertices[f[0]], res, nullptr)) continue;
+    if (res[2] < 0) continue;
+    if (res[0] >= -1e-6 && res[1] > -1e-6 && res[0] + res[1] < 1 + 1e-6) {
+      if (res[0] > 0 && res[1] > 0 && res[0] + res[1] < 1) cuts += 2;
+      if (fabs(res[0]) < 1e-6) grazing = true;
+      if (fabs(res[1]) < 1e-6) grazing = true;
+      if (fabs(res[0] + res[1] - 1) < 1e-6) grazing = true;
+    }
+    if (grazing) break;
+  }
+  if (grazing) return fabs(windingNumber(pt)) > 0.5;
+  return (cuts / 2) & 1;
+}
+
+/*!
+   Sum of the solid angles of all faces as seen from pt, in full turns:
+   about +-1 inside a closed mesh and 0 outside.
+ */
+double PointInPolyhedron::windingNumber(const Vector3d& pt) const
+{
+  double sum = 0;
+  for (const auto& f : this->triangles) {
+    const Vector3d a = vertices[f[0]] - pt;
+    const Vector3d b = vertices[f[1]] - pt;
+    const Vector3d c = vertices[f[2]] - pt;
+    const double la = a.norm(), lb = b.norm(), lc = c.norm();
+    const double det = a.dot(b.cross(c));
+    const double div = la * lb * lc + a.dot(b) * lc + a.dot(c) * lb + b.dot(c) * la;
+    sum += 2 * atan2(det, div);
+  }
+  return sum / (4 * M_PI);
+}
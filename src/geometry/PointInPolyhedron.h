@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+/*
+ * Inside/outside test against a closed PolySet.
+ *
+ * Points are classified by counting the faces crossed by a ray along -x.
+ * Faces are binned into a uniform grid over the y/z plane, so a query only
+ * tests the faces of the grid column the ray runs through. If the ray
+ * grazes an edge or a vertex, the generalized winding number over all faces
+ * decides instead.
+ *
+ * Building the grid is linear in the number of faces; use get() to share
+ * one instance between all users of the same PolySet.
+ */
+class PointInPolyhedron
+{
+public:
+  PointInPolyhedron(const PolySet& ps);
+
+  // Returns the instance for ps, reusing the one built earlier if ps is still alive
+  static std::shared_ptr<const PointInPolyhedron> get(const std::shared_ptr<const PolySet>& ps);
+
+  [[nodiscard]] bool contains(const Vector3d& pt) const;
+
+private:
+  [[nodiscard]] size_t cell(double y, double z) const;
+  [[nodiscard]] double windingNumber(const Vector3d& pt) const;
+
+  // Own copy of the triangulated mesh, so instances kept by get() don't keep the PolySet alive
+  std::vector<Vector3d> vertices;
+  std::vector<IndexedTriangle> triangles;
+  double origin_y{0.0}, origin_z{0.0};
+  double cell_size{1.0};
+  size_t cols{1}, rows{1};
+  std::vector<size_t> cell_start; // faces of cell i are cell_faces[cell_start[i], cell_start[i + 1])
+  std::vector<size_t> cell_faces;
+  std::vector<double> face_min_x;
+};
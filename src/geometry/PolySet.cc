@@ -91,9 +91,13 @@ BoundingBox PolySet::getBoundingBox() const
 
 size_t PolySet::memsize() const
 {
-  size_t mem = 0;
-  for (const auto& p : this->indices) mem += p.size() * sizeof(int);
-  for (const auto& p : this->vertices) mem += p.size() * sizeof(Vector3d);
+  size_t mem = this->indices.capacity() * sizeof(IndexedFace);
+  // Faces with more indices than fit inline are allocated separately
+  for (const auto& p : this->indices) {
+    if (p.capacity() > p.static_capacity) mem += p.capacity() * sizeof(int);
+  }
+  mem += this->vertices.capacity() * sizeof(Vector3d);
+  mem += this->color_indices.capacity() * sizeof(int32_t) + this->colors.capacity() * sizeof(Color4f);
   mem += sizeof(PolySet);
   return mem;
 }
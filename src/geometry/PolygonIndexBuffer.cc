@@ -0,0 +1,34 @@
+#include "geometry/PolygonIndexBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "geometry/GeometryUtils.h"
+
+PolygonIndexBuffer::PolygonIndexBuffer(const PolygonIndices& polygons)
+{
+  size_t total = 0;
+  for (const auto& polygon : polygons) total += polygon.size();
+  reserve(polygons.size(), total);
+  for (const auto& polygon : polygons) push_back(polygon);
+}
+
+void PolygonIndexBuffer::reserve(size_t faces, size_t total_indices)
+{
+  indices.reserve(total_indices);
+  if (!offsets.empty() || total_indices != 3 * faces) offsets.reserve(faces + 1);
+}
+
+PolygonIndices PolygonIndexBuffer::toPolygonIndices() const
+{
+  PolygonIndices polygons;
+  polygons.reserve(num_faces);
+  for (const auto& face : *this) polygons.emplace_back(face.begin(), face.end());
+  return polygons;
+}
+
+size_t PolygonIndexBuffer::memsize() const
+{
+  return sizeof(*this) + indices.capacity() * sizeof(int) + offsets.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+#include "geometry/GeometryUtils.h"
+
+/*
+ * Read-mostly face indices of a polygon mesh in compressed sparse row
+ * form: the indices of all faces in one array, and the start of each face
+ * within it. While all faces are triangles no offsets are stored at all,
+ * so a triangle mesh takes 12 bytes per face instead of the 40 of an
+ * IndexedFace.
+ *
+ * Faces can only be appended. Iterating yields a read-only range of
+ * indices per face, so read-only loops written for PolygonIndices work
+ * unchanged. Used for the faces of HalfEdgeMesh; PolySet still stores
+ * PolygonIndices, as many algorithms edit its faces in place.
+ */
+class PolygonIndexBuffer
+{
+public:
+  class Face
+  {
+public:
+    Face(const int *begin, const int *end) : begin_(begin), end_(end) {}
+    [[nodiscard]] const int *begin() const { return begin_; }
+    [[nodiscard]] const int *end() const { return end_; }
+    [[nodiscard]] size_t size() const { return end_ - begin_; }
+    [[nodiscard]] bool empty() const { return begin_ == end_; }
+    int operator[](size_t i) const { return begin_[i]; }
+    [[nodiscard]] int front() const { return *begin_; }
+    [[nodiscard]] int back() const { return *(end_ - 1); }
+private:
+    const int *begin_, *end_;
+  };
+
+  class const_iterator
+  {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Face;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Face;
+
+    const_iterator(const PolygonIndexBuffer *buffer, size_t face) : buffer(buffer), face(face) {}
+    Face operator*() const { return (*buffer)[face]; }
+    const_iterator& operator++() { ++face; return *this; }
+    const_iterator operator++(int) { auto it = *this; ++face; return it; }
+    bool operator==(const const_iterator& other) const { return face == other.face; }
+    bool operator!=(const const_iterator& other) const { return face != other.face; }
+private:
+    const PolygonIndexBuffer *buffer;
+    size_t face;
+  };
+
+  PolygonIndexBuffer() = default;
+  explicit PolygonIndexBuffer(const PolygonIndices& polygons);
+
+  [[nodiscard]] size_t size() const { return num_faces; }
+  [[nodiscard]] bool empty() const { return num_faces == 0; }
+  [[nodiscard]] bool isTriangular() const { return offsets.empty(); }
+
+  // Position of the first index of face i in data(); faceStart(size()) is the total
+  [[nodiscard]] size_t faceStart(size_t i) const { return offsets.empty() ? 3 * i : offsets[i]; }
+  Face operator[](size_t i) const {
+    return {indices.data() + faceStart(i), indices.data() + faceStart(i + 1)};
+  }
+  [[nodiscard]] const_iterator begin() const { return {this, 0}; }
+  [[nodiscard]] const_iterator end() const { return {this, num_faces}; }
+
+  // Indices of all faces, back to back
+  [[nodiscard]] const std::vector<int>& data() const { return indices; }
+
+  void reserve(size_t faces, size_t total_indices);
+  template <class Container>
+  void push_back(const Container& face) { append(std::begin(face), std::end(face)); }
+  void push_back(std::initializer_list<int> face) { append(face.begin(), face.end()); }
+
+  [[nodiscard]] PolygonIndices toPolygonIndices() const;
+  [[nodiscard]] size_t memsize() const;
+
+private:
+  template <class Iterator>
+  void append(Iterator begin, Iterator end) {
+    indices.insert(indices.end(), begin, end);
+    const size_t face_size = indices.size() - faceStart(num_faces);
+    if (face_size != 3 && offsets.empty()) {
+      // First non-triangle, from now on offsets are needed
+      offsets.reserve(indices.capacity() / 3 + 1);
+      for (size_t i = 0; i <= num_faces; i++) offsets.push_back(static_cast<uint32_t>(3 * i));
+    }
+    ++num_faces;
+    if (!offsets.empty()) offsets.push_back(static_cast<uint32_t>(indices.size()));
+  }
+
+  std::vector<int> indices;
+  std::vector<uint32_t> offsets; // num_faces + 1 entries unless all faces are triangles
+  size_t num_faces{0};
+};
@@ -0,0 +1,338 @@
+#include "geometry/QuickHull.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+#include "utils/parallel.h"
+#include "utils/printutils.h"
+
+namespace {
+
+// Below this number of points, the interior filter and parallel loops don't pay off
+constexpr size_t parallelThreshold = 4096;
+
+// Directions in which the interior filter looks for extreme points
+const std::array<Vector3d, 14> filterDirections = {
+  Vector3d(1, 0, 0), Vector3d(-1, 0, 0), Vector3d(0, 1, 0), Vector3d(0, -1, 0), Vector3d(0, 0, 1), Vector3d(0, 0, -1),
+  Vector3d(1, 1, 1), Vector3d(-1, -1, -1), Vector3d(1, 1, -1), Vector3d(-1, -1, 1),
+  Vector3d(1, -1, 1), Vector3d(-1, 1, -1), Vector3d(-1, 1, 1), Vector3d(1, -1, -1),
+};
+
+} // namespace
+
+QuickHull::QuickHull(const std::vector<Vector3d>& points) : points(points)
+{
+  Vector3d max_abs = Vector3d::Zero();
+  for (const auto& p : points) max_abs = max_abs.cwiseMax(p.cwiseAbs());
+  // Rounding error of a plane distance, with some margin for the plane itself
+  epsilon = 8 * std::numeric_limits<double>::epsilon() * max_abs.sum();
+  valid = build();
+}
+
+std::unique_ptr<PolySet> QuickHull::hull(const std::vector<Vector3d>& points)
+{
+  if (points.size() < 4) return nullptr;
+  if (points.size() < parallelThreshold) {
+    const QuickHull qh(points);
+    return qh.isValid() ? qh.toPolySet() : nullptr;
+  }
+
+  // Drop the points strictly inside the hull of the extremes
+  std::vector<Vector3d> extremes(filterDirections.size());
+  parallelizable_for(0, filterDirections.size(), [&](size_t i) {
+    const auto& dir = filterDirections[i];
+    extremes[i] = *std::max_element(points.begin(), points.end(), [&](const Vector3d& a, const Vector3d& b) {
+      return dir.dot(a) < dir.dot(b);
+    });
+  });
+  const QuickHull filter(extremes);
+  if (!filter.isValid()) {
+    const QuickHull qh(points);
+    return qh.isValid() ? qh.toPolySet() : nullptr;
+  }
+  std::vector<const Face *> filter_faces;
+  for (const auto& face : filter.faces) {
+    if (!face.deleted) filter_faces.push_back(&face);
+  }
+  std::vector<char> keep(points.size());
+  parallelizable_for(0, points.size(), [&](size_t i) {
+    keep[i] = std::any_of(filter_faces.begin(), filter_faces.end(), [&](const Face *face) {
+      return face->distance(points[i]) >= -filter.epsilon;
+    });
+  });
+  std::vector<Vector3d> candidates;
+  for (size_t i = 0; i < points.size(); i++) {
+    if (keep[i]) candidates.push_back(points[i]);
+  }
+  PRINTDB("QuickHull: %d of %d points outside the interior filter", candidates.size() % points.size());
+
+  const QuickHull qh(candidates);
+  return qh.isValid() ? qh.toPolySet() : nullptr;
+}
+
+bool QuickHull::build()
+{
+  if (points.size() < 4 || !createSimplex()) return false;
+
+  while (!pending.empty()) {
+    const int f = pending.back();
+    pending.pop_back();
+    if (faces[f].deleted || faces[f].outside.empty()) continue;
+    while (!addPoint(f)) {
+      // The furthest point gave an inconsistent horizon, it is on the hull within tolerance
+      auto& face = faces[f];
+      face.outside.erase(std::find(face.outside.begin(), face.outside.end(), face.furthest));
+      face.furthest = -1;
+      face.furthest_distance = 0.0;
+      for (const int p : face.outside) {
+        const double dist = face.distance(points[p]);
+        if (dist > face.furthest_distance) {
+          face.furthest = p;
+          face.furthest_distance = dist;
+        }
+      }
+      if (face.outside.empty()) break;
+    }
+  }
+  return true;
+}
+
+bool QuickHull::createSimplex()
+{
+  // The two furthest apart of the extremes along the axes
+  std::array<int, 6> extremes{};
+  for (size_t i = 0; i < points.size(); i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      if (points[i][axis] < points[extremes[2 * axis]][axis]) extremes[2 * axis] = static_cast<int>(i);
+      if (points[i][axis] > points[extremes[2 * axis + 1]][axis]) extremes[2 * axis + 1] = static_cast<int>(i);
+    }
+  }
+  int a = 0, b = 0;
+  double max_dist = 0.0;
+  for (const int i : extremes) {
+    for (const int j : extremes) {
+      const double dist = (points[i] - points[j]).squaredNorm();
+      if (dist > max_dist) {
+        max_dist = dist;
+        a = i;
+        b = j;
+      }
+    }
+  }
+  if (std::sqrt(max_dist) <= epsilon) return false;
+
+  // The point furthest from the line through a and b
+  const Vector3d dir = (points[b] - points[a]).normalized();
+  int c = -1;
+  max_dist = epsilon;
+  for (size_t i = 0; i < points.size(); i++) {
+    const double dist = (points[i] - points[a]).cross(dir).norm();
+    if (dist > max_dist) {
+      max_dist = dist;
+      c = static_cast<int>(i);
+    }
+  }
+  if (c < 0) return false;
+
+  // The point furthest from the plane through a, b and c
+  const Vector3d normal = (points[b] - points[a]).cross(points[c] - points[a]).normalized();
+  int d = -1;
+  max_dist = epsilon;
+  for (size_t i = 0; i < points.size(); i++) {
+    const double dist = std::fabs(normal.dot(points[i] - points[a]));
+    if (dist > max_dist) {
+      max_dist = dist;
+      d = static_cast<int>(i);
+    }
+  }
+  if (d < 0) return false;
+
+  // Orient the tetrahedron so that its faces point outwards
+  if (normal.dot(points[d] - points[a]) > 0) std::swap(b, c);
+  faces.reserve(4);
+  addFace(a, b, c, -1);
+  addFace(a, d, b, -1);
+  addFace(b, d, c, -1);
+  addFace(c, d, a, -1);
+  for (auto& face : faces) {
+    for (int i = 0; i < 3; i++) {
+      const int from = face.v[i], to = face.v[(i + 1) % 3];
+      for (size_t j = 0; j < faces.size(); j++) {
+        const auto& other = faces[j];
+        for (int k = 0; k < 3; k++) {
+          if (other.v[k] == to && other.v[(k + 1) % 3] == from) face.neighbor[i] = static_cast<int>(j);
+        }
+      }
+    }
+  }
+
+  std::vector<int> candidates;
+  candidates.reserve(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    if (static_cast<int>(i) != a && static_cast<int>(i) != b && static_cast<int>(i) != c && static_cast<int>(i) != d) {
+      candidates.push_back(static_cast<int>(i));
+    }
+  }
+  assign(candidates, {0, 1, 2, 3});
+  return true;
+}
+
+// Adds the face a, b, c. If it is degenerate, it takes the plane of face fallback.
+int QuickHull::addFace(int a, int b, int c, int fallback)
+{
+  Face face;
+  face.v = {a, b, c};
+  face.neighbor = {-1, -1, -1};
+  const Vector3d normal = (points[b] - points[a]).cross(points[c] - points[a]);
+  const double norm = normal.norm();
+  if (norm > epsilon * epsilon || fallback < 0) {
+    face.normal = normal / norm;
+    face.offset = face.normal.dot(points[a]);
+  } else {
+    face.normal = faces[fallback].normal;
+    face.offset = faces[fallback].offset;
+  }
+  faces.push_back(std::move(face));
+  return static_cast<int>(faces.size()) - 1;
+}
+
+// Moves each candidate point to the outside set of the first new face it is above
+void QuickHull::assign(const std::vector<int>& candidates, const std::vector<int>& new_faces)
+{
+  std::vector<std::pair<int, double>> owner(candidates.size(), {-1, 0.0});
+  auto classify = [&](size_t i) {
+      const auto& p = points[candidates[i]];
+      for (const int f : new_faces) {
+        const double dist = faces[f].distance(p);
+        if (dist > epsilon) {
+          owner[i] = {f, dist};
+          break;
+        }
+      }
+    };
+  if (candidates.size() >= parallelThreshold) {
+    parallelizable_for(0, candidates.size(), classify);
+  } else {
+    for (size_t i = 0; i < candidates.size(); i++) classify(i);
+  }
+
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const auto [f, dist] = owner[i];
+    if (f < 0) continue;
+    auto& face = faces[f];
+    face.outside.push_back(candidates[i]);
+    if (dist > face.furthest_distance) {
+      face.furthest = candidates[i];
+      face.furthest_distance = dist;
+    }
+  }
+  for (const int f : new_faces) {
+    if (!faces[f].outside.empty()) pending.push_back(f);
+  }
+}
+
+// Adds the furthest point above face to the hull. Returns false if the faces
+// visible from it don't form a disc, without changing the hull.
+bool QuickHull::addPoint(int face)
+{
+  const int eye = faces[face].furthest;
+  const Vector3d& eye_point = points[eye];
+
+  // Faces visible from the eye, and the edges bounding them
+  struct HorizonEdge {
+    int from, to, face;
+  };
+  std::vector<int> visible = {face};
+  std::vector<HorizonEdge> horizon;
+  stamp++;
+  faces[face].visible_stamp = stamp;
+  for (size_t i = 0; i < visible.size(); i++) {
+    const auto& f = faces[visible[i]];
+    for (int e = 0; e < 3; e++) {
+      auto& n = faces[f.neighbor[e]];
+      if (n.visible_stamp == stamp) continue;
+      if (n.hidden_stamp != stamp && n.distance(eye_point) > epsilon) {
+        n.visible_stamp = stamp;
+        visible.push_back(f.neighbor[e]);
+      } else {
+        n.hidden_stamp = stamp;
+        horizon.push_back({f.v[e], f.v[(e + 1) % 3], f.neighbor[e]});
+      }
+    }
+  }
+
+  // The horizon has to be a single loop
+  std::unordered_map<int, size_t> by_from, by_to;
+  for (size_t i = 0; i < horizon.size(); i++) {
+    if (!by_from.emplace(horizon[i].from, i).second || !by_to.emplace(horizon[i].to, i).second) return false;
+  }
+  for (const auto& edge : horizon) {
+    if (!by_from.count(edge.to)) return false;
+  }
+  size_t loop_size = 0;
+  size_t current = 0;
+  do {
+    current = by_from[horizon[current].to];
+    loop_size++;
+  } while (current != 0 && loop_size <= horizon.size());
+  if (loop_size != horizon.size()) return false;
+
+  // Cone of new faces from the horizon to the eye
+  const size_t first_new = faces.size();
+  std::vector<int> new_faces;
+  new_faces.reserve(horizon.size());
+  for (const auto& edge : horizon) {
+    new_faces.push_back(addFace(edge.from, edge.to, eye, face));
+  }
+  for (size_t i = 0; i < horizon.size(); i++) {
+    const auto& edge = horizon[i];
+    auto& new_face = faces[first_new + i];
+    new_face.neighbor[0] = edge.face;
+    new_face.neighbor[1] = static_cast<int>(first_new + by_from[edge.to]);
+    new_face.neighbor[2] = static_cast<int>(first_new + by_to[edge.from]);
+    auto& other = faces[edge.face];
+    for (int k = 0; k < 3; k++) {
+      if (other.v[k] == edge.to && other.v[(k + 1) % 3] == edge.from) other.neighbor[k] = new_faces[i];
+    }
+  }
+
+  std::vector<int> candidates;
+  for (const int f : visible) {
+    auto& old_face = faces[f];
+    old_face.deleted = true;
+    for (const int p : old_face.outside) {
+      if (p != eye) candidates.push_back(p);
+    }
+    old_face.outside = std::vector<int>();
+  }
+  assign(candidates, new_faces);
+  return true;
+}
+
+std::unique_ptr<PolySet> QuickHull::toPolySet() const
+{
+  auto ps = std::make_unique<PolySet>(3, true);
+  std::vector<int> vertex_map(points.size(), -1);
+  for (const auto& face : faces) {
+    if (face.deleted) continue;
+    IndexedFace indices;
+    for (const int v : face.v) {
+      if (vertex_map[v] < 0) {
+        vertex_map[v] = static_cast<int>(ps->vertices.size());
+        ps->vertices.push_back(points[v]);
+      }
+      indices.push_back(vertex_map[v]);
+    }
+    ps->indices.push_back(std::move(indices));
+  }
+  return ps;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+/*
+ * 3D convex hull of a point cloud using quickhull in double precision.
+ *
+ * All orientation tests use a tolerance derived from the magnitude of the
+ * input coordinates, so points within rounding distance of a hull face are
+ * treated as lying on it. That keeps the hull topologically consistent for
+ * the nearly coplanar points tessellated curved surfaces are made of.
+ *
+ * Large inputs are first reduced to the points outside the polytope spanned
+ * by their extremes in a few directions, which discards most of the
+ * interior and, for round shapes, most of the surface as well. Both that
+ * filter and the initial partitioning of the points are parallelized.
+ */
+class QuickHull
+{
+public:
+  QuickHull(const std::vector<Vector3d>& points);
+
+  // Returns nullptr if the points don't span a volume
+  static std::unique_ptr<PolySet> hull(const std::vector<Vector3d>& points);
+
+  // True if the points span a volume, i.e. the hull has faces
+  [[nodiscard]] bool isValid() const { return valid; }
+  [[nodiscard]] std::unique_ptr<PolySet> toPolySet() const;
+
+private:
+  struct Face {
+    std::array<int, 3> v;        // counterclockwise seen from outside
+    std::array<int, 3> neighbor; // face across the edge from v[i] to v[i + 1]
+    Vector3d normal;
+    double offset;
+    std::vector<int> outside;    // points above the face
+    int furthest{-1};
+    double furthest_distance{0.0};
+    bool deleted{false};
+    int visible_stamp{-1}; // last visit which found the face visible resp. hidden
+    int hidden_stamp{-1};
+
+    [[nodiscard]] double distance(const Vector3d& p) const { return normal.dot(p) - offset; }
+  };
+
+  bool build();
+  bool createSimplex();
+  int addFace(int a, int b, int c, int fallback);
+  void assign(const std::vector<int>& candidates, const std::vector<int>& new_faces);
+  bool addPoint(int face);
+
+  const std::vector<Vector3d>& points;
+  std::vector<Face> faces;
+  std::vector<int> pending; // faces which may have points outside
+  int stamp{0};
+  double epsilon{0.0};
+  bool valid{false};
+};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "geometry/PolySet.h"
 #include "geometry/Geometry.h"
 
 std::unique_ptr<PolySet> applyHull(const Geometry::Geometries& children);
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children);
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children, const std::vector<std::string>& childIds = {});
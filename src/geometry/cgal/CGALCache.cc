@@ -1,6 +1,7 @@
 #include "geometry/cgal/CGALCache.h"
 
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <cstddef>
 #include <string>
@@ -23,6 +24,7 @@ CGALCache::CGALCache(size_t limit) : cache(limit)
 std::shared_ptr<const Geometry> CGALCache::get(const std::string& id) const
 {
   const auto& N = this->cache[id]->N;
+  ++num_hits;
 #ifdef DEBUG
   LOG("CGAL Cache hit: %1$s (%2$d bytes)", id.substr(0, 40), N ? N->memsize() : 0);
 #endif
@@ -40,10 +42,12 @@ bool CGALCache::acceptsGeometry(const std::shared_ptr<const Geometry>& geom) {
     ;
 }
 
-bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& N)
+bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& N,
+                       std::chrono::duration<double> computeTime)
 {
   assert(acceptsGeometry(N));
-  auto inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0);
+  ++num_misses;
+  auto inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0, computeTime.count());
 #ifdef DEBUG
   if (inserted) LOG("CGAL Cache insert: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
   else LOG("CGAL Cache insert failed: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
@@ -80,6 +84,8 @@ void CGALCache::print()
 {
   LOG("CGAL Polyhedrons in cache: %1$d", this->cache.size());
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
+  LOG("CGAL cache: %1$d hits, %2$d misses, %3$d evictions, %4$d rejected",
+      num_hits, num_misses, evictions(), rejections());
 }
 
 CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Cache.h"
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -16,10 +17,15 @@ public:
 
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N);
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N,
+              std::chrono::duration<double> computeTime = std::chrono::duration<double>::zero());
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
+  size_t hits() const { return num_hits; }
+  size_t misses() const { return num_misses; }
+  size_t evictions() const { return cache.evictions(); }
+  size_t rejections() const { return cache.rejections(); }
   void setMaxSizeMB(size_t limit);
   void clear();
   void print();
@@ -34,4 +40,5 @@ private:
   };
 
   Cache<std::string, cache_entry> cache;
+  mutable size_t num_hits{0}, num_misses{0};
 };
@@ -0,0 +1,91 @@
+#include "geometry/cgal/ConvexDecompositionCache.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <CGAL/Cartesian_converter.h>
+#include <CGAL/convex_decomposition_3.h>
+#include "geometry/cgal/cgal.h"
+#include "utils/printutils.h"
+
+ConvexDecompositionCache::ConvexDecompositionCache(size_t limit) : cache(limit)
+{
+}
+
+std::shared_ptr<const ConvexDecompositionCache::Parts> ConvexDecompositionCache::decompose(CGAL_Nef_polyhedron3& nef)
+{
+  CGAL::convex_decomposition_3(nef);
+
+  CGAL::Cartesian_converter<CGAL_Kernel3, CGAL::Epick> conv;
+  auto parts = std::make_shared<Parts>();
+  // the first volume is the outer volume, which ignored in the decomposition
+  for (auto ci = ++nef.volumes_begin(); ci != nef.volumes_end(); ++ci) {
+    if (ci->mark()) {
+      CGAL_Polyhedron poly;
+      nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
+      Points& points = parts->emplace_back();
+      points.reserve(poly.size_of_vertices());
+      for (auto pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
+        points.push_back(conv(pi->point()));
+      }
+    }
+  }
+  return parts;
+}
+
+std::shared_ptr<const ConvexDecompositionCache::Parts> ConvexDecompositionCache::get(const std::string& id) const
+{
+  if (id.empty()) return nullptr;
+  const std::lock_guard<std::mutex> lock(mutex);
+  const auto *entry = this->cache[id];
+  if (!entry) return nullptr;
+  ++num_hits;
+  return entry->parts;
+}
+
+bool ConvexDecompositionCache::insert(const std::string& id, const std::shared_ptr<const Parts>& parts,
+                                      std::chrono::duration<double> computeTime)
+{
+  if (id.empty()) return false;
+  size_t memsize = sizeof(Parts);
+  for (const auto& points : *parts) memsize += sizeof(Points) + points.capacity() * sizeof(CGAL::Epick::Point_3);
+
+  const std::lock_guard<std::mutex> lock(mutex);
+  ++num_misses;
+  return this->cache.insert(id, new cache_entry(parts), memsize, computeTime.count());
+}
+
+size_t ConvexDecompositionCache::size() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return cache.size();
+}
+
+size_t ConvexDecompositionCache::totalCost() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return cache.totalCost();
+}
+
+size_t ConvexDecompositionCache::maxSizeMB() const
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  return cache.maxCost() / (1024ul * 1024ul);
+}
+
+void ConvexDecompositionCache::clear()
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  cache.clear();
+}
+
+void ConvexDecompositionCache::print()
+{
+  const std::lock_guard<std::mutex> lock(mutex);
+  LOG("Convex decompositions in cache: %1$d", this->cache.size());
+  LOG("Convex decomposition cache size in bytes: %1$d", this->cache.totalCost());
+  LOG("Convex decomposition cache: %1$d hits, %2$d misses", num_hits, num_misses);
+}
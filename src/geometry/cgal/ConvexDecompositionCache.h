@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Cache.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include "geometry/cgal/cgal.h"
+
+/*
+ * Convex parts of non-convex 3D Minkowski operands, keyed by the cache id of
+ * the operand's node. The decomposition dominates the cost of a Minkowski
+ * sum, so a tool shape used in several sums is only decomposed once. Parts
+ * are kept as the points the hull stage needs. All members are safe to
+ * call from several threads, as parallelizable_for() in minkowski does.
+ */
+class ConvexDecompositionCache
+{
+public:
+  using Points = std::vector<CGAL::Epick::Point_3>;
+  using Parts = std::vector<Points>;
+
+  ConvexDecompositionCache(size_t limit = 100ul *1024ul *1024ul);
+
+  static ConvexDecompositionCache *instance() { static ConvexDecompositionCache cache; return &cache; }
+
+  // Decomposes nef, which is consumed in the process
+  static std::shared_ptr<const Parts> decompose(CGAL_Nef_polyhedron3& nef);
+
+  // Returns nullptr if id is empty or not cached
+  std::shared_ptr<const Parts> get(const std::string& id) const;
+  bool insert(const std::string& id, const std::shared_ptr<const Parts>& parts,
+              std::chrono::duration<double> computeTime = std::chrono::duration<double>::zero());
+  size_t size() const;
+  size_t totalCost() const;
+  size_t maxSizeMB() const;
+  size_t hits() const { return num_hits; }
+  size_t misses() const { return num_misses; }
+  void clear();
+  void print();
+
+private:
+  struct cache_entry {
+    std::shared_ptr<const Parts> parts;
+    cache_entry(const std::shared_ptr<const Parts>& parts) : parts(parts) {}
+  };
+
+  mutable std::mutex mutex;
+  Cache<std::string, cache_entry> cache;
+  mutable size_t num_hits{0}, num_misses{0};
+};
@@ -1,15 +1,20 @@
 #include "geometry/cgal/cgalutils.h"
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <CGAL/Timer.h>
 #include <CGAL/convex_hull_3.h>
 
+#include "geometry/cgal/ConvexDecompositionCache.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 namespace CGALUtils {
 
-std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children)
+std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children, const std::vector<std::string>& childIds)
 {
   assert(children.size() >= 2);
 
@@ -21,18 +26,27 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
   ModuleInstantiation *instance = new ModuleInstantiation(instance_name,inst_asslist, Location::NONE);
   CsgOpNode node(instance,OpenSCADOperator::UNION);
   
+  using Hull_kernel = CGAL::Epick;
+  using Parts = ConvexDecompositionCache::Parts;
   auto it = children.begin();
+  size_t child = 0;
   std::shared_ptr<const Geometry> operands[2] = {it->second, std::shared_ptr<const Geometry>()};
+  // Cache ids of the operands, empty for intermediate results
+  std::string operand_ids[2] = {child < childIds.size() ? childIds[child] : "", ""};
   try {
     while (++it != children.end()) {
       operands[1] = it->second;
+      ++child;
+      operand_ids[1] = child < childIds.size() ? childIds[child] : "";
 
-      using Hull_kernel = CGAL::Epick;
-
-      std::list<CGAL_Polyhedron> P[2];
-      std::list<CGAL::Polyhedron_3<Hull_kernel>> result_parts;
+      std::shared_ptr<const Parts> P[2];
+      CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
 
       for (size_t i = 0; i < 2; ++i) {
+        if ((P[i] = ConvexDecompositionCache::instance()->get(operand_ids[i]))) {
+          PRINTDB("Minkowski: child %d decomposition is cached", i);
+          continue;
+        }
         CGAL_Polyhedron poly;
 
         auto ps = std::dynamic_pointer_cast<const PolySet>(operands[i]);
@@ -49,7 +63,12 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
         if ((ps && ps->isConvex()) ||
             (!ps && CGALUtils::is_weakly_convex(poly))) {
           PRINTDB("Minkowski: child %d is convex and %s", i % (ps?"PolySet":"Nef"));
-          P[i].push_back(poly);
+          auto parts = std::make_shared<Parts>(1);
+          parts->front().reserve(poly.size_of_vertices());
+          for (auto pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
+            parts->front().push_back(conv(pi->point()));
+          }
+          P[i] = parts;
         } else {
           CGAL_Nef_polyhedron3 decomposed_nef;
 
@@ -63,64 +82,33 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
           }
 
           t.start();
-          CGAL::convex_decomposition_3(decomposed_nef);
-
-          // the first volume is the outer volume, which ignored in the decomposition
-          for (auto ci = ++decomposed_nef.volumes_begin(); ci != decomposed_nef.volumes_end(); ++ci) {
-            if (ci->mark()) {
-              CGAL_Polyhedron poly;
-              decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-              P[i].push_back(poly);
-            }
-          }
-
-
-          PRINTDB("Minkowski: decomposed into %d convex parts", P[i].size());
+          P[i] = ConvexDecompositionCache::decompose(decomposed_nef);
           t.stop();
+          ConvexDecompositionCache::instance()->insert(operand_ids[i], P[i], std::chrono::duration<double>(t.time()));
+
+          PRINTDB("Minkowski: decomposed into %d convex parts", P[i]->size());
           PRINTDB("Minkowski: decomposition took %f s", t.time());
+          t.reset();
         }
       }
 
-      std::vector<Hull_kernel::Point_3> points[2];
-      std::vector<Hull_kernel::Point_3> minkowski_points;
-
-      CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
-
-      for (size_t i = 0; i < P[0].size(); ++i) {
-        for (size_t j = 0; j < P[1].size(); ++j) {
+      // Hulls of all pairs of parts, computed in parallel
+      auto combineParts = [&](const ConvexDecompositionCache::Points& points0, const ConvexDecompositionCache::Points& points1) -> std::shared_ptr<const Geometry> {
+          CGAL::Timer t;
           t.start();
-          points[0].clear();
-          points[1].clear();
-
-          for (int k = 0; k < 2; ++k) {
-            auto it = P[k].begin();
-            std::advance(it, k == 0?i:j);
-
-            CGAL_Polyhedron const& poly = *it;
-            points[k].reserve(poly.size_of_vertices());
-
-            for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
-              CGAL_Polyhedron::Point_3 const& p = pi->point();
-              points[k].push_back(conv(p));
+          std::vector<Hull_kernel::Point_3> minkowski_points;
+          minkowski_points.reserve(points0.size() * points1.size());
+          for (const auto& p0 : points0) {
+            for (const auto& p1 : points1) {
+              minkowski_points.push_back(p0 + (p1 - CGAL::ORIGIN));
             }
           }
 
-          minkowski_points.clear();
-          minkowski_points.reserve(points[0].size() * points[1].size());
-          for (size_t i = 0; i < points[0].size(); ++i) {
-            for (size_t j = 0; j < points[1].size(); ++j) {
-              minkowski_points.push_back(points[0][i] + (points[1][j] - CGAL::ORIGIN));
-            }
-          }
-
-          if (minkowski_points.size() <= 3) {
-            t.stop();
-            continue;
-          }
+          if (minkowski_points.size() <= 3) return nullptr;
 
           CGAL::Polyhedron_3<Hull_kernel> result;
           t.stop();
-          PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms", points[0].size() % points[1].size() % minkowski_points.size() % (t.time() * 1000));
+          PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms", points0.size() % points1.size() % minkowski_points.size() % (t.time() * 1000));
           t.reset();
 
           t.start();
@@ -170,26 +158,28 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
 
           t.stop();
           PRINTDB("Minkowski: Computing convex hull took %f s", t.time());
-          t.reset();
 
-          result_parts.push_back(result);
-        }
+          return CGALUtils::createPolySetFromPolyhedron(result);
+        };
+
+      std::vector<std::shared_ptr<const Geometry>> hulls(P[0]->size() * P[1]->size());
+      parallelizable_cross_product_transform(*P[0], *P[1], hulls.begin(), combineParts);
+      std::vector<std::shared_ptr<const Geometry>> result_parts;
+      for (auto& hull : hulls) {
+        if (hull) result_parts.push_back(std::move(hull));
       }
 
       if (it != std::next(children.begin())) operands[0].reset();
-
-      auto partToGeom = [&](auto& poly) -> std::shared_ptr<const Geometry> {
-          return CGALUtils::createPolySetFromPolyhedron(poly);
-        };
+      operand_ids[0].clear();
 
       if (result_parts.size() == 1) {
-        operands[0] = partToGeom(*result_parts.begin());
+        operands[0] = result_parts.front();
       } else if (!result_parts.empty()) {
         t.start();
         PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
         Geometry::Geometries fake_children;
         for (const auto& part : result_parts) {
-          fake_children.emplace_back(std::shared_ptr<const AbstractNode>(), partToGeom(part));
+          fake_children.emplace_back(std::shared_ptr<const AbstractNode>(), part);
         }
         auto N = CGALUtils::applyUnion3D(node, fake_children.begin(), fake_children.end());
         // FIXME: This should really never throw.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "core/CsgOpNode.h"
@@ -33,7 +34,8 @@ bool is_weakly_convex(const CGAL::Surface_mesh<CGAL::Point_3<K>>& m);
 
 std::shared_ptr<const Geometry> applyOperator3D(const CsgOpNode &node, const Geometry::Geometries& children, OpenSCADOperator op);
 std::unique_ptr<const Geometry> applyUnion3D(const CsgOpNode &node, Geometry::Geometries::iterator chbegin, Geometry::Geometries::iterator chend);
-std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children);
+// childIds are the cache ids of the children, used to reuse their convex decompositions
+std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children, const std::vector<std::string>& childIds = {});
 
 std::unique_ptr<Polygon2d> project(const CGALNefGeometry& N, bool cut);
 template <typename K>
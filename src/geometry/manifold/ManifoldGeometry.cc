@@ -79,6 +79,7 @@ bool ManifoldGeometry::isValid() const {
 
 void ManifoldGeometry::clear() {
   manifold_ = manifold::Manifold();
+  polyset_cache_.reset();
 }
 
 size_t ManifoldGeometry::memsize() const {
@@ -108,7 +109,17 @@ std::string ManifoldGeometry::dump() const {
   return out.str();
 }
 
-std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const {
+std::shared_ptr<const PolySet> ManifoldGeometry::toPolySet() const {
+  const std::string& colorscheme = RenderSettings::inst()->colorscheme;
+  if (auto cached = std::atomic_load(&polyset_cache_)) {
+    // Face colors depend on the color scheme, convexity may be set later
+    if (cached->colorscheme == colorscheme && cached->ps->getConvexity() == convexity) {
+      ManifoldUtils::countConversion(ManifoldUtils::Conversion::ToPolySet, true);
+      return cached->ps;
+    }
+  }
+  ManifoldUtils::countConversion(ManifoldUtils::Conversion::ToPolySet, false);
+
   manifold::MeshGL64 mesh = getManifold().GetMeshGL64();
   auto ps = std::make_shared<PolySet>(3);
   ps->setTriangular(true);
@@ -126,7 +137,7 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const {
   ps->colors.reserve(originalIDToColor_.size());
   ps->color_indices.reserve(ps->indices.size());
 
-  auto colorScheme = ColorMap::inst()->findColorScheme(RenderSettings::inst()->colorscheme);
+  auto colorScheme = ColorMap::inst()->findColorScheme(colorscheme);
   int32_t faceFrontColorIndex = -1;
   int32_t faceBackColorIndex = -1;
 
@@ -190,6 +201,7 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const {
     }
     start = end;
   }
+  std::atomic_store(&polyset_cache_, std::make_shared<const PolySetCache>(PolySetCache{ps, colorscheme}));
   return ps;
 }
 
@@ -331,6 +343,7 @@ void ManifoldGeometry::transform(const Transform3d& mat) {
     {mat(0, 3), mat(1, 3), mat(2, 3)}
   );
   manifold_ = getManifold().Transform(glMat);
+  polyset_cache_.reset();
 }
 
 void ManifoldGeometry::setColor(const Color4f& c) {
@@ -342,6 +355,7 @@ void ManifoldGeometry::setColor(const Color4f& c) {
   originalIDToColor_.clear();
   originalIDToColor_[manifold_.OriginalID()] = c;
   subtractedIDs_.clear();
+  polyset_cache_.reset();
 }
 
 void ManifoldGeometry::toOriginal() {
@@ -352,6 +366,7 @@ void ManifoldGeometry::toOriginal() {
   originalIDs_.insert(manifold_.OriginalID());
   originalIDToColor_.clear();
   subtractedIDs_.clear();
+  polyset_cache_.reset();
 }
 
 BoundingBox ManifoldGeometry::getBoundingBox() const
@@ -45,7 +45,8 @@ public:
   [[nodiscard]] unsigned int getDimension() const override { return 3; }
   [[nodiscard]] std::unique_ptr<Geometry> copy() const override;
 
-  [[nodiscard]] std::shared_ptr<PolySet> toPolySet() const;
+  // The conversion is kept until this object changes, so repeated calls are cheap
+  [[nodiscard]] std::shared_ptr<const PolySet> toPolySet() const;
 
   template <class Polyhedron>
   [[nodiscard]] std::shared_ptr<Polyhedron> toPolyhedron() const;
@@ -79,4 +80,11 @@ private:
   std::set<uint32_t> originalIDs_;
   std::map<uint32_t, Color4f> originalIDToColor_;
   std::set<uint32_t> subtractedIDs_;
+
+  struct PolySetCache {
+    std::shared_ptr<const PolySet> ps;
+    std::string colorscheme;
+  };
+  // Result of toPolySet(), accessed atomically
+  mutable std::shared_ptr<const PolySetCache> polyset_cache_;
 };
@@ -3,9 +3,10 @@
 
 #include <iterator>
 #include <cassert>
-#include <list>
+#include <chrono>
 #include <exception>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -15,6 +16,7 @@
 #include "geometry/cgal/cgal.h"
 #include "geometry/Geometry.h"
 #include "geometry/cgal/cgalutils.h"
+#include "geometry/cgal/ConvexDecompositionCache.h"
 #include "geometry/PolySet.h"
 #include "utils/printutils.h"
 #include "geometry/manifold/manifoldutils.h"
@@ -26,13 +28,14 @@ namespace ManifoldUtils {
 /*!
    children cannot contain nullptr objects
  */
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children)
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children, const std::vector<std::string>& childIds)
 {
   assert(children.size() >= 2);
 
   using Hull_kernel = CGAL::Epick;
   using Hull_Mesh = CGAL::Surface_mesh<CGAL::Point_3<Hull_kernel>>;
-  using Hull_Points = std::vector<CGAL::Point_3<Hull_kernel>>;
+  using Hull_Points = ConvexDecompositionCache::Points;
+  using Parts = ConvexDecompositionCache::Parts;
 
   auto surfaceMeshFromGeometry = [](const std::shared_ptr<const Geometry>& geom, bool *pIsConvexOut) -> std::shared_ptr<CGAL_Kernel3Mesh>
   {
@@ -52,14 +55,6 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
   };
 
   CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
-  auto getHullPoints = [&](const CGAL_Polyhedron &poly) {
-    std::vector<Hull_kernel::Point_3> out;
-    out.reserve(poly.size_of_vertices());
-    for (auto pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
-      out.push_back(conv(pi->point()));
-    }
-    return out;
-  };
   auto getHullPointsFromMesh = [&](const CGAL_Kernel3Mesh &mesh) {
     std::vector<Hull_kernel::Point_3> out;
     out.reserve(mesh.number_of_vertices());
@@ -73,29 +68,36 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
   t_tot.start();
 
   auto it = children.begin();
-  std::vector<std::shared_ptr<const Geometry>> operands = {it->second, std::shared_ptr<const Geometry>()};
+  size_t child = 0;
+  std::shared_ptr<const Geometry> operands[2] = {it->second, std::shared_ptr<const Geometry>()};
+  // Cache ids of the operands, empty for intermediate results
+  std::string operand_ids[2] = {child < childIds.size() ? childIds[child] : "", ""};
 
   try {
     // Note: we could parallelize more, e.g. compute all decompositions ahead of time instead of doing them 2 by 2,
     // but this could use substantially more memory.
     while (++it != children.end()) {
       operands[1] = it->second;
+      ++child;
+      operand_ids[1] = child < childIds.size() ? childIds[child] : "";
 
-      std::vector<std::list<Hull_Points>> part_points(2);
+      std::shared_ptr<const Parts> part_points[2];
 
-      parallelizable_transform(operands.begin(), operands.begin() + 2, part_points.begin(),
-                               [&](std::shared_ptr<const Geometry> &operand) {
-        std::list<Hull_Points> part_points;
+      parallelizable_for(0, 2, [&](size_t i) {
+        if ((part_points[i] = ConvexDecompositionCache::instance()->get(operand_ids[i]))) {
+          PRINTDB("Minkowski: child %d decomposition is cached", i);
+          return;
+        }
 
         bool is_convex;
-        auto mesh = surfaceMeshFromGeometry(operand, &is_convex);
+        auto mesh = surfaceMeshFromGeometry(operands[i], &is_convex);
         if (!mesh) throw 0;
         if (mesh->is_empty()) {
           throw 0;
         }
 
         if (is_convex) {
-          part_points.emplace_back(getHullPointsFromMesh(*mesh));
+          part_points[i] = std::make_shared<const Parts>(1, getHullPointsFromMesh(*mesh));
         } else {
           // The CGAL_Nef_polyhedron3 constructor can crash on bad polyhedron, so don't try
           if (!mesh->is_valid()) throw 0;
@@ -103,27 +105,15 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
           CGALUtils::convertSurfaceMeshToNef(*mesh, decomposed_nef);
           CGAL::Timer t;
           t.start();
-          CGAL::convex_decomposition_3(decomposed_nef);
-
-          // the first volume is the outer volume, which ignored in the decomposition
-          CGAL_Nef_polyhedron3::Volume_const_iterator ci = ++decomposed_nef.volumes_begin();
-          for (; ci != decomposed_nef.volumes_end(); ++ci) {
-            if (ci->mark()) {
-              CGAL_Polyhedron poly;
-              decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-              part_points.emplace_back(getHullPoints(poly));
-            }
-          }
-
-          PRINTDB("Minkowski: decomposed into %d convex parts", part_points.size());
+          part_points[i] = ConvexDecompositionCache::decompose(decomposed_nef);
           t.stop();
+          ConvexDecompositionCache::instance()->insert(operand_ids[i], part_points[i], std::chrono::duration<double>(t.time()));
+
+          PRINTDB("Minkowski: decomposed into %d convex parts", part_points[i]->size());
           PRINTDB("Minkowski: decomposition took %f s", t.time());
         }
-        return part_points;
       });
 
-      std::vector<Hull_kernel::Point_3> minkowski_points;
-
       auto combineParts = [&](const Hull_Points &points0, const Hull_Points &points1) -> std::shared_ptr<const ManifoldGeometry> {
         CGAL::Timer t;
 
@@ -198,27 +188,28 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
         return ManifoldUtils::createManifoldFromSurfaceMesh(mesh);
       };
 
-      std::vector<std::shared_ptr<const ManifoldGeometry>> result_parts(part_points[0].size() * part_points[1].size());
+      std::vector<std::shared_ptr<const ManifoldGeometry>> result_parts(part_points[0]->size() * part_points[1]->size());
       parallelizable_cross_product_transform(
-          part_points[0], part_points[1],
+          *part_points[0], *part_points[1],
           result_parts.begin(),
           combineParts);
 
       if (it != std::next(children.begin())) operands[0].reset();
+      operand_ids[0].clear();
 
       CGAL::Timer t;
       t.start();
       PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
-      Geometry::Geometries fake_children;
+      // BatchBoolean unions the hulls as a balanced tree, smallest first
+      std::vector<manifold::Manifold> manifolds;
+      manifolds.reserve(result_parts.size());
       for (const auto& part : result_parts) {
-        fake_children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(),
-                                                part));
+        if (part && !part->isEmpty()) manifolds.push_back(part->getManifold());
       }
-      auto N = ManifoldUtils::applyOperator3DManifold(fake_children, OpenSCADOperator::UNION);
-
       // FIXME: This should really never throw.
       // Assert once we figured out what went wrong with issue #1069?
-      if (!N) throw 0;
+      if (manifolds.empty()) throw 0;
+      auto N = std::make_shared<ManifoldGeometry>(manifold::Manifold::BatchBoolean(manifolds, manifold::OpType::Add));
       t.stop();
       PRINTDB("Minkowski: Union done: %f s", t.time());
       t.reset();
@@ -0,0 +1,187 @@
+#ifdef ENABLE_MANIFOLD
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/manifold/manifoldutils.h"
+#include "geometry/manifold/ManifoldGeometry.h"
+#include "geometry/PointInPolyhedron.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "utils/printutils.h"
+
+namespace ManifoldUtils {
+
+namespace {
+
+// Bound on the number of cells of the triangle grid relative to the number of triangles
+constexpr size_t maxCellsPerTriangle = 64;
+// Samples along the longest side of the level set grid if no resolution is given,
+// unless half the offset distance is finer
+constexpr double defaultLevelSetSamples = 100;
+// Bound on the number of samples of the level set grid
+constexpr double maxLevelSetSamples = 256.0 * 256.0 * 256.0;
+
+// Closest point to p on triangle abc, see Ericson, Real-Time Collision Detection, 5.1.5
+Vector3d closestPointOnTriangle(const Vector3d& p, const Vector3d& a, const Vector3d& b, const Vector3d& c)
+{
+  const Vector3d ab = b - a, ac = c - a, ap = p - a;
+  const double d1 = ab.dot(ap), d2 = ac.dot(ap);
+  if (d1 <= 0 && d2 <= 0) return a;
+  const Vector3d bp = p - b;
+  const double d3 = ab.dot(bp), d4 = ac.dot(bp);
+  if (d3 >= 0 && d4 <= d3) return b;
+  const double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+  const Vector3d cp = p - c;
+  const double d5 = ab.dot(cp), d6 = ac.dot(cp);
+  if (d6 >= 0 && d5 <= d6) return c;
+  const double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+  const double va = d3 * d6 - d5 * d4;
+  if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  const double denom = va + vb + vc;
+  if (denom == 0) return a; // degenerate triangle
+  return a + ab * (vb / denom) + ac * (vc / denom);
+}
+
+/*
+ * Distance to the nearest triangle of a triangulated PolySet, clamped to
+ * max_dist. Every triangle is binned into the cells of a uniform grid which
+ * come within max_dist of its bounding box, so a query only tests the
+ * triangles of the one cell containing the point.
+ */
+class ClampedDistance
+{
+public:
+  ClampedDistance(const PolySet& ps, double max_dist) : ps(ps), max_dist(max_dist) {
+    BoundingBox bbox = ps.getBoundingBox();
+    origin = bbox.min() - Vector3d::Constant(max_dist);
+    const Vector3d size = bbox.sizes() + Vector3d::Constant(2 * max_dist);
+    cell_size = max_dist;
+    const size_t max_cells = std::max<size_t>(maxCellsPerTriangle * ps.indices.size(), 1);
+    while (true) {
+      for (int i = 0; i < 3; i++) dims[i] = static_cast<size_t>(size[i] / cell_size) + 1;
+      if (dims[0] * dims[1] * dims[2] <= max_cells) break;
+      cell_size *= 2;
+    }
+
+    // Two passes over the triangles: count the entries per cell, then fill them
+    cell_start.assign(dims[0] * dims[1] * dims[2] + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      std::vector<size_t> fill;
+      if (pass == 1) {
+        for (size_t i = 1; i < cell_start.size(); i++) cell_start[i] += cell_start[i - 1];
+        cell_faces.resize(cell_start.back());
+        fill.assign(cell_start.begin(), cell_start.end() - 1);
+      }
+      for (size_t f = 0; f < ps.indices.size(); f++) {
+        BoundingBox box;
+        for (const auto ind : ps.indices[f]) box.extend(ps.vertices[ind]);
+        size_t lo[3], hi[3];
+        for (int i = 0; i < 3; i++) {
+          lo[i] = index(box.min()[i] - max_dist, i);
+          hi[i] = index(box.max()[i] + max_dist, i);
+        }
+        for (size_t z = lo[2]; z <= hi[2]; z++) {
+          for (size_t y = lo[1]; y <= hi[1]; y++) {
+            for (size_t x = lo[0]; x <= hi[0]; x++) {
+              const size_t cell = (z * dims[1] + y) * dims[0] + x;
+              if (pass == 0) cell_start[cell + 1]++;
+              else cell_faces[fill[cell]++] = f;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  double operator()(const Vector3d& pt) const {
+    size_t cell = 0;
+    for (int i = 2; i >= 0; i--) {
+      const double pos = (pt[i] - origin[i]) / cell_size;
+      if (pos < 0 || pos >= dims[i]) return max_dist; // outside of the grid means far from all triangles
+      cell = cell * dims[i] + static_cast<size_t>(pos);
+    }
+    double best = max_dist * max_dist;
+    for (size_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) {
+      const auto& tri = ps.indices[cell_faces[i]];
+      const Vector3d closest = closestPointOnTriangle(pt, ps.vertices[tri[0]], ps.vertices[tri[1]], ps.vertices[tri[2]]);
+      best = std::min(best, (closest - pt).squaredNorm());
+    }
+    return std::sqrt(best);
+  }
+
+private:
+  [[nodiscard]] size_t index(double coord, int axis) const {
+    const double pos = (coord - origin[axis]) / cell_size;
+    return static_cast<size_t>(std::clamp(pos, 0.0, static_cast<double>(dims[axis] - 1)));
+  }
+
+  const PolySet& ps;
+  double max_dist;
+  Vector3d origin;
+  double cell_size;
+  size_t dims[3];
+  std::vector<size_t> cell_start; // faces of cell i are cell_faces[cell_start[i], cell_start[i + 1])
+  std::vector<size_t> cell_faces;
+};
+
+} // namespace
+
+/*!
+   Offsets ps by delta, extracting the delta isosurface of its signed distance
+   sampled on a grid of the given resolution. A resolution of 0 divides the
+   longest side of the offset object into defaultLevelSetSamples, or takes
+   half of |delta| if that is finer, so small offsets of large objects are
+   resolved. Grids of more than maxLevelSetSamples are coarsened, with a
+   warning.
+
+   Distances are only resolved within a band around the surface. Beyond it
+   the clamped distance keeps the sign, which is all the surface extraction
+   needs there.
+ */
+std::shared_ptr<ManifoldGeometry> createOffsetLevelSet(const std::shared_ptr<const PolySet>& ps, double delta, double resolution)
+{
+  std::shared_ptr<const PolySet> tris = ps;
+  if (!ps->isTriangular()) tris = PolySetUtils::tessellate_faces(*ps);
+  if (tris->indices.empty()) return std::make_shared<ManifoldGeometry>();
+
+  const BoundingBox bbox = tris->getBoundingBox();
+  const Vector3d extent = bbox.sizes() + Vector3d::Constant(2 * std::max(delta, 0.0));
+  if (resolution <= 0) resolution = std::min(extent.maxCoeff() / defaultLevelSetSamples, std::fabs(delta) / 2);
+  const auto samples = [&](double res) {
+    return (extent[0] / res + 3) * (extent[1] / res + 3) * (extent[2] / res + 3);
+  };
+  if (samples(resolution) > maxLevelSetSamples) {
+    const double requested = resolution;
+    while (samples(resolution) > maxLevelSetSamples) resolution *= 1.25;
+    LOG(message_group::Warning, "offset resolution %1$g needs too large a grid, using %2$g", requested, resolution);
+  }
+
+  // Samples next to the isosurface may be up to a cell diagonal away from it
+  const ClampedDistance distance(*tris, std::fabs(delta) + 2 * resolution);
+  const auto inside = PointInPolyhedron::get(tris);
+  auto sdf = [&](manifold::vec3 p) -> double {
+    const Vector3d pt(p.x, p.y, p.z);
+    const double d = distance(pt);
+    return inside->contains(pt) ? d : -d;
+  };
+
+  const double grow = std::max(delta, 0.0) + resolution;
+  const manifold::Box bounds(
+    manifold::vec3(bbox.min()[0] - grow, bbox.min()[1] - grow, bbox.min()[2] - grow),
+    manifold::vec3(bbox.max()[0] + grow, bbox.max()[1] + grow, bbox.max()[2] + grow));
+  PRINTDB("Offset: level set with resolution %g", resolution);
+  // The level is the signed distance of the new surface, positive inside
+  return std::make_shared<ManifoldGeometry>(manifold::Manifold::LevelSet(sdf, bounds, resolution, -delta));
+}
+
+} // namespace ManifoldUtils
+
+#endif // ENABLE_MANIFOLD
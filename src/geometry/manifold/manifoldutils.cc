@@ -1,6 +1,7 @@
 // Portions of this file are Copyright 2023 Google LLC, and licensed under GPL2+. See COPYING.
 #include "geometry/manifold/manifoldutils.h"
 
+#include <atomic>
 #include <cstddef>
 #include <optional>
 #include <vector>
@@ -14,10 +15,10 @@
 
 #include <manifold/polygon.h>
 #ifdef ENABLE_CGAL
-#include <CGAL/convex_hull_3.h>
 #include <CGAL/Surface_mesh.h>
 #endif
 
+#include "geometry/ConversionCache.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "geometry/manifold/ManifoldGeometry.h"
@@ -25,6 +26,7 @@
 #include "utils/printutils.h"
 #include "geometry/PolySetUtils.h"
 #include "geometry/PolySet.h"
+#include "geometry/QuickHull.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
 #endif
@@ -129,6 +131,8 @@ const char* statusToString(Error status) {
 
 std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
 {
+  countConversion(Conversion::ToManifold, false);
+
   // 1. If the PolySet is already manifold, we should be able to build a Manifold object directly
   // (through using manifold::Mesh).
   // We need to make sure our PolySet is triangulated before doing that.
@@ -151,39 +155,27 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
       ManifoldUtils::statusToString(mani->getManifold().Status()));
 
   // 2. If the PolySet couldn't be converted into a Manifold object, let's try to repair it.
-  // We currently have to utilize some CGAL functions to do this.
+  PolySet psq(ps);
+  std::vector<Vector3d> points3d;
+  psq.quantizeVertices(&points3d);
+  auto ps_tri = PolySetUtils::tessellate_faces(psq);
+
+  // A convex PolySet is simply rebuilt as the hull of its vertices
+  if (ps_tri->isConvex()) {
+    auto hull = QuickHull::hull(points3d);
+    if (!hull) return std::make_shared<ManifoldGeometry>();
+    return createManifoldFromTriangularPolySet(*hull);
+  }
+
+  // We currently have to utilize some CGAL functions to repair other meshes.
 #ifdef ENABLE_CGAL
   try {
-    PolySet psq(ps);
-    std::vector<Vector3d> points3d;
-    psq.quantizeVertices(&points3d);
-    auto ps_tri = PolySetUtils::tessellate_faces(psq);
-
-    CGAL_DoubleMesh m;
-
-    if (ps_tri->isConvex()) {
-      using K = CGAL::Epick;
-      // Collect point cloud
-      std::vector<K::Point_3> points(points3d.size());
-      for (size_t i = 0, n = points3d.size(); i < n; i++) {
-        points[i] = CGALUtils::vector_convert<K::Point_3>(points3d[i]);
-      }
-      if (points.size() <= 3) return std::make_shared<ManifoldGeometry>();
-
-      // Apply hull
-      CGAL::Surface_mesh<CGAL::Point_3<K>> r;
-      CGAL::convex_hull_3(points.begin(), points.end(), r);
-      CGALUtils::copyMesh(r, m);
-    } else {
-      m = CGALUtils::repairPolySet(*ps_tri);
-    }
+    CGAL_DoubleMesh m = CGALUtils::repairPolySet(*ps_tri);
 
-    if (!ps_tri->isConvex()) {
-      if (CGALUtils::isClosed(m)) {
-        CGALUtils::orientToBoundAVolume(m);
-      } else {
-        LOG(message_group::Error, "[manifold] Input mesh is not closed!");
-      }
+    if (CGALUtils::isClosed(m)) {
+      CGALUtils::orientToBoundAVolume(m);
+    } else {
+      LOG(message_group::Error, "[manifold] Input mesh is not closed!");
     }
 
     auto geom = createManifoldFromSurfaceMesh(m);
@@ -200,10 +192,52 @@ std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(const std::sh
   if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
     return mani;
   }
-  if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
-    return createManifoldFromPolySet(*ps);
+
+  static ConversionCache<Geometry, ManifoldGeometry> converted;
+  if (auto mani = converted.get(geom)) {
+    countConversion(Conversion::ToManifold, true);
+    return mani;
   }
-  return nullptr;
+
+  auto ps = PolySetUtils::getGeometryAsPolySet(geom);
+  if (!ps) return nullptr;
+  std::shared_ptr<const ManifoldGeometry> mani = createManifoldFromPolySet(*ps);
+
+  // ManifoldGeometry::memsize() doesn't look into the manifold, so its size is
+  // estimated from the mesh it was built from.
+  converted.insert(geom, 0, mani, ps->memsize());
+  return mani;
+}
+
+namespace {
+
+std::atomic<size_t> conversion_counts[2][2];
+
+} // namespace
+
+void countConversion(Conversion conversion, bool reused)
+{
+  conversion_counts[static_cast<int>(conversion)][reused ? 1 : 0]++;
+}
+
+size_t conversionCount(Conversion conversion, bool reused)
+{
+  return conversion_counts[static_cast<int>(conversion)][reused ? 1 : 0];
+}
+
+void resetConversionStatistics()
+{
+  for (auto& counts : conversion_counts) {
+    for (auto& count : counts) count = 0;
+  }
+}
+
+void printConversionStatistics()
+{
+  LOG("Conversions to Manifold: %1$d, reused: %2$d",
+      conversionCount(Conversion::ToManifold, false), conversionCount(Conversion::ToManifold, true));
+  LOG("Conversions to PolySet: %1$d, reused: %2$d",
+      conversionCount(Conversion::ToPolySet, false), conversionCount(Conversion::ToPolySet, true));
 }
 
 Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons) {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <CGAL/Surface_mesh/Surface_mesh.h>
 
@@ -14,20 +16,30 @@ namespace ManifoldUtils {
   const char* statusToString(manifold::Manifold::Error status);
 
   std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps);
+  // Reuses the Manifold converted earlier from the same geom while geom is alive
   std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(const std::shared_ptr<const Geometry>& geom);
 
+  // Counters of conversions between PolySets and Manifolds, for the render statistics
+  enum class Conversion { ToManifold, ToPolySet };
+  void countConversion(Conversion conversion, bool reused);
+  size_t conversionCount(Conversion conversion, bool reused);
+  // Called when a render starts
+  void resetConversionStatistics();
+  void printConversionStatistics();
+
   template <class SurfaceMesh>
   std::shared_ptr<ManifoldGeometry> createManifoldFromSurfaceMesh(const SurfaceMesh& mesh);
   template <typename SurfaceMesh>
   std::shared_ptr<SurfaceMesh> createSurfaceMeshFromManifold(const manifold::Manifold& mani);
   
   std::shared_ptr<ManifoldGeometry> applyOperator3DManifold(const Geometry::Geometries& children, OpenSCADOperator op);
+  std::shared_ptr<ManifoldGeometry> createOffsetLevelSet(const std::shared_ptr<const PolySet>& ps, double delta, double resolution);
 
   Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons);
 
 #ifdef ENABLE_CGAL
   // FIXME: This shouldn't return const, but it does due to internal implementation details.
-  std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children);
+  std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children, const std::vector<std::string>& childIds = {});
 #endif
 
   std::unique_ptr<PolySet> createTriangulatedPolySetFromPolygon2d(const Polygon2d& polygon2d, bool in3d);
@@ -0,0 +1,231 @@
+#include "glview/PolySetPicker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "core/Selection.h"
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+#include "glview/cgal/CGALRenderUtils.h"
+
+namespace {
+
+constexpr uint32_t maxLeafFaces = 4;
+
+// Entry parameter of the ray into box grown by tolerance, or infinity if it misses
+double intersect(const BoundingBox& box, const Vector3d& origin, const Vector3d& inv_dir, double tolerance)
+{
+  double tmin = 0.0;
+  double tmax = 1.0;
+  for (int i = 0; i < 3; i++) {
+    const double lo = box.min()[i] - tolerance;
+    const double hi = box.max()[i] + tolerance;
+    if (std::isinf(inv_dir[i])) {
+      // Ray parallel to this slab
+      if (origin[i] < lo || origin[i] > hi) return std::numeric_limits<double>::infinity();
+      continue;
+    }
+    double t1 = (lo - origin[i]) * inv_dir[i];
+    double t2 = (hi - origin[i]) * inv_dir[i];
+    if (t1 > t2) std::swap(t1, t2);
+    tmin = std::max(tmin, t1);
+    tmax = std::min(tmax, t2);
+    if (tmin > tmax) return std::numeric_limits<double>::infinity();
+  }
+  return tmin;
+}
+
+} // namespace
+
+void PolySetPicker::add(const std::shared_ptr<const PolySet>& ps)
+{
+  if (!ps || ps->indices.empty()) return;
+  Mesh& mesh = meshes.emplace_back();
+  mesh.ps = ps;
+  std::vector<BoundingBox> boxes;
+  boxes.reserve(ps->indices.size());
+  for (const auto& face : ps->indices) {
+    BoundingBox box;
+    for (const auto ind : face) box.extend(ps->vertices[ind]);
+    boxes.push_back(box);
+  }
+  mesh.faces.resize(ps->indices.size());
+  std::iota(mesh.faces.begin(), mesh.faces.end(), 0);
+  mesh.nodes.reserve(2 * ps->indices.size() / maxLeafFaces + 1);
+  build(mesh, boxes, 0, mesh.faces.size());
+}
+
+/*!
+   Builds the subtree over mesh.faces[begin, end) by splitting at the median
+   face center along the longest axis. Returns the index of its root node.
+ */
+uint32_t PolySetPicker::build(Mesh& mesh, const std::vector<BoundingBox>& boxes, uint32_t begin, uint32_t end)
+{
+  const auto index = static_cast<uint32_t>(mesh.nodes.size());
+  mesh.nodes.push_back({BoundingBox(), begin, end - begin});
+  BoundingBox bbox;
+  for (uint32_t i = begin; i < end; i++) bbox.extend(boxes[mesh.faces[i]]);
+  mesh.nodes[index].bbox = bbox;
+  if (end - begin <= maxLeafFaces) return index;
+
+  int axis;
+  bbox.sizes().maxCoeff(&axis);
+  const uint32_t mid = begin + (end - begin) / 2;
+  std::nth_element(mesh.faces.begin() + begin, mesh.faces.begin() + mid, mesh.faces.begin() + end,
+                   [&](uint32_t a, uint32_t b) {
+    return boxes[a].center()[axis] < boxes[b].center()[axis];
+  });
+  // The first child directly follows its parent
+  build(mesh, boxes, begin, mid);
+  const uint32_t second = build(mesh, boxes, mid, end);
+  mesh.nodes[index].first = second;
+  mesh.nodes[index].count = 0;
+  return index;
+}
+
+/*!
+   Calls visitFace for every face in the leaves hit by the ray, nearest
+   nodes first. Nodes entered at or beyond best, the ray parameter of the
+   best hit so far, are skipped.
+ */
+template <typename F>
+void PolySetPicker::traverse(const Mesh& mesh, const Ray& ray, const double& best, F&& visitFace)
+{
+  std::vector<std::pair<double, uint32_t>> stack;
+  const double t = intersect(mesh.nodes[0].bbox, ray.origin, ray.inv_dir, ray.tolerance);
+  if (t < best) stack.emplace_back(t, 0);
+  while (!stack.empty()) {
+    const auto [tnode, index] = stack.back();
+    stack.pop_back();
+    if (tnode >= best) continue;
+    const Node& node = mesh.nodes[index];
+    if (node.count > 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) visitFace(mesh.faces[i]);
+      continue;
+    }
+    const uint32_t left = index + 1;
+    const uint32_t right = node.first;
+    const double tleft = intersect(mesh.nodes[left].bbox, ray.origin, ray.inv_dir, ray.tolerance);
+    const double tright = intersect(mesh.nodes[right].bbox, ray.origin, ray.inv_dir, ray.tolerance);
+    // Push the farther child first so the nearer one is visited first
+    if (tleft <= tright) {
+      if (tright < best) stack.emplace_back(tright, right);
+      if (tleft < best) stack.emplace_back(tleft, left);
+    } else {
+      if (tleft < best) stack.emplace_back(tleft, left);
+      if (tright < best) stack.emplace_back(tright, right);
+    }
+  }
+}
+
+std::shared_ptr<SelectedObject> PolySetPicker::pick(const Vector3d& near_pt, const Vector3d& far_pt, double tolerance) const
+{
+  Ray ray;
+  ray.origin = near_pt;
+  ray.dir = far_pt - near_pt;
+  ray.inv_dir = ray.dir.cwiseInverse();
+  ray.tolerance = tolerance;
+  const double length2 = ray.dir.squaredNorm();
+  if (length2 == 0) return nullptr;
+
+  // Vertices within tolerance of the ray, nearest to the viewer
+  double best = std::numeric_limits<double>::infinity();
+  Vector3d pt1_nearest;
+  int ind_nearest = -1;
+  for (const auto& mesh : meshes) {
+    const auto& vertices = mesh.ps->vertices;
+    traverse(mesh, ray, best, [&](uint32_t f) {
+      for (const auto ind : mesh.ps->indices[f]) {
+        const Vector3d& pt = vertices[ind];
+        const double t = std::clamp((pt - near_pt).dot(ray.dir) / length2, 0.0, 1.0);
+        if (t < best && (near_pt + ray.dir * t - pt).norm() < tolerance) {
+          best = t;
+          pt1_nearest = pt;
+          ind_nearest = ind;
+        }
+      }
+    });
+  }
+  if (ind_nearest >= 0) {
+    SelectedObject obj = {
+      .type = SelectionType::SELECTION_POINT,
+    };
+    obj.pt.push_back(pt1_nearest);
+    obj.ind = ind_nearest;
+    return std::make_shared<SelectedObject>(obj);
+  }
+
+  // Edges within tolerance of the ray, nearest to the viewer
+  Vector3d pt2_nearest;
+  for (const auto& mesh : meshes) {
+    const auto& vertices = mesh.ps->vertices;
+    traverse(mesh, ray, best, [&](uint32_t f) {
+      const auto& poly = mesh.ps->indices[f];
+      for (size_t i = 0; i < poly.size(); i++) {
+        const Vector3d& p1 = vertices[poly[i]];
+        const Vector3d& p2 = vertices[poly[(i + 1) % poly.size()]];
+        double dist_lat;
+        const double dist_norm = fabs(calculateLineLineDistance(p1, p2, near_pt, far_pt, dist_lat));
+        if (dist_lat < 0 || dist_lat > 1 || dist_norm >= tolerance) continue;
+        const double t = (p1 + (p2 - p1) * dist_lat - near_pt).dot(ray.dir) / length2;
+        if (t < best) {
+          best = t;
+          pt1_nearest = p1;
+          pt2_nearest = p2;
+        }
+      }
+    });
+  }
+  if (best < std::numeric_limits<double>::infinity()) {
+    SelectedObject obj = {
+      .type = SelectionType::SELECTION_SEGMENT,
+    };
+    obj.pt.push_back(pt1_nearest);
+    obj.pt.push_back(pt2_nearest);
+    return std::make_shared<SelectedObject>(obj);
+  }
+
+  // Faces hit by the ray, nearest to the viewer
+  std::vector<Vector3d> pts_nearest;
+  ray.tolerance = 0.0;
+  const Vector3d v1 = near_pt - far_pt;
+  for (const auto& mesh : meshes) {
+    const auto& vertices = mesh.ps->vertices;
+    traverse(mesh, ray, best, [&](uint32_t f) {
+      const auto& poly = mesh.ps->indices[f];
+      if (poly.size() < 3) return;
+      // assume polygon is convex
+      for (size_t i = 0; i < poly.size() - 2; i++) {
+        const Vector3d& p1 = vertices[poly[0]];
+        const Vector3d v2 = vertices[poly[i + 1]] - p1;
+        const Vector3d v3 = vertices[poly[i + 2]] - p1;
+        Vector3d res;
+        if (linsystem(v1, v2, v3, far_pt - p1, res, nullptr)) continue;
+        if (res[0] > 0) continue;
+        if (res[1] < 0 || res[2] < 0) continue;
+        if (res[1] + res[2] > 1) continue;
+        // The hit point is far_pt + res[0] * (far_pt - near_pt)
+        const double t = 1.0 + res[0];
+        if (t < best) {
+          best = t;
+          pts_nearest.clear();
+          for (const auto ind : poly) pts_nearest.push_back(vertices[ind]);
+        }
+      }
+    });
+  }
+  if (!pts_nearest.empty()) {
+    SelectedObject obj = {
+      .type = SelectionType::SELECTION_FACE,
+    };
+    obj.pt = pts_nearest;
+    return std::make_shared<SelectedObject>(obj);
+  }
+  return nullptr;
+}
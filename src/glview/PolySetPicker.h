@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/Selection.h"
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+/*
+ * Finds the vertex, edge or face of rendered PolySets under the mouse.
+ *
+ * Each PolySet gets a bounding volume hierarchy over its faces when it is
+ * added, so a pick only tests the few faces near the pick ray instead of
+ * the whole model. Renderers build their picker on the first pick and keep
+ * it for as long as they show the same geometry.
+ */
+class PolySetPicker
+{
+public:
+  void add(const std::shared_ptr<const PolySet>& ps);
+  [[nodiscard]] bool empty() const { return meshes.empty(); }
+
+  // Picks along the segment from near_pt to far_pt. Vertices take precedence
+  // over edges, and edges over faces; tolerance is the pick radius for
+  // vertices and edges.
+  [[nodiscard]] std::shared_ptr<SelectedObject> pick(const Vector3d& near_pt, const Vector3d& far_pt, double tolerance) const;
+
+private:
+  struct Node {
+    BoundingBox bbox;
+    uint32_t first; // leaf: first entry in faces; inner node: index of the second child
+    uint32_t count; // number of faces in a leaf, 0 for inner nodes
+  };
+  struct Mesh {
+    std::shared_ptr<const PolySet> ps;
+    std::vector<uint32_t> faces; // face indices ordered by leaf
+    std::vector<Node> nodes;
+  };
+  struct Ray {
+    Vector3d origin;
+    Vector3d dir; // far_pt - near_pt, parameters along the ray are in [0, 1]
+    Vector3d inv_dir;
+    double tolerance;
+  };
+
+  uint32_t build(Mesh& mesh, const std::vector<BoundingBox>& boxes, uint32_t begin, uint32_t end);
+  template <typename F>
+  static void traverse(const Mesh& mesh, const Ray& ray, const double& best, F&& visitFace);
+
+  std::vector<Mesh> meshes;
+};
@@ -10,6 +10,7 @@
 #include "geometry/Polygon2d.h"
 #include "geometry/PolySet.h"
 #include "glview/ColorMap.h"
+#include "glview/PolySetPicker.h"
 #include "glview/ShaderUtils.h"
 #include "glview/VertexState.h"
 #include "glview/VBORenderer.h"
@@ -40,4 +41,7 @@ private:
 
   std::vector<VertexStateContainer> polyset_vertex_state_containers_;
   std::vector<VertexStateContainer> polygon_vertex_state_containers_;
+
+  // Built on the first pick
+  std::unique_ptr<PolySetPicker> picker_;
 };
@@ -40,11 +40,13 @@
 #include "geometry/GeometryEvaluator.h"
 #include "core/Selection.h"
 #include "geometry/cgal/cgal.h"
+#include "geometry/cgal/cgalutils.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "geometry/PolySet.h"
 #include "geometry/PolySetUtils.h"
 #include "glview/ColorMap.h"
+#include "glview/PolySetPicker.h"
 #include "glview/Renderer.h"
 #include "glview/ShaderUtils.h"
 #include "glview/system-gl.h"
@@ -318,3 +320,19 @@ BoundingBox CGALRenderer::getBoundingBox() const {
   }
   return bbox;
 }
+
+std::shared_ptr<SelectedObject>
+CGALRenderer::findModelObject(const Vector3d &near_pt, const Vector3d &far_pt, int /*mouse_x*/,
+                              int /*mouse_y*/, double tolerance) {
+  if (!this->picker_) {
+    this->picker_ = std::make_unique<PolySetPicker>();
+    for (const auto &ps : this->polysets_) this->picker_->add(ps);
+    for (const auto &[polygon, ps] : this->polygons_) this->picker_->add(ps);
+#ifdef ENABLE_CGAL
+    for (const auto &N : this->nefPolyhedrons_) {
+      this->picker_->add(CGALUtils::createPolySetFromNefPolyhedron3(*N->p3));
+    }
+#endif
+  }
+  return this->picker_->pick(near_pt, far_pt, tolerance);
+}
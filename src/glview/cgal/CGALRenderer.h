@@ -11,6 +11,7 @@
 #include "glview/ShaderUtils.h"
 #include "glview/ColorMap.h"
 #include "glview/VertexState.h"
+#include "glview/PolySetPicker.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
 #endif
@@ -24,6 +25,7 @@ public:
   void draw(bool showedges, const ShaderUtils::ShaderInfo *shaderinfo = nullptr) const override;
   void setColorScheme(const ColorScheme& cs) override;
   BoundingBox getBoundingBox() const override;
+  std::shared_ptr<SelectedObject> findModelObject(const Vector3d& near_pt, const Vector3d& far_pt, int mouse_x, int mouse_y, double tolerance) override;
 
 private:
   void addGeometry(const std::shared_ptr<const class Geometry>& geom);
@@ -47,4 +49,7 @@ private:
 #endif
 
   std::vector<VertexStateContainer> vertex_state_containers_;
+
+  // Built on the first pick
+  std::unique_ptr<PolySetPicker> picker_;
 };
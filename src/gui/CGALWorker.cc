@@ -43,9 +43,8 @@ void CGALWorker::start(const Tree& tree)
 void CGALWorker::work()
 {
   // this is a worker thread: we don't want any exceptions escaping and crashing the app.
-#ifdef ENABLE_PYTHON
-  python_lock();
-#endif
+  // The GIL is not held here, Python callbacks from the geometry kernels
+  // acquire it themselves.
   std::shared_ptr<const Geometry> root_geom;
   try {
     GeometryEvaluator evaluator(*this->tree);
@@ -69,9 +68,6 @@ void CGALWorker::work()
   } catch (...) {
     LOG(message_group::Error, "Rendering cancelled by unknown exception.");
   }
- #ifdef ENABLE_PYTHON
-  python_unlock();
- #endif
   emit done(root_geom);
   thread->quit();
 }
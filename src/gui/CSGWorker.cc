@@ -41,7 +41,7 @@ void CSGWorker::work()
 {
   // this is a worker thread: we don't want any exceptions escaping and crashing the app.
 #ifdef ENABLE_PYTHON
-  python_lock();
+  python_thread_lock();
 #endif
   try {
     main->compileCSGThread();
@@ -55,7 +55,7 @@ void CSGWorker::work()
     LOG(message_group::Error, "Compilation cancelled by unknown exception.");
   }
  #ifdef ENABLE_PYTHON
-   python_unlock();
+   python_thread_unlock();
  #endif
 
   emit done();
@@ -0,0 +1,116 @@
+#include "gui/InstantiateWorker.h"
+
+#include <QThread>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "core/BuiltinContext.h"
+#include "core/EvaluationSession.h"
+#include "core/SourceFile.h"
+#include "core/node.h"
+#include "core/progress.h"
+#include "platform/PlatformUtils.h"
+#include "utils/exceptions.h"
+#include "utils/StackCheck.h"
+
+#ifdef ENABLE_PYTHON
+#include "python/python_public.h"
+#endif
+
+InstantiateWorker::InstantiateWorker()
+{
+  this->thread = new QThread();
+  // Deeply recursive designs need the same stack StackCheck allows on the main thread
+  this->thread->setStackSize(static_cast<uint>(PlatformUtils::stackLimit() + STACK_BUFFER_SIZE));
+  connect(this->thread, &QThread::started, this, &InstantiateWorker::work);
+  moveToThread(this->thread);
+}
+
+InstantiateWorker::~InstantiateWorker()
+{
+  cancel();
+  wait();
+  delete this->thread;
+}
+
+void InstantiateWorker::start(SourceFile *file, const std::string& documentRoot, const RenderVariables& variables)
+{
+  this->file = file;
+  this->documentRoot = documentRoot;
+  this->variables = variables;
+  this->root.reset();
+  this->camera = variables.camera;
+  this->cameraChanged = false;
+  this->status = Status::Done;
+  this->error.clear();
+  this->cancelled = false;
+#ifdef ENABLE_PYTHON
+  python_unlock();
+#endif
+  this->thread->start();
+}
+
+void InstantiateWorker::cancel()
+{
+  if (isRunning()) this->cancelled = true;
+}
+
+void InstantiateWorker::wait()
+{
+  this->thread->wait();
+}
+
+bool InstantiateWorker::isRunning() const
+{
+  return this->thread->isRunning();
+}
+
+void InstantiateWorker::work()
+{
+  // Evaluation uses global state (node indices, the output handler), so
+  // instantiations of several windows must not overlap.
+  static std::mutex instantiate_mutex;
+  const std::lock_guard<std::mutex> lock(instantiate_mutex);
+  StackCheck::inst(); // measure recursion depth from here
+
+  // this is a worker thread: we don't want any exceptions escaping and crashing the app.
+#ifdef ENABLE_PYTHON
+  python_thread_lock();
+#endif
+  try {
+    AbstractNode::resetIndexCounter();
+
+    EvaluationSession session{this->documentRoot};
+    session.setCancelFlag(&this->cancelled);
+    ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
+    this->variables.applyToContext(builtin_context);
+
+    std::shared_ptr<const FileContext> file_context;
+    this->root = this->file->instantiate(*builtin_context, &file_context);
+    if (file_context) {
+      // The file context does not outlive the session, so look at it here
+      for (const char *name : {"$vpr", "$vpt", "$vpd", "$vpf"}) {
+        if (file_context->lookup_local_variable(name)) this->cameraChanged = true;
+      }
+      if (this->cameraChanged) this->camera.updateView(file_context, false);
+    }
+  } catch (const ProgressCancelException& e) {
+    this->status = Status::Cancelled;
+  } catch (const HardWarningException& e) {
+    this->status = Status::HardWarning;
+  } catch (const std::exception& e) {
+    this->status = Status::Exception;
+    this->error = e.what();
+  } catch (...) {
+    this->status = Status::Exception;
+  }
+  if (this->status != Status::Done) this->root.reset();
+#ifdef ENABLE_PYTHON
+  python_thread_unlock();
+#endif
+
+  emit done();
+  thread->quit();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QObject>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "core/RenderVariables.h"
+
+class AbstractNode;
+class SourceFile;
+
+/*
+ * Instantiates the node tree of a parsed SourceFile on a worker thread, so
+ * the GUI stays responsive while large designs are evaluated. The running
+ * instantiation can be cancelled, it then stops at the next module or
+ * function call. done() is emitted in either case.
+ */
+class InstantiateWorker : public QObject
+{
+  Q_OBJECT;
+public:
+  InstantiateWorker();
+  ~InstantiateWorker() override;
+
+  void start(SourceFile *file, const std::string& documentRoot, const RenderVariables& variables);
+  void cancel();
+  void wait();
+  [[nodiscard]] bool isRunning() const;
+
+  enum class Status { Done, Cancelled, HardWarning, Exception };
+
+  // Results, valid once done() was emitted
+  Status status{Status::Done};
+  std::string error; // exception message for Status::Exception
+  std::shared_ptr<AbstractNode> root;
+  Camera camera; // the start camera, updated by $vpr etc. of the file
+  bool cameraChanged{false};
+
+protected slots:
+  void work();
+
+signals:
+  void done();
+
+protected:
+  class QThread *thread;
+  SourceFile *file{nullptr};
+  std::string documentRoot;
+  RenderVariables variables;
+  std::atomic<bool> cancelled{false}; // cancel flag of this worker's evaluation session
+};
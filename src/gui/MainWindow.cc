@@ -101,6 +101,7 @@
 #include "core/EvaluationSession.h"
 #include "core/Expression.h"
 #include "core/node.h"
+#include "core/ParseCache.h"
 #include "core/parsersettings.h"
 #include "core/progress.h"
 #include "core/RenderVariables.h"
@@ -152,6 +153,7 @@
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgal.h"
 #include "geometry/cgal/CGALCache.h"
+#include "geometry/cgal/ConvexDecompositionCache.h"
 #include "geometry/cgal/CGALNefGeometry.h"
 #endif // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
@@ -233,6 +235,7 @@ int curl_download(std::string url, std::string path)
 
 #include <boost/regex.hpp>
 #include "gui/CSGWorker.h"
+#include "gui/InstantiateWorker.h"
 
 #include "gui/LoadShareDesignDialog.h"
 #include "gui/ShareDesignDialog.h"
@@ -474,6 +477,8 @@ MainWindow::MainWindow(const QStringList& filenames) :
   this->csgworker = new CSGWorker(this);
   connect(this->csgworker, SIGNAL(done(void)),
           this, SLOT(compileCSGDone(void)));
+  this->instantiateworker = new InstantiateWorker();
+  connect(this->instantiateworker, &InstantiateWorker::done, this, &MainWindow::instantiateWorkerDone);
 
   // Open Recent
   for (auto& recent : this->actionRecentFile) {
@@ -1380,6 +1385,8 @@ void MainWindow::updateReorderMode(bool reorderMode)
 
 MainWindow::~MainWindow()
 {
+  // Stops a running instantiation, which still uses the parsed file
+  delete this->instantiateworker;
   // If root_file is not null then it will be the same as parsed_file,
   // so no need to delete it.
   delete parsedFile;
@@ -1601,17 +1608,14 @@ void MainWindow::compileDone(bool didchange)
 {
   OpenSCAD::hardwarnings = GlobalPreferences::inst()->getValue("advanced/enableHardwarnings").toBool();
   try{
-    const char *callslot;
     if (didchange) {
+      // Continues in instantiateRootDone()
       instantiateRoot();
-      updateCompileResult();
-      callslot = afterCompileSlot;
-    } else {
-      callslot = "compileEnded";
+      return;
     }
 
     this->procevents = false;
-    QMetaObject::invokeMethod(this, callslot);
+    QMetaObject::invokeMethod(this, "compileEnded");
   } catch (const HardWarningException&) {
     exceptionCleanup();
   }
@@ -1643,21 +1647,15 @@ std::shared_ptr<AbstractNode> MainWindow::instantiateRootFromSource(SourceFile*
 
 void MainWindow::instantiateRoot()
 {
-  // Go on and instantiate root_node, then call the continuation slot
-
-  // Invalidate renderers before we kill the CSG tree
-  this->qglview->setRenderer(nullptr);
-#ifdef ENABLE_OPENCSG
-  this->previewRenderer = nullptr;
-#endif
-  this->thrownTogetherRenderer = nullptr;
+  // Go on and instantiate root_node on the worker thread, which calls
+  // instantiateRootDone() when finished. The previous preview stays
+  // visible until then.
 
   // Remove previous CSG tree
   this->absoluteRootNode.reset();
 
   this->csgRoot.reset();
   this->normalizedRoot.reset();
-  this->rootProduct.reset();
 
   this->rootNode.reset();
   this->tree.setRoot(nullptr);
@@ -1672,36 +1670,78 @@ void MainWindow::instantiateRoot()
     LOG("Compiling design (CSG Tree generation)...");
     this->processEvents();
 
-    AbstractNode::resetIndexCounter();
-
-    EvaluationSession session{doc.parent_path().string()};
-    ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
-    setRenderVariables(builtin_context);
-
-    std::shared_ptr<const FileContext> file_context;
 #ifdef ENABLE_PYTHON
-    if (genlang_result_node != NULL && language != LANG_SCAD) this->absoluteRootNode = genlang_result_node;
-    else
+    if (genlang_result_node != NULL && language != LANG_SCAD) {
+      AbstractNode::resetIndexCounter();
+      this->absoluteRootNode = genlang_result_node;
+    } else
 #endif
-    this->absoluteRootNode = this->rootFile->instantiate(*builtin_context, &file_context);
-    if (file_context) {
-      this->qglview->cam.updateView(file_context, false);
-      viewportControlWidget->cameraChanged();
+    {
+      const RenderVariables r = {
+        .preview = this->isPreview,
+        .time = this->animateWidget->getAnimTval(),
+        .camera = qglview->cam,
+      };
+      this->instantiateworker->start(this->rootFile, doc.parent_path().string(), r);
+      return;
     }
+  }
+  instantiateRootDone();
+}
 
-    if (this->absoluteRootNode) {
-      // Do we have an explicit root node (! modifier)?
-      const Location *nextLocation = nullptr;
-      if (!(this->rootNode = find_root_tag(this->absoluteRootNode, &nextLocation))) {
-        this->rootNode = this->absoluteRootNode;
-      }
-      if (nextLocation) {
-//        LOG(message_group::NONE, *nextLocation, builtin_context->documentRoot(), "More than one Root Modifier (!)"); TODO activate
-      }
+void MainWindow::instantiateWorkerDone()
+{
+#ifdef ENABLE_PYTHON
+  python_lock();
+#endif
+  auto worker = this->instantiateworker;
+  switch (worker->status) {
+  case InstantiateWorker::Status::Cancelled:
+    LOG("Compilation cancelled.");
+    LOG(" ");
+    this->procevents = false;
+    compileEnded();
+    return;
+  case InstantiateWorker::Status::HardWarning:
+    exceptionCleanup();
+    return;
+  case InstantiateWorker::Status::Exception:
+    UnknownExceptionCleanup(worker->error);
+    return;
+  case InstantiateWorker::Status::Done:
+    break;
+  }
 
-      // FIXME: Consider giving away ownership of root_node to the Tree, or use reference counted pointers
-      this->tree.setRoot(this->rootNode);
+  this->absoluteRootNode = std::move(worker->root);
+  if (worker->cameraChanged) {
+    this->qglview->cam = worker->camera;
+    viewportControlWidget->cameraChanged();
+  }
+  instantiateRootDone();
+}
+
+void MainWindow::instantiateRootDone()
+{
+  // Invalidate renderers before we kill the CSG tree
+  this->qglview->setRenderer(nullptr);
+#ifdef ENABLE_OPENCSG
+  this->previewRenderer = nullptr;
+#endif
+  this->thrownTogetherRenderer = nullptr;
+  this->rootProduct.reset();
+
+  if (this->absoluteRootNode) {
+    // Do we have an explicit root node (! modifier)?
+    const Location *nextLocation = nullptr;
+    if (!(this->rootNode = find_root_tag(this->absoluteRootNode, &nextLocation))) {
+      this->rootNode = this->absoluteRootNode;
     }
+    if (nextLocation) {
+//        LOG(message_group::NONE, *nextLocation, builtin_context->documentRoot(), "More than one Root Modifier (!)"); TODO activate
+    }
+
+    // FIXME: Consider giving away ownership of root_node to the Tree, or use reference counted pointers
+    this->tree.setRoot(this->rootNode);
   }
 
   if (!this->rootNode) {
@@ -1713,6 +1753,10 @@ void MainWindow::instantiateRoot()
     LOG(" ");
     this->processEvents();
   }
+
+  updateCompileResult();
+  this->procevents = false;
+  QMetaObject::invokeMethod(this, afterCompileSlot);
 }
 
 /*!
@@ -1750,6 +1794,16 @@ void MainWindow::compileCSGThread(void)
     else return;
     try {
 #ifdef ENABLE_OPENCSG
+      // Show top level objects as they complete, normalizing them here to keep the GUI thread free
+      if (rootNode->children.size() > 1) {
+        const size_t normalizelimit = 2ul * GlobalPreferences::inst()->getValue("advanced/openCSGLimit").toUInt();
+        this->csgrenderer->setPartialResultCallback([this, normalizelimit](const std::shared_ptr<CSGNode>& term) {
+          CSGTreeNormalizer normalizer(normalizelimit);
+          if (auto nterm = normalizer.normalize(term)) {
+            QMetaObject::invokeMethod(this, [this, nterm]() { csgPartialResult(nterm); }, Qt::QueuedConnection);
+          }
+        });
+      }
       this->processEvents();
       this->csgRoot = this->csgrenderer->buildCSGTree(*rootNode);
 #endif
@@ -1760,11 +1814,44 @@ void MainWindow::compileCSGThread(void)
     } catch (const HardWarningException&) {
       LOG("CSG generation cancelled due to hardwarning being enabled.");
     }
+#ifdef ENABLE_OPENCSG
+    // The callback captures this, so don't keep it beyond this evaluation
+    this->csgrenderer->setPartialResultCallback({});
+#endif
+}
+void MainWindow::csgPartialResult(const std::shared_ptr<CSGNode>& term)
+{
+  this->partialTerms.push_back(term);
+  // Rebuilding the preview is not free, so limit it to 5 updates per second
+  if (this->partialTimer.isValid() && !this->partialTimer.hasExpired(200)) return;
+  this->partialTimer.start();
+
+  // The renderers prepare their products once, so every update gets fresh ones
+  auto products = std::make_shared<CSGProducts>();
+  for (const auto& t : this->partialTerms) products->import(t);
+  this->thrownTogetherRenderer = std::make_shared<ThrownTogetherRenderer>(products, nullptr, nullptr);
+#ifdef ENABLE_OPENCSG
+  this->previewRenderer = nullptr;
+  if (!viewActionThrownTogether->isChecked() && this->qglview->hasOpenCSGSupport() &&
+      products->size() <= GlobalPreferences::inst()->getValue("advanced/openCSGLimit").toUInt()) {
+    this->previewRenderer = std::make_shared<OpenCSGRenderer>(products, nullptr, nullptr);
+  }
+  this->qglview->setRenderer(this->previewRenderer ? this->previewRenderer : this->thrownTogetherRenderer);
+#else
+  this->qglview->setRenderer(this->thrownTogetherRenderer);
+#endif
+  this->qglview->update();
 }
+
 void MainWindow::compileCSGDone()
 {
 #ifdef ENABLE_PYTHON
   python_lock();	
+#endif
+  this->partialTerms.clear();
+  this->partialTimer.invalidate();
+#ifdef ENABLE_OPENCSG
+  this->previewRenderer = nullptr; // may still show partial results
 #endif
   try{
     progress_report_fin();
@@ -2515,7 +2602,7 @@ SourceFile *MainWindow::parseDocument(EditorInterface *editor)
 #endif // ifdef ENABLE_PYTHON
 {
 
-  sourceFile = parse(sourceFile, fulltext, fname, fname, false) ? sourceFile : nullptr;
+  sourceFile = ParseCache::instance()->parse(sourceFile, fulltext, fname, fname) ? sourceFile : nullptr;
 
   editor->resetHighlighting();
   if (sourceFile) {
@@ -3611,6 +3698,7 @@ void MainWindow::actionFlushCaches()
 {
   GeometryCache::instance()->clear();
   CGALCache::instance()->clear();
+  ConvexDecompositionCache::instance()->clear();
   dxf_dim_cache.clear();
   dxf_cross_cache.clear();
   SourceFileCache::instance()->clear();
@@ -3714,6 +3802,8 @@ void MainWindow::editorContentChanged()
 
   auto current_doc = activeEditor->toPlainText();
   if (current_doc != lastCompiledDoc) {
+    // The running instantiation is outdated, stop it instead of making the user wait for it
+    if (activeEditor == renderedEditor) this->instantiateworker->cancel();
     animateWidget->editorContentChanged();
 
     // removes the live selection feedbacks in both the 3d view and editor.
@@ -4203,6 +4293,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
 {
   if (tabManager->shouldClose()) {
     isClosing = true;
+    this->instantiateworker->cancel();
     progress_report_fin();
     // Disable invokeMethod calls for consoleOutput during shutdown,
     // otherwise will segfault if echos are in progress.
@@ -44,6 +44,7 @@ Q_IMPORT_PLUGIN(QSvgPlugin)
 class BuiltinContext;
 class CGALWorker;
 class CSGWorker;
+class InstantiateWorker;
 class CSGNode;
 class CSGProducts;
 class FontListDialog;
@@ -237,6 +238,7 @@ public slots:
   void updateRecentFileActions();
   void handleFileDrop(const QUrl& url);
   void compileCSGDone();
+  void csgPartialResult(const std::shared_ptr<CSGNode>& term);
 
 private slots:
   void actionOpen();
@@ -258,6 +260,8 @@ private slots:
   void copyText();
 
   void instantiateRoot();
+  void instantiateWorkerDone();
+  void instantiateRootDone();
   void compileDone(bool didchange);
   void compileEnded();
   void changeParameterWidget();
@@ -428,6 +432,8 @@ private:
   std::shared_ptr<CSGProducts> rootProduct;
   std::shared_ptr<CSGProducts> highlightsProducts;
   std::shared_ptr<CSGProducts> backgroundProducts;
+  std::vector<std::shared_ptr<CSGNode>> partialTerms; // top level terms finished so far by compileCSGThread()
+  QElapsedTimer partialTimer; // throttles preview updates from partialTerms
   int currentlySelectedObject {-1};
 
   char const *afterCompileSlot;
@@ -436,6 +442,7 @@ private:
   ProgressWidget *progresswidget{nullptr};
   CGALWorker *cgalworker;
   CSGWorker *csgworker;
+  InstantiateWorker *instantiateworker;
   QMutex consolemutex;
   DragResult dragResult;
   EditorInterface *renderedEditor; // stores pointer to editor which has been most recently rendered
@@ -30,13 +30,18 @@
 #include <io.h>
 #include <fcntl.h>
 #endif
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <clocale>
 #include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
 #include <ios>
 #include <iostream>
@@ -49,6 +54,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -85,7 +91,9 @@
 #include "core/customizer/ParameterSet.h"
 #include "core/EvaluationSession.h"
 #include "core/node.h"
+#include "core/ParseCache.h"
 #include "core/parsersettings.h"
+#include "core/Profiler.h"
 #include "core/RenderVariables.h"
 #include "core/ScopeContext.h"
 #include "core/Settings.h"
@@ -94,11 +102,15 @@
 #include "geometry/GeometryEvaluator.h"
 #include "geometry/GeometryUtils.h"
 #include "geometry/PolySet.h"
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGALNefGeometry.h"
+#endif
 #include "glview/Camera.h"
 #include "glview/ColorMap.h"
 #include "glview/OffscreenView.h"
 #include "glview/RenderSettings.h"
 #include "handle_dep.h"
+#include "json/json.hpp"
 #include "io/export.h"
 #include "LibraryInfo.h"
 #include "openscad_gui.h"
@@ -144,9 +156,13 @@ public:
   }
   ~Echostream() {
     if (fstream.is_open()) fstream.close();
+    // Hand output back, the process may go on to run further jobs (--server)
+    set_output_handler(previous_handler, nullptr, previous_data);
   }
 
 private:
+  OutputHandlerFunc *previous_handler = outputhandler;
+  void *previous_data = outputhandler_data;
   std::ofstream fstream;
   std::ostream& stream;
 };
@@ -157,6 +173,12 @@ struct AnimateArgs {
   unsigned shard = 1;
 };
 
+// Share of a batch of frames or parameter sets handled by one worker process (see run_workers())
+struct WorkerArgs {
+  unsigned num_workers = 1;
+  unsigned worker = 1;
+};
+
 struct CommandLine
 {
   const bool is_stdin;
@@ -165,12 +187,13 @@ struct CommandLine
   std::string output_file;
   const fs::path& original_path;
   const std::string& parameterFile;
-  const std::string& setName;
+  const std::vector<std::string>& setNames; // "*" selects all sets
   const ViewOptions& viewOptions;
   const Camera& camera;
   const boost::optional<FileFormat> export_format;
   const CmdLineExportOptions& exportOptions;
   const AnimateArgs animate;
+  const WorkerArgs worker;
   const std::vector<std::string> summaryOptions;
   const std::string summaryFile;
 };
@@ -196,8 +219,7 @@ bool useGUI()
 }
 #endif // OPENSCAD_NOGUI
 
-bool checkAndExport(const std::shared_ptr<const Geometry>& root_geom, unsigned dimensions,
-                    ExportInfo& exportInfo, const bool is_stdout, const std::string& filename)
+bool checkExportable(const std::shared_ptr<const Geometry>& root_geom, unsigned dimensions)
 {
   if (root_geom->getDimension() != dimensions) {
     LOG("Current top level object is not a %1$dD object.", dimensions);
@@ -207,6 +229,15 @@ bool checkAndExport(const std::shared_ptr<const Geometry>& root_geom, unsigned d
     LOG("Current top level object is empty.");
     return false;
   }
+  return true;
+}
+
+bool checkAndExport(const std::shared_ptr<const Geometry>& root_geom, unsigned dimensions,
+                    ExportInfo& exportInfo, const bool is_stdout, const std::string& filename)
+{
+  if (!checkExportable(root_geom, dimensions)) {
+    return false;
+  }
 
   if (is_stdout) {
     exportFileStdOut(root_geom, exportInfo);
@@ -288,34 +319,55 @@ bool with_output(const bool is_stdout, const std::string& filename, const F& f,
   }
 }
 
+// Parses <part>/<num_parts> as given to --animate_sharding
+void get_share(const po::variables_map& vm, const std::string& option, unsigned& part, unsigned& num_parts)
+{
+  std::vector<std::string> strs;
+  boost::split(strs, vm[option].as<std::string>(),
+               boost::is_any_of("/"));
+  if (strs.size() != 2) {
+    LOG("--%1$s requires <shard>/<num_shards>", option);
+    exit(1);
+  }
+  try {
+    part = boost::lexical_cast<unsigned>(strs[0]);
+    num_parts = boost::lexical_cast<unsigned>(strs[1]);
+  } catch (const boost::bad_lexical_cast&) {
+    LOG("--%1$s parameters need to be positive integers", option);
+    exit(1);
+  }
+  if (part > num_parts || part == 0) {
+    LOG("--%1$s: shard needs to be in range <1..num_shards>", option);
+    exit(1);
+  }
+}
+
 AnimateArgs get_animate(const po::variables_map& vm) {
   AnimateArgs animate;
   if (vm.count("animate")) {
     animate.frames = vm["animate"].as<unsigned>();
   }
   if (vm.count("animate_sharding")) {
-    std::vector<std::string> strs;
-    boost::split(strs, vm["animate_sharding"].as<std::string>(),
-                 boost::is_any_of("/"));
-    if (strs.size() != 2) {
-      LOG("--animate_sharding requires <shard>/<num_shards>");
-      exit(1);
-    }
-    try {
-      animate.shard = boost::lexical_cast<unsigned>(strs[0]);
-      animate.num_shards = boost::lexical_cast<unsigned>(strs[1]);
-    } catch (const boost::bad_lexical_cast&) {
-      LOG("--animate_sharding parameters need to be positive integers");
-      exit(1);
-    }
-    if (animate.shard > animate.num_shards || animate.shard == 0) {
-      LOG("--animate_sharding: shard needs to be in range <1..num_shards>");
-      exit(1);
-    }
+    get_share(vm, "animate_sharding", animate.shard, animate.num_shards);
   }
   return animate;
 }
 
+WorkerArgs get_worker(const po::variables_map& vm) {
+  WorkerArgs worker;
+  if (vm.count("batch-worker")) {
+    get_share(vm, "batch-worker", worker.worker, worker.num_workers);
+  }
+  return worker;
+}
+
+// First and end index of the items in part of num_parts equal parts of [begin, end)
+std::pair<unsigned, unsigned> share(unsigned begin, unsigned end, unsigned part, unsigned num_parts)
+{
+  const unsigned count = end - begin;
+  return {begin + ((part - 1) * count) / num_parts, begin + (part * count) / num_parts};
+}
+
 Camera get_camera(const po::variables_map& vm)
 {
   Camera camera;
@@ -383,7 +435,86 @@ Camera get_camera(const po::variables_map& vm)
   return camera;
 }
 
-int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format, SourceFile *root_file)
+/*
+   Writes animation frames on worker threads while the main thread evaluates
+   the following frames. Frames of one process are evaluated one after the
+   other, sharing the geometry caches; run_workers() spreads evaluation over
+   several processes.
+ */
+class FrameExporter
+{
+public:
+  FrameExporter() : limit(getenv("OPENSCAD_NO_PARALLEL") ? 0 : std::max(1u, std::thread::hardware_concurrency())) {}
+  ~FrameExporter() {
+    try {
+      finish();
+    } catch (const std::exception& e) {
+      LOG(message_group::Error, "Frame export failed: %1$s", e.what());
+    }
+  }
+
+  // Runs job in the background, waiting for the oldest job if too many are in flight.
+  // The job returns false on failure.
+  void add(std::function<bool()> job) {
+    if (limit == 0) {
+      if (!job()) failed = true;
+      return;
+    }
+    if (pending.size() >= limit) pop();
+    pending.push_back(std::async(std::launch::async, std::move(job)));
+  }
+  // Waits for all jobs, then rethrows the first exception of any of them.
+  // Returns false if any job failed.
+  bool finish() {
+    std::exception_ptr error;
+    while (!pending.empty()) {
+      try {
+        pop();
+      } catch (...) {
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+    const bool ok = !failed;
+    failed = false;
+    return ok;
+  }
+
+  // A copy of geom for a background job to read while the main thread goes
+  // on evaluating, as cached geometry computes some of its data lazily.
+  // Returns nullptr if geom can't be read concurrently at all.
+  static std::shared_ptr<const Geometry> snapshot(const std::shared_ptr<const Geometry>& geom) {
+    if (!geom) return nullptr;
+    if (const auto list = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+      Geometry::Geometries children;
+      for (const auto& [node, child] : list->getChildren()) {
+        auto copy = snapshot(child);
+        if (child && !copy) return nullptr;
+        children.emplace_back(node, copy);
+      }
+      return std::make_shared<GeometryList>(children);
+    }
+#ifdef ENABLE_CGAL
+    // The lazy exact kernel is not thread safe, even for copies sharing the polyhedron
+    if (std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) return nullptr;
+#endif
+    return geom->copy();
+  }
+
+private:
+  void pop() {
+    auto job = std::move(pending.front());
+    pending.pop_front();
+    if (!job.get()) failed = true;
+  }
+
+  unsigned int limit;
+  std::deque<std::future<bool>> pending;
+  bool failed{false};
+};
+
+int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format, SourceFile *root_file,
+              FrameExporter *frameExporter = nullptr)
 {
   auto filename_str = fs::path(cmd.output_file).generic_string();
   // Avoid possibility of fs::absolute throwing when passed an empty path
@@ -410,7 +541,10 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     absolute_root_node = genlang_result_node;
   } else {
 #endif	    
-  absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
+  {
+    const Profiler::Scope profile("phase", "instantiate", "");
+    absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
+  }
 #ifdef ENABLE_PYTHON
   }
 #endif
@@ -482,7 +616,10 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       // FIXME: Consider adding MANIFOLD as a valid --render argument and ViewOption, to be able to distinguish from CGAL
 
       constexpr bool allownef = true;
-      root_geom = geomevaluator.evaluateGeometry(*tree.root(), allownef);
+      {
+        const Profiler::Scope profile("phase", "render", "");
+        root_geom = geomevaluator.evaluateGeometry(*tree.root(), allownef);
+      }
       if (!root_geom) root_geom = std::make_shared<PolySet>(3);
       if (cmd.viewOptions.renderer == RenderType::BACKEND_SPECIFIC && root_geom->getDimension() == 3) {
         if (auto geomlist = std::dynamic_pointer_cast<const GeometryList>(root_geom)) {
@@ -504,7 +641,16 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     const std::string input_filename = cmd.is_stdin ? "<stdin>" : cmd.filename;
     const int dim = fileformat::is3D(export_format) ? 3 : fileformat::is2D(export_format) ? 2 : 0;
     ExportInfo exportInfo = createExportInfo(export_format, fileformat::info(export_format), input_filename, &cmd.camera, cmd.exportOptions);
-    if (dim > 0 && !checkAndExport(root_geom, dim, exportInfo, cmd.is_stdout, filename_str)) {
+    std::shared_ptr<const Geometry> frame_geom;
+    if (dim > 0 && frameExporter && !cmd.is_stdout) frame_geom = FrameExporter::snapshot(root_geom);
+    if (frame_geom) {
+      if (!checkExportable(root_geom, dim)) {
+        return 1;
+      }
+      frameExporter->add([frame_geom, filename_str, exportInfo]() {
+        return exportFileByName(frame_geom, filename_str, exportInfo);
+      });
+    } else if (dim > 0 && !checkAndExport(root_geom, dim, exportInfo, cmd.is_stdout, filename_str)) {
       return 1;
     }
 
@@ -522,11 +668,30 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       }
     }
 
+    renderStatistic.collectEvaluationStatistic(session);
     renderStatistic.printAll(root_geom, camera, cmd.summaryOptions, cmd.summaryFile);
   }
   return 0;
 }
 
+// Output file for one parameter set: {set} in the name is replaced by the
+// set name, otherwise the set name is appended to the file name stem.
+std::string parameter_set_filename(const std::string& output_file, std::string set_name)
+{
+  std::replace_if(set_name.begin(), set_name.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+  std::string result = output_file;
+  const auto pos = result.find("{set}");
+  if (pos != std::string::npos) {
+    return result.replace(pos, 5, set_name);
+  }
+  auto path = fs::path(output_file);
+  const auto extension = path.extension();
+  path.replace_extension();
+  path += "-" + set_name;
+  path.replace_extension(extension);
+  return path.generic_string();
+}
+
 int cmdline(const CommandLine& cmd)
 {
   FileFormat export_format;
@@ -601,7 +766,7 @@ int cmdline(const CommandLine& cmd)
   text += "\n\x03\n" + commandline_commands;
 
   SourceFile *root_file = nullptr;
-  if (!parse(root_file, text, cmd.filename, cmd.filename, false)) {
+  if (!ParseCache::instance()->parse(root_file, text, cmd.filename, cmd.filename)) {
     delete root_file; // parse failed
     root_file = nullptr;
   }
@@ -612,18 +777,26 @@ int cmdline(const CommandLine& cmd)
 
   // add parameter to AST
   CommentParser::collectParameters(text.c_str(), root_file, '/');
-  if (!cmd.parameterFile.empty() && !cmd.setName.empty()) {
-    ParameterObjects parameters = ParameterObjects::fromSourceFile(root_file);
-    ParameterSets sets;
+  ParameterObjects parameters;
+  std::vector<const ParameterSet *> selected_sets;
+  ParameterSets sets;
+  if (!cmd.parameterFile.empty() && !cmd.setNames.empty()) {
+    parameters = ParameterObjects::fromSourceFile(root_file);
     sets.readFile(cmd.parameterFile);
+    const bool all = std::find(cmd.setNames.begin(), cmd.setNames.end(), "*") != cmd.setNames.end();
     for (const auto& set : sets) {
-      if (set.name() == cmd.setName) {
-        parameters.importValues(set);
-        parameters.apply(root_file);
-        break;
+      if (all || std::find(cmd.setNames.begin(), cmd.setNames.end(), set.name()) != cmd.setNames.end()) {
+        selected_sets.push_back(&set);
       }
     }
   }
+  // Several sets, or an output name with a {set} placeholder, produce one output per set
+  const bool batch = cmd.setNames.size() > 1 || (cmd.setNames.size() == 1 && cmd.setNames[0] == "*") ||
+                     cmd.output_file.find("{set}") != std::string::npos;
+  if (!batch && !selected_sets.empty()) {
+    parameters.importValues(*selected_sets.front());
+    parameters.apply(root_file);
+  }
 
   root_file->handleDependencies();
 
@@ -635,15 +808,54 @@ int cmdline(const CommandLine& cmd)
     .camera = cmd.camera,
   };
 
-  if (cmd.animate.frames == 0) {
+  if (batch) {
+    // Every worker process checks the arguments, only the first one reports problems
+    const bool report = cmd.worker.worker == 1;
+    if (cmd.animate.frames != 0 || cmd.is_stdout) {
+      if (report) LOG("Exporting several parameter sets is not supported with --animate or when exporting to stdout.");
+      return 1;
+    }
+    bool unknown = false;
+    for (const auto& name : cmd.setNames) {
+      if (name != "*" && std::none_of(sets.begin(), sets.end(), [&name](const ParameterSet& set) { return set.name() == name; })) {
+        if (report) LOG(message_group::Error, "Parameter set '%1$s' not found in '%2$s'", name, cmd.parameterFile);
+        unknown = true;
+      }
+    }
+    if (unknown) return 1;
+    if (selected_sets.empty()) {
+      if (report) LOG("No matching parameter set in '%1$s'.", cmd.parameterFile);
+      return 1;
+    }
+    // This process' share of the sets is evaluated one after the other,
+    // sharing the geometry caches, while finished outputs are written in
+    // the background.
+    const auto [first_set, end_set] = share(0, selected_sets.size(), cmd.worker.worker, cmd.worker.num_workers);
+    render_variables.time = 0;
+    FrameExporter setExporter;
+    for (unsigned i = first_set; i < end_set; ++i) {
+      const auto *set = selected_sets[i];
+      parameters.importValues(*set);
+      parameters.apply(root_file);
+
+      CommandLine set_cmd = cmd;
+      set_cmd.output_file = parameter_set_filename(cmd.output_file, set->name());
+      LOG("Exporting parameter set '%1$s' to %2$s...", set->name(), set_cmd.output_file);
+      int const r = do_export(set_cmd, render_variables, export_format, root_file, &setExporter);
+      if (r != 0) {
+        setExporter.finish();
+        return r;
+      }
+    }
+    return setExporter.finish() ? 0 : 1;
+  } else if (cmd.animate.frames == 0) {
     render_variables.time = 0;
     return do_export(cmd, render_variables, export_format, root_file);
   } else {
-    // export the requested number of animated frames
-    const unsigned start_frame = ((cmd.animate.shard - 1) * cmd.animate.frames)
-      / cmd.animate.num_shards;
-    const unsigned limit_frame = (cmd.animate.shard * cmd.animate.frames)
-      / cmd.animate.num_shards;
+    // export the requested number of animated frames, or this worker's share of them
+    const auto [shard_start, shard_limit] = share(0, cmd.animate.frames, cmd.animate.shard, cmd.animate.num_shards);
+    const auto [start_frame, limit_frame] = share(shard_start, shard_limit, cmd.worker.worker, cmd.worker.num_workers);
+    FrameExporter frameExporter;
     for (unsigned frame = start_frame; frame < limit_frame; ++frame) {
       render_variables.time = frame * (1.0 / cmd.animate.frames);
 #ifdef ENABLE_PYTHON      
@@ -670,13 +882,14 @@ int cmdline(const CommandLine& cmd)
       CommandLine frame_cmd = cmd;
       frame_cmd.output_file = frame_str;
 
-      int const r = do_export(frame_cmd, render_variables, export_format, root_file);
+      int const r = do_export(frame_cmd, render_variables, export_format, root_file, &frameExporter);
       if (r != 0) {
+        frameExporter.finish();
         return r;
       }
     }
 
-    return 0;
+    return frameExporter.finish() ? 0 : 1;
   }
 }
 
@@ -686,6 +899,205 @@ static std::string str_join(const Seq& seq, const std::string& sep, const ToStri
   return boost::algorithm::join(boost::adaptors::transform(seq, toString), sep);
 }
 
+// Converts a JSON value from a server job to an OpenSCAD literal
+std::string json_to_literal(const nlohmann::json& value)
+{
+  if (value.is_null()) return "undef";
+  if (value.is_array()) {
+    return "[" + str_join(value, ", ", [](const nlohmann::json& v) { return json_to_literal(v); }) + "]";
+  }
+  if (value.is_object()) throw std::invalid_argument("objects are not supported as parameter values");
+  return value.dump();
+}
+
+// True if name is a plain or special variable name, so it can't smuggle code into an assignment
+bool is_identifier(const std::string& name)
+{
+  const size_t start = (!name.empty() && name[0] == '$') ? 1 : 0;
+  if (name.size() == start || (name[start] >= '0' && name[start] <= '9')) return false;
+  return std::all_of(name.begin() + start, name.end(), [](char c) {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+  });
+}
+
+/*
+   Number of worker processes to export a batch of animation frames or
+   parameter sets with, 1 to export them in this process. Workers need to
+   read the input file again and can't contribute to one summary, profile
+   or dependency file.
+ */
+unsigned batch_workers(const po::variables_map& vm, const AnimateArgs& animate, const std::string& input_file,
+                       const std::string& parameterFile, const std::vector<std::string>& setNames)
+{
+  if (vm.count("batch-worker") || getenv("OPENSCAD_NO_PARALLEL") || input_file == "-" ||
+      vm.count("d") || vm.count("summary-file") || vm.count("profile-file")) {
+    return 1;
+  }
+  unsigned items = 1;
+  if (animate.frames > 1) {
+    const auto [start_frame, limit_frame] = share(0, animate.frames, animate.shard, animate.num_shards);
+    items = limit_frame - start_frame;
+  } else if (!parameterFile.empty() && setNames.size() > 1) {
+    items = setNames.size();
+  } else if (!parameterFile.empty() && setNames.size() == 1 && setNames[0] == "*") {
+    ParameterSets sets;
+    if (sets.readFile(parameterFile)) items = sets.size();
+  }
+  return std::max(1u, std::min(std::thread::hardware_concurrency(), items));
+}
+
+/*
+   Runs this program with the same arguments in num_workers processes at
+   once, each exporting its share of the frames or parameter sets (see
+   --batch-worker). The workers don't share the process wide state
+   evaluation relies on (working directory, node indices, output handler),
+   so they evaluate and render concurrently, at the cost of separate
+   geometry caches.
+ */
+int run_workers(int argc, char **argv, unsigned num_workers)
+{
+  const std::string program = boost::dll::program_location().string();
+  const std::vector<std::string> args(argv + 1, argv + argc);
+  std::vector<std::future<int>> workers;
+  for (unsigned worker = 1; worker <= num_workers; ++worker) {
+    auto worker_args = args;
+    worker_args.push_back("--batch-worker=" + std::to_string(worker) + "/" + std::to_string(num_workers));
+    workers.push_back(std::async(std::launch::async, [&program, worker_args = std::move(worker_args)]() {
+      return PlatformUtils::runProcess(program, worker_args);
+    }));
+  }
+  int rc = 0;
+  for (auto& worker : workers) {
+    if (worker.get() != 0) rc = 1;
+  }
+  return rc;
+}
+
+/*
+   Server mode: reads one JSON job per line from stdin and answers with one
+   JSON line per job on stdout. Geometry, CGAL and source file caches, as
+   well as the font cache and the Python interpreter, stay warm across jobs.
+
+   Job:      {"id": ..., "input": "file.scad", "output": "file.stl" | [...],
+              "D": ["var=val", ...], "parameters": {"var": val, ...},
+              "parameter-file": "file.json", "parameter-set": "name" | [...],
+              "export-format": "binstl"}
+   Response: {"id": ..., "status": "ok" | "error", "outputs": [...],
+              "time_ms": n, "messages": [...]}
+   A job {"command": "quit"} stops the server after acknowledging it, as
+   does end of input.
+ */
+int server(const fs::path& original_path, const ViewOptions& viewOptions, const Camera& camera,
+           const boost::optional<FileFormat>& default_format, const CmdLineExportOptions& exportOptions,
+           const std::vector<std::string>& summaryOptions)
+{
+  std::vector<std::string> messages;
+  set_output_handler([](const Message& msg, void *userdata) {
+    std::cerr << msg.str() << std::endl;
+    static_cast<std::vector<std::string> *>(userdata)->push_back(msg.str());
+  }, nullptr, &messages);
+
+  const std::string base_commands = commandline_commands;
+  const AnimateArgs no_animation;
+
+  // Runs one job, filling in its outputs. Throws on invalid jobs.
+  auto run_job = [&](const nlohmann::json& job, std::vector<std::string>& outputs) {
+    int rc = 0;
+    const std::string input = job.at("input").get<std::string>();
+    if (job.at("output").is_array()) {
+      outputs = job.at("output").get<std::vector<std::string>>();
+    } else {
+      outputs.push_back(job.at("output").get<std::string>());
+    }
+    const std::string parameterFile = job.value("parameter-file", "");
+    std::vector<std::string> parameterSets;
+    if (job.contains("parameter-set")) {
+      if (job["parameter-set"].is_array()) {
+        parameterSets = job["parameter-set"].get<std::vector<std::string>>();
+      } else {
+        parameterSets.push_back(job["parameter-set"].get<std::string>());
+      }
+    }
+    boost::optional<FileFormat> export_format = default_format;
+    if (job.contains("export-format")) {
+      FileFormat format;
+      if (!fileformat::fromIdentifier(job["export-format"].get<std::string>(), format)) {
+        throw std::invalid_argument("unknown export-format '" + job["export-format"].get<std::string>() + "'");
+      }
+      export_format.emplace(format);
+    }
+
+    commandline_commands = base_commands;
+    for (const auto& assignment : job.value("D", std::vector<std::string>{})) {
+      commandline_commands += assignment + ";\n";
+    }
+    if (job.contains("parameters")) {
+      for (const auto& [name, value] : job["parameters"].items()) {
+        if (!is_identifier(name)) throw std::invalid_argument("invalid parameter name '" + name + "'");
+        commandline_commands += name + "=" + json_to_literal(value) + ";\n";
+      }
+    }
+
+    for (const auto& output : outputs) {
+      if (output == "-") throw std::invalid_argument("output to stdout is not supported in server mode");
+      const CommandLine cmd{
+        false,
+        input,
+        false,
+        output,
+        original_path,
+        parameterFile,
+        parameterSets,
+        viewOptions,
+        camera,
+        export_format,
+        exportOptions,
+        no_animation,
+        {},
+        summaryOptions,
+        ""
+      };
+      rc |= cmdline(cmd);
+    }
+    return rc;
+  };
+
+  std::string line;
+  bool quit = false;
+  while (!quit && std::getline(std::cin, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    const auto start = std::chrono::steady_clock::now();
+    messages.clear();
+    nlohmann::json response;
+    std::vector<std::string> outputs;
+    int rc = 0;
+    try {
+      const auto job = nlohmann::json::parse(line);
+      if (job.contains("id")) response["id"] = job["id"];
+      quit = job.value("command", "") == "quit";
+      if (!quit) rc = run_job(job, outputs);
+    } catch (const HardWarningException&) {
+      rc = 1;
+    } catch (const std::exception& e) {
+      messages.emplace_back(e.what());
+      rc = 1;
+    }
+    commandline_commands = base_commands;
+    fs::current_path(original_path);
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    response["status"] = rc == 0 ? "ok" : "error";
+    response["outputs"] = outputs;
+    response["time_ms"] = elapsed.count();
+    response["messages"] = messages;
+    std::cout << response.dump() << std::endl;
+  }
+
+  set_output_handler(nullptr, nullptr, nullptr);
+  return 0;
+}
+
 static bool flagConvert(const std::string& str){
   if (str == "1" || boost::iequals(str, "on") || boost::iequals(str, "true")) {
     return true;
@@ -851,7 +1263,7 @@ int main(int argc, char **argv)
     ("O,O", po::value<std::vector<std::string>>(), "pass settings value to the file export using the format section/key=value, e.g export-pdf/paper-size=a3. Use --help-export to list all available settings.")
     ("D,D", po::value<std::vector<std::string>>(), "var=val -pre-define variables")
     ("p,p", po::value<std::string>(), "customizer parameter file")
-    ("P,P", po::value<std::string>(), "customizer parameter set")
+    ("P,P", po::value<std::vector<std::string>>(), "customizer parameter set. May be used multiple times, or '*' for all sets in the parameter file, to export one file per set. Use {set} in the output file name to place the set name.")
 #ifdef ENABLE_EXPERIMENTAL
   ("enable", po::value<std::vector<std::string>>(), ("enable experimental features (specify 'all' for enabling all available features): " +
                                            str_join(boost::make_iterator_range(Feature::begin(), Feature::end()), " | ",
@@ -877,8 +1289,10 @@ int main(int argc, char **argv)
     ("view", po::value<CommaSeparatedVector>(), ("=view options: " + boost::algorithm::join(viewOptions.names(), " | ")).c_str())
     ("projection", po::value<std::string>(), "=(o)rtho or (p)erspective when exporting png")
     ("csglimit", po::value<unsigned int>(), "=n -stop rendering at n CSG elements when exporting png")
-    ("summary", po::value<std::vector<std::string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area")
+    ("summary", po::value<std::vector<std::string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area | evaluation | profile")
     ("summary-file", po::value<std::string>(), "output summary information in JSON format to the given file, using '-' outputs to stdout")
+    ("profile-file", po::value<std::string>(), "write per module and node timings to the given file: folded stacks for *.folded or *.txt, a Chrome trace otherwise")
+    ("server", "keep running and read render jobs as JSON lines from stdin, reusing caches between jobs")
     ("colorscheme", po::value<std::string>(), ("=colorscheme: " +
                                           str_join(ColorMap::inst()->colorSchemeNames(), " | ",
                                                    [](const std::string& colorScheme) {
@@ -910,7 +1324,8 @@ int main(int argc, char **argv)
 #ifdef Q_OS_MACOS
   ("psn", po::value<std::string>(), "process serial number")
 #endif
-  ("input-file", po::value<std::vector<std::string>>(), "input file");
+  ("input-file", po::value<std::vector<std::string>>(), "input file")
+  ("batch-worker", po::value<std::string>(), "<worker>/<num_workers> - export this share of the frames or parameter sets, set by run_workers()");
 
   po::positional_options_description p;
   p.add("input-file", -1);
@@ -1049,12 +1464,9 @@ int main(int argc, char **argv)
     parameterFile = vm["p"].as<std::string>().c_str();
   }
 
-  std::string parameterSet;
+  std::vector<std::string> parameterSets;
   if (vm.count("P")) {
-    if (!parameterSet.empty()) {
-      help(argv[0], desc, true);
-    }
-    parameterSet = vm["P"].as<std::string>().c_str();
+    parameterSets = vm["P"].as<std::vector<std::string>>();
   }
 
   std::vector<std::string> inputFiles;
@@ -1079,6 +1491,7 @@ int main(int argc, char **argv)
   }
 
   AnimateArgs const animate = get_animate(vm);
+  WorkerArgs const worker = get_worker(vm);
   const Camera camera = get_camera(vm);
 
   if (animate.frames) {
@@ -1107,13 +1520,29 @@ int main(int argc, char **argv)
     if (!inputFiles.size()) help(argv[0], desc, true);
   }
 
-  if (arg_info || cmdlinemode) {
+  if (vm.count("summary")) {
+    const auto& summary = vm["summary"].as<std::vector<std::string>>();
+    for (const auto& option : summary) {
+      if (option == RenderStatistic::PROFILE || option == "all") Profiler::instance()->enable();
+    }
+  }
+  if (vm.count("profile-file")) Profiler::instance()->enable();
+
+  if (vm.count("server")) {
+    parser_init();
+    localization_init();
+    rc = server(original_path, viewOptions, camera, export_format, convert_export_options(vm),
+                vm.count("summary") ? vm["summary"].as<std::vector<std::string>>() : std::vector<std::string>{});
+  } else if (arg_info || cmdlinemode) {
     if (inputFiles.size() > 1) help(argv[0], desc, true);
     try {
       parser_init();
       localization_init();
+      const unsigned num_workers = batch_workers(vm, animate, inputFiles[0], parameterFile, parameterSets);
       if (arg_info) {
         rc = info();
+      } else if (num_workers > 1) {
+        rc = run_workers(argc, argv, num_workers);
       } else {
         for (const auto& filename : output_files) {
           const bool is_stdin = inputFiles[0] == "-";
@@ -1128,12 +1557,13 @@ int main(int argc, char **argv)
             output_file,
             original_path,
             parameterFile,
-            parameterSet,
+            parameterSets,
             viewOptions,
             camera,
             export_format,
             export_options,
             animate,
+            worker,
             vm.count("summary") ? vm["summary"].as<std::vector<std::string>>() : std::vector<std::string>{},
             vm.count("summary-file") ? vm["summary-file"].as<std::string>() : ""
           };
@@ -1143,6 +1573,9 @@ int main(int argc, char **argv)
     } catch (const HardWarningException&) {
       rc = 1;
     }
+    if (vm.count("profile-file") && !Profiler::instance()->write(vm["profile-file"].as<std::string>())) {
+      rc = 1;
+    }
 
     if (deps_output_file) {
       std::string const deps_out(deps_output_file);
@@ -10,6 +10,16 @@
 
 #include "utils/printutils.h"
 
+#if defined(_WIN32)
+#include <process.h>
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
 #ifdef OPENSCAD_SUFFIX
 #define RESOURCE_FOLDER(path) path OPENSCAD_SUFFIX
 #else
@@ -230,6 +240,62 @@ int PlatformUtils::setenv(const char *name, const char *value, int overwrite)
 #endif
 }
 
+#if defined(_WIN32)
+static std::wstring toWide(const std::string& str)
+{
+  const int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, nullptr, 0);
+  std::wstring result(size > 0 ? size - 1 : 0, L'\0');
+  if (size > 0) MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, result.data(), size);
+  return result;
+}
+
+// Quotes an argument so the C runtime of the child splits it back out unchanged
+static std::wstring quoteArgument(const std::wstring& arg)
+{
+  std::wstring result = L"\"";
+  size_t backslashes = 0;
+  for (const wchar_t c : arg) {
+    if (c == L'\\') {
+      backslashes++;
+      continue;
+    }
+    // Backslashes are only special in front of a quote
+    result.append(c == L'"' ? 2 * backslashes + 1 : backslashes, L'\\');
+    backslashes = 0;
+    result.push_back(c);
+  }
+  result.append(2 * backslashes, L'\\');
+  result.push_back(L'"');
+  return result;
+}
+#endif
+
+int PlatformUtils::runProcess(const std::string& program, const std::vector<std::string>& args)
+{
+#if defined(_WIN32)
+  const std::wstring wprogram = toWide(program);
+  std::vector<std::wstring> wargs{quoteArgument(wprogram)};
+  for (const auto& arg : args) wargs.push_back(quoteArgument(toWide(arg)));
+  std::vector<const wchar_t *> argv;
+  for (const auto& arg : wargs) argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+  return static_cast<int>(_wspawnv(_P_WAIT, wprogram.c_str(), argv.data()));
+#elif defined(__EMSCRIPTEN__)
+  return -1;
+#else
+  std::vector<char *> argv{const_cast<char *>(program.c_str())};
+  for (const auto& arg : args) argv.push_back(const_cast<char *>(arg.c_str()));
+  argv.push_back(nullptr);
+  pid_t pid;
+  if (posix_spawn(&pid, program.c_str(), nullptr, nullptr, argv.data(), environ) != 0) return -1;
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) return -1;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
 std::string PlatformUtils::toMemorySizeString(uint64_t bytes, int digits)
 {
   static const char *units[] = { "B", "kB", "MB", "GB", "TB", nullptr };
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -92,6 +93,16 @@ const std::string user_agent();
  */
 int setenv(const char *name, const char *value, int overwrite);
 
+/**
+ * Run a program with the given arguments and wait for it to finish. The
+ * program inherits the environment, working directory and standard streams.
+ *
+ * @param program full path of the program.
+ * @param args arguments, not including the program name.
+ * @return the exit code of the program, or -1 if it could not be run.
+ */
+int runProcess(const std::string& program, const std::vector<std::string>& args);
+
 /**
  * Return system defined stack limit. If the system does not define
  * a specific limit, the platform specific code will select a value.
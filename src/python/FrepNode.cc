@@ -27,6 +27,7 @@
 #include "FrepNode.h"
 #ifdef ENABLE_PYTHON
 #include "pydata.h"
+#include "pyopenscad.h"
 #endif
 
 #include "module.h"
@@ -71,6 +72,7 @@ std::unique_ptr<const Geometry> FrepNode::createGeometry() const
 	settings.min_feature = 1.0 / this->res;
 
 #ifdef ENABLE_PYTHON	
+	PythonGILGuard gil;
 	PyObject *exp = this->expression;
 	if(exp == NULL ) return std::unique_ptr<PolySet>();
 
@@ -396,7 +396,7 @@ PyObject *PyDataObject_call(PyObject *self, PyObject *args, PyObject *kwargs)
 	std::shared_ptr<AbstractNode> child = ((PyOpenSCADObject *) arg)->node;
 	Tree tree(child, "");
 	GeometryEvaluator geomevaluator(tree);
-	std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+	std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
 	std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 	if(ps != nullptr) {
 
@@ -459,6 +459,7 @@ PyObject *PyDataObject_call(PyObject *self, PyObject *args, PyObject *kwargs)
   std::ostringstream stream;
   stream << "include <" << modulepath << ">";
 
+  PythonKernelGuard kernel;
   SourceFile *source;
   if(!parse(source, stream.str(), "python", "python", false)) {
     PyErr_SetString(PyExc_TypeError, "Error in SCAD code");
@@ -25,6 +25,9 @@
  */
 
 
+#include <algorithm>
+#include <map>
+#include <tuple>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 #include "linalg.h"
@@ -73,6 +76,7 @@ extern bool parse(SourceFile *& file, const std::string& text, const std::string
 #include "core/Tree.h"
 #include "geometry/PolySet.h"
 #include "geometry/GeometryEvaluator.h"
+#include "geometry/HalfEdgeMesh.h"
 #include "utils/degree_trig.h"
 #include "printutils.h"
 #include "io/fileutils.h"
@@ -211,31 +215,158 @@ PyObject *python_cube(PyObject *self, PyObject *args, PyObject *kwargs)
   return PyOpenSCADObjectFromNode(&PyOpenSCADType, node);
 }
 
-int sphereCalcIndInt(PyObject *func, Vector3d &dir)
-{
-  dir.normalize();
-  PyObject *dir_p= PyList_New(3);
-  for(int i=0;i<3;i++)
-    PyList_SetItem(dir_p,i,PyFloat_FromDouble(dir[i]));
-  PyObject* args = PyTuple_Pack(1,dir_p);
-  PyObject* len_p = PyObject_CallObject(func, args);
-  double len=0;
-  if(len_p == nullptr) {
-    std::string errorstr;
-    python_catch_error(errorstr);	  
-    PyErr_SetString(PyExc_TypeError, errorstr.c_str());
-    LOG(message_group::Error, errorstr.c_str());
-    return 1;
-  }
-  python_numberval(len_p, &len);
-  dir *= len;
-  return 0;
-}
+/*
+ * Evaluates the radius function of a function based sphere(), memoizing
+ * the result per direction. Directions can be prefetched in batches: if
+ * numpy is available the function is tried once with a 3xN array of
+ * directions, and if it returns N values, all batches are evaluated that
+ * way. Otherwise the function is called once per direction.
+ *
+ * While deferring, eval() doesn't call the function but fails for
+ * directions not sampled yet, collecting them for the next prefetch().
+ */
+class SphereSampler
+{
+public:
+  SphereSampler(PyObject *func) : func(func) {}
+  ~SphereSampler() {
+    if (numpy == nullptr) return;
+    PythonGILGuard gil;
+    Py_DECREF(numpy);
+  }
+
+  // Scales the normalized dir by the function value, false on Python errors
+  // and on directions not sampled yet while deferring
+  bool eval(Vector3d& dir) {
+    const Vector3d point = dir;
+    dir.normalize();
+    const Key key{dir[0], dir[1], dir[2]};
+    auto it = lengths.find(key);
+    if (it == lengths.end()) {
+      if (deferring) {
+        deferred.push_back(point);
+        return false;
+      }
+      double len = 0;
+      if (!callScalar(dir, len)) return false;
+      it = lengths.emplace(key, len).first;
+    }
+    dir *= it->second;
+    return true;
+  }
+
+  // Evaluates all points not seen yet in one call, if the function allows
+  void prefetch(const std::vector<Vector3d>& points) {
+    if (!batching()) return;
+    std::vector<Key> missing;
+    for (const auto& point : points) {
+      const Vector3d dir = point.normalized();
+      const Key key{dir[0], dir[1], dir[2]};
+      if (lengths.count(key) == 0) missing.push_back(key);
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+    if (missing.empty()) return;
+
+    std::vector<double> lens;
+    if (!callVector(missing, lens)) {
+      vectorized = 0;
+      return;
+    }
+    vectorized = 1;
+    for (size_t i = 0; i < missing.size(); i++) lengths.emplace(missing[i], lens[i]);
+  }
+
+  [[nodiscard]] bool batching() const { return vectorized != 0; }
 
-int sphereCalcInd(PolySetBuilder &builder, std::vector<Vector3d> &vertices, PyObject *func, Vector3d dir)
+  void startDeferring() {
+    deferring = true;
+    deferred.clear();
+  }
+
+  // Returns the points eval() was asked for but didn't have samples for
+  std::vector<Vector3d> stopDeferring() {
+    deferring = false;
+    return std::move(deferred);
+  }
+
+private:
+  using Key = std::tuple<double, double, double>;
+
+  bool callScalar(const Vector3d& dir, double& len) {
+    PythonGILGuard gil;
+    PyObject *dir_p= PyList_New(3);
+    for(int i=0;i<3;i++)
+      PyList_SetItem(dir_p,i,PyFloat_FromDouble(dir[i]));
+    PyObject* args = PyTuple_Pack(1,dir_p);
+    PyObject* len_p = PyObject_CallObject(func, args);
+    if(len_p == nullptr) {
+      std::string errorstr;
+      python_catch_error(errorstr);	  
+      PyErr_SetString(PyExc_TypeError, errorstr.c_str());
+      LOG(message_group::Error, errorstr.c_str());
+      return false;
+    }
+    python_numberval(len_p, &len);
+    return true;
+  }
+
+  bool callVector(const std::vector<Key>& dirs, std::vector<double>& lens) {
+    PythonGILGuard gil;
+    if (numpy == nullptr) {
+      numpy = PyImport_ImportModule("numpy");
+      if (numpy == nullptr) {
+        PyErr_Clear();
+        return false;
+      }
+    }
+    PyObjectUniquePtr coords(PyList_New(3), PyObjectDeleter);
+    for (int i = 0; i < 3; i++) {
+      PyObject *row = PyList_New(dirs.size());
+      for (size_t j = 0; j < dirs.size(); j++) {
+        const double v = i == 0 ? std::get<0>(dirs[j]) : i == 1 ? std::get<1>(dirs[j]) : std::get<2>(dirs[j]);
+        PyList_SetItem(row, j, PyFloat_FromDouble(v));
+      }
+      PyList_SetItem(coords.get(), i, row);
+    }
+    PyObjectUniquePtr array(PyObject_CallMethod(numpy, "array", "O", coords.get()), PyObjectDeleter);
+    if (array == nullptr) {
+      PyErr_Clear();
+      return false;
+    }
+    PyObjectUniquePtr result(PyObject_CallFunctionObjArgs(func, array.get(), nullptr), PyObjectDeleter);
+    // Functions written for a single direction typically raise or return a scalar here
+    if (result == nullptr || !PySequence_Check(result.get()) || PySequence_Size(result.get()) != (Py_ssize_t) dirs.size()) {
+      PyErr_Clear();
+      return false;
+    }
+    PyObjectUniquePtr values(PySequence_Fast(result.get(), ""), PyObjectDeleter);
+    if (values == nullptr) {
+      PyErr_Clear();
+      return false;
+    }
+    lens.resize(dirs.size());
+    for (size_t j = 0; j < dirs.size(); j++) {
+      lens[j] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(values.get(), j));
+    }
+    if (PyErr_Occurred()) {
+      PyErr_Clear();
+      return false;
+    }
+    return true;
+  }
+
+  PyObject *func;
+  PyObject *numpy{nullptr};
+  int vectorized{-1}; // -1: not tried yet, 0: per direction calls, 1: batched
+  std::map<Key, double> lengths;
+  bool deferring{false};
+  std::vector<Vector3d> deferred;
+};
+
+int sphereCalcInd(PolySetBuilder &builder, std::vector<Vector3d> &vertices, SphereSampler &sampler, Vector3d dir)
 {
-  std::string errorstr;	
-  if(sphereCalcIndInt(func, dir)) return -1; // TODO fix
+  if(!sampler.eval(dir)) return -1; // TODO fix
   unsigned int ind=builder.vertexIndex(dir);
   if(ind == vertices.size()) vertices.push_back(dir);
   return ind;
@@ -268,33 +399,95 @@ int operator==(const SphereEdgeDb &t1, const SphereEdgeDb &t2)
         return 0;
 }
 
-int sphereCalcSplitInd(PolySetBuilder &builder, std::vector<Vector3d> &vertices, std::unordered_map<SphereEdgeDb, int, boost::hash<SphereEdgeDb> > &edges, PyObject *func, int ind1, int ind2)
+using SphereEdges = std::unordered_map<SphereEdgeDb, int, boost::hash<SphereEdgeDb> >;
+
+enum class SphereEdgeSplit { None, Flat, Split, Failed };
+
+/*
+ * Decides what a subdivision round of sphereCreateFuncGeometry() does with
+ * the edge i1-i2: None if it's split already or shorter than fs, Flat if
+ * the surface is flat along it, otherwise Split at the surface point pmid.
+ * Failed if the function couldn't be evaluated.
+ */
+static SphereEdgeSplit sphereSplitEdge(SphereSampler &sampler, const std::vector<Vector3d> &vertices,
+                                       const SphereEdges &edges, int i1, int i2, double fs, Vector3d &pmid)
 {
-  SphereEdgeDb edge(ind1, ind2);
-  if(edges.count(edge) > 0) {
-    return edges[edge];
+  if(edges.count(SphereEdgeDb(i1, i2)) > 0) return SphereEdgeSplit::None;
+  const Vector3d &p1=vertices[i1], &p2=vertices[i2];
+  if((p1-p2).norm() < fs) return SphereEdgeSplit::None;
+  Vector3d pmin=p1, pmax=p2;
+  pmid=(pmin+pmax)/2;
+  if(!sampler.eval(pmid)) return SphereEdgeSplit::Failed;
+  double ang=acos((pmid-p1).normalized().dot((p2-pmid).normalized()));
+  if(ang < 0.001) return SphereEdgeSplit::Flat;
+
+  // Move pmid towards pmin or pmax if the edge bends more there
+  Vector3d pmid_test=(pmin+pmid)/2;
+  if(!sampler.eval(pmid_test)) return SphereEdgeSplit::Failed;
+  double ang_test=acos((pmid_test-p1).normalized().dot((p2-pmid_test).normalized()));
+  if(ang_test > ang) {
+    pmax=pmid; ang=ang_test; pmid=pmid_test;
+    if((pmax-pmin).norm() > fs) return SphereEdgeSplit::Split;
+  }
+  pmid_test=(pmax+pmid)/2;
+  if(!sampler.eval(pmid_test)) return SphereEdgeSplit::Failed;
+  ang_test=acos((pmid_test-p1).normalized().dot((p2-pmid_test).normalized()));
+  if(ang_test > ang) pmid=pmid_test;
+  return SphereEdgeSplit::Split;
+}
+
+// Surface point above the center of tri, false if the function couldn't be evaluated
+static bool sphereTriangleCenter(SphereSampler &sampler, const std::vector<Vector3d> &vertices, const IndexedTriangle &tri, Vector3d &pmid)
+{
+  pmid=(vertices[tri[0]]+vertices[tri[1]]+vertices[tri[2]])/3.0;
+  return sampler.eval(pmid);
+}
+
+/*
+ * Batches the function samples the next subdivision round of
+ * sphereCreateFuncGeometry() will ask for. Samples depend on earlier ones,
+ * so this replays the decisions of the round while the sampler defers,
+ * fetches what they missed in one call, and repeats until nothing is
+ * missing. The round itself then only hits the memo.
+ */
+static void sphereCreateFuncPrefetch(SphereSampler &sampler, const std::vector<IndexedTriangle> &triangles, const std::vector<Vector3d> &vertices,
+                                     const SphereEdges &edges, double fs)
+{
+  // Midpoints, both refinements and triangle centers depend on each other
+  constexpr int maxStages = 4;
+  for(int stage=0; stage < maxStages && sampler.batching(); stage++) {
+    sampler.startDeferring();
+    Vector3d pmid;
+    for(const IndexedTriangle & tri: triangles) {
+      int zeroang=0;
+      for(int i=0;i<3;i++) {
+        if(sphereSplitEdge(sampler, vertices, edges, tri[i], tri[(i+1)%3], fs, pmid) == SphereEdgeSplit::Flat) zeroang++;
+      }
+      if(zeroang == 3) sphereTriangleCenter(sampler, vertices, tri, pmid);
+    }
+    const std::vector<Vector3d> missing = sampler.stopDeferring();
+    if(missing.empty()) return;
+    sampler.prefetch(missing);
   }
-  int result = sphereCalcInd(builder, vertices, func, vertices[ind1]+vertices[ind2]);
-  if(result != -1) edges[edge]=result;
-  return result;
 }
 
 std::unique_ptr<const Geometry> sphereCreateFuncGeometry(void *funcptr, double fs, int n)
 {
-  PyObject *func = (PyObject *) funcptr;
-  std::unordered_map<SphereEdgeDb, int, boost::hash<SphereEdgeDb> > edges;
+  SphereSampler sampler((PyObject *) funcptr);
+  SphereEdges edges;
 
   PolySetBuilder builder;
   std::vector<Vector3d> vertices;
 
   int topind, botind, leftind, rightind, frontind, backind;
-  leftind=sphereCalcInd(builder, vertices, func, Vector3d(-1,0,0));
+  sampler.prefetch({Vector3d(-1,0,0), Vector3d(1,0,0), Vector3d(0,-1,0), Vector3d(0,1,0), Vector3d(0,0,-1), Vector3d(0,0,1)});
+  leftind=sphereCalcInd(builder, vertices, sampler, Vector3d(-1,0,0));
   if(leftind < 0 ) return builder.build();
-  rightind=sphereCalcInd(builder, vertices, func, Vector3d(1,0,0));
-  frontind=sphereCalcInd(builder, vertices, func, Vector3d(0,-1,0));
-  backind=sphereCalcInd(builder, vertices, func, Vector3d(0,1,0));
-  botind=sphereCalcInd(builder, vertices, func, Vector3d(0,0,-1));
-  topind=sphereCalcInd(builder, vertices, func, Vector3d(0,0,1));
+  rightind=sphereCalcInd(builder, vertices, sampler, Vector3d(1,0,0));
+  frontind=sphereCalcInd(builder, vertices, sampler, Vector3d(0,-1,0));
+  backind=sphereCalcInd(builder, vertices, sampler, Vector3d(0,1,0));
+  botind=sphereCalcInd(builder, vertices, sampler, Vector3d(0,0,-1));
+  topind=sphereCalcInd(builder, vertices, sampler, Vector3d(0,0,1));
   if(rightind < 0 || frontind < 0 || backind < 0 || botind < 0 || topind < 0) return builder.build();
 
   std::vector<IndexedTriangle> triangles;
@@ -309,69 +502,35 @@ std::unique_ptr<const Geometry> sphereCreateFuncGeometry(void *funcptr, double f
   tri_new.push_back(IndexedTriangle(backind, botind, leftind));
 
   int round=0;
-  unsigned int i1, i2, imid;
-  Vector3d p1, p2, p3,pmin, pmax, pmid, pmid_test, dir1, dir2;
-  double dist,ang,ang_test;
+  unsigned int imid;
+  Vector3d pmid;
   do {
     triangles = tri_new;	  
     if(round == n) break;
+    sphereCreateFuncPrefetch(sampler, triangles, vertices, edges, fs);
     tri_new.clear();
     std::vector<int> midinds;
     for(const IndexedTriangle & tri: triangles) {
       int zeroang=0;	    
       unsigned int midind=-1;
       for(int i=0;i<3;i++) {
-        i1=tri[i];
-	i2=tri[(i+1)%3];
-        SphereEdgeDb edge(i1, i2);
-  	if(edges.count(edge) > 0) continue;
-        dist=(vertices[i1]-vertices[i2]).norm();
-	if(dist < fs) continue;
-	p1=vertices[i1];
-	p2=vertices[i2];
-	pmin=p1;
-	pmax=p2;
-	pmid=(pmin+pmax)/2;
-	if(sphereCalcIndInt(func, pmid)) return builder.build();
-	dir1=(pmid-p1).normalized();
-	dir2=(p2-pmid).normalized();
-	ang=acos(dir1.dot(dir2));
-//	printf("ang=%g\n",ang*180/3.14);
-        if(ang < 0.001) { zeroang++; continue; }
-	do
-	{
-	  pmid_test=(pmin+pmid)/2;
-	  if(sphereCalcIndInt(func, pmid_test)) return builder.build();
-	  dir1=(pmid_test-p1).normalized();
-	  dir2=(p2-pmid_test).normalized();
-	  ang_test=acos(dir1.dot(dir2));
-	  if(ang_test > ang) {
-		  pmax=pmid; ang=ang_test; pmid = pmid_test; 
-		  if((pmax-pmin).norm() > fs) continue;
-	  }
-
- 	  pmid_test=(pmax+pmid)/2;
- 	  if(sphereCalcIndInt(func, pmid_test)) return builder.build();
-	  dir1=(pmid_test-p1).normalized();
-	  dir2=(p2-pmid_test).normalized();
-	  ang_test=acos(dir1.dot(dir2));
-	  if(ang_test > ang) {
-		  pmin=pmid; ang=ang_test; pmid = pmid_test;
-		  if((pmax-pmin).norm() > fs) continue;
-	  }
-	}
-        while(0);	
-
+        switch(sphereSplitEdge(sampler, vertices, edges, tri[i], tri[(i+1)%3], fs, pmid)) {
+          case SphereEdgeSplit::None:
+            continue;
+          case SphereEdgeSplit::Flat:
+            zeroang++;
+            continue;
+          case SphereEdgeSplit::Failed:
+            return builder.build();
+          case SphereEdgeSplit::Split:
+            break;
+        }
   	imid=builder.vertexIndex(pmid);
         if(imid == vertices.size()) vertices.push_back(pmid);
-	edges[edge]=imid;
+	edges[SphereEdgeDb(tri[i], tri[(i+1)%3])]=imid;
       }
       if(zeroang == 3) {
-	p1=vertices[tri[0]];
-	p2=vertices[tri[1]];
-	p3=vertices[tri[2]];
-	pmid=(p1+p2+p3)/3.0;
-	if(sphereCalcIndInt(func, pmid)) return builder.build();
+	if(!sphereTriangleCenter(sampler, vertices, tri, pmid)) return builder.build();
         Vector4d norm=calcTriangleNormal(vertices,{tri[0], tri[1], tri[2] });
 	if(fabs(pmid.dot(norm.head<3>())- norm[3]) > 1e-3) {
   	  midind=builder.vertexIndex(pmid);
@@ -458,27 +617,22 @@ std::unique_ptr<const Geometry> sphereCreateFuncGeometry(void *funcptr, double f
   round=0;
   do {
     done=0;
-    auto edge_db = createEdgeDb(ps->indices);
+    const HalfEdgeMesh mesh(ps->indices, ps->vertices.size());
+    std::vector<bool> flipped(ps->indices.size(), false); // topology of these is outdated
     for(int i=0;i<ps->indices.size();i++){
       auto &tri = ps->indices[i];	  
+      if(flipped[i]) continue;
       if(tri[0] == tri[1] || tri[0] == tri[2] || tri[1] == tri[2]) continue;
       for(int j=0;j<3;j++) {
         int debug = 0;	      
         int i1=tri[j];
         int i2=tri[(j+1)%3];
         double l1=(ps->vertices[i1] - ps->vertices[i2]).norm();
-        EdgeKey ek(tri[j],tri[(j+1)%3]);	    
-        if(edge_db.count(ek) != 0) {
-          auto ev = edge_db.at(ek);
-	  int face_o, pos_o;
-	  if(i2 > i1) {
-            face_o = ev.faceb;
-	    pos_o  = ev.posb;
-	  } else {
-            face_o = ev.facea;		
-	    pos_o  = ev.posa;
-	  }
-	  if(face_o == -1 || pos_o == -1) continue;
+        const int h_oth = mesh.twin(mesh.halfEdge(i, j));
+        if(h_oth != -1) {
+	  int face_o = mesh.face(h_oth);
+	  int pos_o = mesh.position(h_oth);
+	  if(flipped[face_o]) continue;
 	  auto &tri_oth= ps->indices[face_o];
 	  double l2 = (ps->vertices[tri[(j+2)%3]] - ps->vertices[tri_oth[(pos_o+2)%3]]).norm();
 	  if(l2 < l1) {
@@ -501,10 +655,8 @@ std::unique_ptr<const Geometry> sphereCreateFuncGeometry(void *funcptr, double f
 	      tri_oth = tri_oth_;
     	    
     			    
-	      for(int k=0;k<3;k++) {
-                edge_db.erase(EdgeKey(tri[k],tri[(k+1)%3]));	    
-                edge_db.erase(EdgeKey(tri_oth[k],tri_oth[(k+1)%3]));	    
-	      }
+	      flipped[i] = true;
+	      flipped[face_o] = true;
 	      done++;
               break; // dont proceed with 
             }
@@ -845,6 +997,7 @@ PyObject *python_ifrep(PyObject *self, PyObject *args, PyObject *kwargs)
 
   child = PyOpenSCADObjectToNodeMulti(object,&dummydict);
   LeafNode *node = (LeafNode *)   child.get();
+  PythonKernelGuard kernel;
   const std::shared_ptr<const Geometry> geom = node->createGeometry();
   const std::shared_ptr<const PolySet> ps = std::dynamic_pointer_cast<const PolySet>(geom);
  
@@ -1902,7 +2055,7 @@ PyObject *python_oo_wrap(PyObject *obj, PyObject *args, PyObject *kwargs)
 
 PyObject *python_show_core(PyObject *obj)
 {
-  python_result_obj = obj;
+  python_set_result_obj(obj);
   PyObject *child_dict = nullptr;
   std::shared_ptr<AbstractNode> child = PyOpenSCADObjectToNodeMulti(obj, &child_dict);
   if (child == NULL) { 
@@ -1974,6 +2127,7 @@ PyObject *python_oo_output(PyObject *obj, PyObject *args, PyObject *kwargs){
 void Export3mfPartInfo::writeProps(void *obj) const
 {
   if(this->props == nullptr) return;
+  PythonGILGuard gil;
   PyObject *prop = (PyObject *) this->props;
   if(!PyDict_Check(prop)) return;
   PyObject *key, *value;
@@ -1996,18 +2150,34 @@ void Export3mfPartInfo::writeProps(void *obj) const
   }
 }
 
-void python_export_obj_att(std::ostream& output)
+// Attributes of the exported object, set while a file is written for export()
+// or export_async(), which may run on the background render thread
+static thread_local const std::string *python_export_attributes = nullptr;
+
+// Makes python_export_obj_att() write attributes while the current thread exports
+class PythonExportAttributesScope
 {
+public:
+  explicit PythonExportAttributesScope(const std::string& attributes) { python_export_attributes = &attributes; }
+  ~PythonExportAttributesScope() { python_export_attributes = nullptr; }
+  PythonExportAttributesScope(const PythonExportAttributesScope&) = delete;
+  PythonExportAttributesScope& operator=(const PythonExportAttributesScope&) = delete;
+};
+
+// Header lines listing the number and string attributes of obj, needs the GIL
+static std::string python_obj_attributes(PyObject *obj)
+{
+  std::ostringstream output;
   PyObject *child_dict= nullptr;
-  if(python_result_obj == nullptr) return;
-  std::shared_ptr<AbstractNode> child = PyOpenSCADObjectToNodeMulti(python_result_obj, &child_dict);
-  if(child_dict == nullptr) return;
-  if(!PyDict_Check(child_dict)) return;
+  std::shared_ptr<AbstractNode> child = PyOpenSCADObjectToNodeMulti(obj, &child_dict);
+  if(child_dict == nullptr) return "";
+  if(!PyDict_Check(child_dict)) return "";
   PyObject *key, *value;
   Py_ssize_t pos = 0;
   while (PyDict_Next(child_dict, &pos, &key, &value)) {
-    PyObject* key1 = PyUnicode_AsEncodedString(key, "utf-8", "~");
-    const char *key_str =  PyBytes_AS_STRING(key1);
+    PyObjectUniquePtr key1(PyUnicode_AsEncodedString(key, "utf-8", "~"), PyObjectDeleter);
+    if(key1 == nullptr) continue;
+    const char *key_str =  PyBytes_AS_STRING(key1.get());
     if(key_str == nullptr) continue;
 
     if(PyLong_Check(value))  
@@ -2021,31 +2191,34 @@ void python_export_obj_att(std::ostream& output)
       output <<  "# " << key_str << " = \"" << valuestr << "\"\n" ;
     }  
   }
+  return output.str();
+}
 
-}	
-
-PyObject *python_export_core(PyObject *obj, char *file)
+void python_export_obj_att(std::ostream& output)
 {
-  const auto path = fs::path(file);
-  std::string suffix = path.has_extension() ? path.extension().generic_string().substr(1) : "";
-  boost::algorithm::to_lower(suffix);
-  python_result_obj = obj;
-
-  FileFormat exportFileFormat = FileFormat::BINARY_STL;
-  if (!fileformat::fromIdentifier(suffix, exportFileFormat)) {
-    LOG("Invalid suffix %1$s. Defaulting to binary STL.", suffix);
+  if(python_export_attributes != nullptr) {
+    output << *python_export_attributes;
+    return;
   }
+  if(python_result_obj == nullptr) return;
+  PythonGILGuard gil;
+  output << python_obj_attributes(python_result_obj);
+}	
 
-  std::vector<Export3mfPartInfo> export3mfPartInfos;
-  std::vector<std::string>  names;
+// One object to export, props holds a reference to its 3MF properties
+struct PythonExportPart {
+  std::shared_ptr<AbstractNode> node;
+  std::string name;
+  PyObject *props;
+};
 
+// Collects the objects to export from a single object or a dict of named objects
+static bool python_export_parts(PyObject *obj, std::vector<PythonExportPart>& parts)
+{
   PyObject *child_dict;
   std::shared_ptr<AbstractNode> child = PyOpenSCADObjectToNodeMulti(obj, &child_dict);
   if(child != nullptr ) {
-    Tree tree(child, "parent");
-    GeometryEvaluator geomevaluator(tree);
-    Export3mfPartInfo info(geomevaluator.evaluateGeometry(*tree.root(), false), "OpenSCAD Model", nullptr);
-    export3mfPartInfos.push_back(info);
+    parts.push_back({child, "OpenSCAD Model", nullptr});
   } else if(PyDict_Check(obj)) {
     PyObject *key, *value;
     Py_ssize_t pos = 0;
@@ -2056,22 +2229,40 @@ PyObject *python_export_core(PyObject *obj, char *file)
       std::shared_ptr<AbstractNode> child = PyOpenSCADObjectToNodeMulti(value, &child_dict);
       if(child == nullptr) continue;
 
-      void *prop = nullptr;
+      PyObject *prop = nullptr;
       if(child_dict != nullptr && PyDict_Check(child_dict)) {
         PyObject *key = PyUnicode_FromStringAndSize("props_3mf",9);
         prop = PyDict_GetItem(child_dict, key);
+        Py_XINCREF(prop);
       }
-      Tree tree(child, "parent");
-      GeometryEvaluator geomevaluator(tree);
-      Export3mfPartInfo info(geomevaluator.evaluateGeometry(*tree.root(), false),value_str, prop);
-      export3mfPartInfos.push_back(info);
+      parts.push_back({child, value_str, prop});
     }
   }
-  if ( export3mfPartInfos.size() == 0) {
+  if (parts.size() == 0) {
     PyErr_SetString(PyExc_TypeError, "Object not recognized");
-    return NULL;
-  }  
+    return false;
+  }
+  return true;
+}
+
+static void python_export_parts_release(std::vector<PythonExportPart>& parts)
+{
+  for (auto& part : parts) Py_XDECREF(part.props);
+  parts.clear();
+}
 
+// Evaluates and writes the parts, returns an error message on failure.
+// Runs without the GIL, the caller must hold the kernel lock.
+static std::string python_export_write(const std::vector<PythonExportPart>& parts, const std::string& attributes,
+                                       const std::string& file, FileFormat exportFileFormat)
+{
+  const PythonExportAttributesScope attributes_scope(attributes);
+  std::vector<Export3mfPartInfo> export3mfPartInfos;
+  for (const auto& part : parts) {
+    Tree tree(part.node, "parent");
+    GeometryEvaluator geomevaluator(tree);
+    export3mfPartInfos.emplace_back(geomevaluator.evaluateGeometry(*tree.root(), false), part.name, part.props);
+  }
 
   Export3mfOptions options3mf;
   options3mf .decimalPrecision=6;
@@ -2081,21 +2272,120 @@ PyObject *python_export_core(PyObject *obj, char *file)
   if(exportFileFormat == FileFormat::_3MF) {
     std::ofstream fstream(file,  std::ios::out | std::ios::trunc | std::ios::binary);
     if (!fstream.is_open()) {
-      PyErr_SetString(PyExc_TypeError, "Can't write export file");
-      return nullptr;
+      return "Can't write export file";
     }
     export_3mf(export3mfPartInfos, fstream, exportInfo);
   }
   else{
-    if(export3mfPartInfos.size() > 1) {
-      PyErr_SetString(PyExc_TypeError, "This Format can at most export one object");
-      return nullptr;
-    }	    
     exportFileByName(export3mfPartInfos[0].geom, file, exportInfo);
   }
+  return "";
+}
+
+// Collects everything the export needs from obj, so the file can be written
+// without the GIL and on another thread
+static bool python_export_prepare(PyObject *obj, char *file, std::vector<PythonExportPart>& parts, std::string& attributes,
+                                  FileFormat& exportFileFormat)
+{
+  const auto path = fs::path(file);
+  std::string suffix = path.has_extension() ? path.extension().generic_string().substr(1) : "";
+  boost::algorithm::to_lower(suffix);
+  python_set_result_obj(obj);
+  attributes = python_obj_attributes(obj);
+
+  exportFileFormat = FileFormat::BINARY_STL;
+  if (!fileformat::fromIdentifier(suffix, exportFileFormat)) {
+    LOG("Invalid suffix %1$s. Defaulting to binary STL.", suffix);
+  }
+
+  if (!python_export_parts(obj, parts)) return false;
+  if(exportFileFormat != FileFormat::_3MF && parts.size() > 1) {
+    python_export_parts_release(parts);
+    PyErr_SetString(PyExc_TypeError, "This Format can at most export one object");
+    return false;
+  }
+  return true;
+}
+
+PyObject *python_export_core(PyObject *obj, char *file)
+{
+  std::vector<PythonExportPart> parts;
+  std::string attributes;
+  FileFormat exportFileFormat;
+  if (!python_export_prepare(obj, file, parts, attributes, exportFileFormat)) return nullptr;
+
+  std::string error;
+  {
+    PythonAllowThreads allow;
+    error = python_export_write(parts, attributes, file, exportFileFormat);
+  }
+  python_export_parts_release(parts);
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_TypeError, error.c_str());
+    return nullptr;
+  }
   return Py_None;
 }
 
+// Creates the concurrent.futures.Future handed out by the *_async functions
+static PyObject *python_future_new()
+{
+  PyObjectUniquePtr module(PyImport_ImportModule("concurrent.futures"), PyObjectDeleter);
+  if (module == nullptr) return nullptr;
+  PyObjectUniquePtr cls(PyObject_GetAttrString(module.get(), "Future"), PyObjectDeleter);
+  if (cls == nullptr) return nullptr;
+  return PyObject_CallObject(cls.get(), nullptr);
+}
+
+// Completes future with result or, if error is set, with a RuntimeError.
+// Consumes the references to future and result.
+static void python_future_finish(PyObject *future, PyObject *result, const std::string& error)
+{
+  PythonGILGuard gil;
+  PyObject *ret;
+  if (error.empty()) {
+    ret = PyObject_CallMethod(future, "set_result", "O", result);
+  } else {
+    PyObjectUniquePtr exc(PyObject_CallFunction(PyExc_RuntimeError, "s", error.c_str()), PyObjectDeleter);
+    ret = PyObject_CallMethod(future, "set_exception", "O", exc.get());
+  }
+  if (ret == nullptr) PyErr_Print();
+  Py_XDECREF(ret);
+  Py_XDECREF(result);
+  Py_DECREF(future);
+}
+
+PyObject *python_export_async_core(PyObject *obj, char *file)
+{
+  auto parts = std::make_shared<std::vector<PythonExportPart>>();
+  std::string attributes;
+  FileFormat exportFileFormat;
+  if (!python_export_prepare(obj, file, *parts, attributes, exportFileFormat)) return nullptr;
+  PyObject *future = python_future_new();
+  if (future == nullptr) {
+    python_export_parts_release(*parts);
+    return nullptr;
+  }
+
+  Py_INCREF(future);
+  Py_INCREF(Py_None);
+  python_async_submit([parts, attributes, file = std::string(file), exportFileFormat, future]() {
+    std::string error;
+    try {
+      const std::lock_guard<std::recursive_mutex> kernel(python_kernel_mutex());
+      error = python_export_write(*parts, attributes, file, exportFileFormat);
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    {
+      PythonGILGuard gil;
+      python_export_parts_release(*parts);
+    }
+    python_future_finish(future, Py_None, error);
+  });
+  return future;
+}
+
 PyObject *python_export(PyObject *self, PyObject *args, PyObject *kwargs)
 {
   PyObject *obj = NULL;
@@ -2123,6 +2413,32 @@ PyObject *python_oo_export(PyObject *obj, PyObject *args, PyObject *kwargs)
   return python_export_core(obj, file);
 }
 
+PyObject *python_export_async(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  PyObject *obj = NULL;
+  char *file= nullptr;
+  char *kwlist[] = {"obj", "file", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os", kwlist,
+                                   &obj,&file
+                                   ))  {
+    PyErr_SetString(PyExc_TypeError, "Error during parsing export_async(object, file)");
+    return NULL;
+  }
+  return python_export_async_core(obj,file);
+}
+
+PyObject *python_oo_export_async(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+  char *kwlist[] = {"file", NULL};
+  char *file = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &file
+                                   ))  {
+    PyErr_SetString(PyExc_TypeError, "Error during parsing export_async(file)");
+    return NULL;
+  }
+  return python_export_async_core(obj, file);
+}
+
 PyObject *python_find_face_core(PyObject *obj, PyObject *vec_p)
 {
   Vector3d vec;	
@@ -2136,7 +2452,7 @@ PyObject *python_find_face_core(PyObject *obj, PyObject *vec_p)
 
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 
   double dmax=-1;
@@ -2377,7 +2693,7 @@ PyObject *python_mesh_core(PyObject *obj, bool tessellate)
   }
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 
 
@@ -2466,7 +2782,7 @@ PyObject *python_bbox_core(PyObject *obj)
   }
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 
   if(ps != nullptr && ps->vertices.size() > 0){
@@ -2528,7 +2844,7 @@ PyObject *python_separate_core(PyObject *obj)
   }
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 
   if(ps != nullptr){
@@ -2635,7 +2951,7 @@ PyObject *python_edges_core(PyObject *obj)
 
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   const std::shared_ptr<const Polygon2d> poly = std::dynamic_pointer_cast<const Polygon2d>(geom);
   if(poly == nullptr) return Py_None;
   int edgenum=0;
@@ -2722,7 +3038,7 @@ PyObject *python_faces_core(PyObject *obj, bool tessellate)
 
   Tree tree(child, "");
   GeometryEvaluator geomevaluator(tree);
-  std::shared_ptr<const Geometry> geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+  std::shared_ptr<const Geometry> geom = python_evaluate_geometry(geomevaluator, *tree.root(), true);
   std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom);
 
 
@@ -4206,6 +4522,64 @@ PyObject *python_oo_render(PyObject *obj, PyObject *args, PyObject *kwargs)
   return python_render_core(obj, convexity);
 }
 
+// Like render(), but evaluates the geometry in the background right away.
+// Returns a concurrent.futures.Future resolving to the rendered object,
+// whose geometry is then served from the geometry cache.
+PyObject *python_render_async_core(PyObject *obj, int convexity)
+{
+  PyObject *rendered = python_render_core(obj, convexity);
+  if (rendered == nullptr) return nullptr;
+  PyObject *future = python_future_new();
+  if (future == nullptr) {
+    Py_DECREF(rendered);
+    return nullptr;
+  }
+
+  std::shared_ptr<AbstractNode> node = ((PyOpenSCADObject *) rendered)->node;
+  Py_INCREF(future);
+  python_async_submit([node, rendered, future]() {
+    std::string error;
+    try {
+      const std::lock_guard<std::recursive_mutex> kernel(python_kernel_mutex());
+      Tree tree(node, "");
+      GeometryEvaluator geomevaluator(tree);
+      geomevaluator.evaluateGeometry(*tree.root(), true);
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    python_future_finish(future, rendered, error);
+  });
+  return future;
+}
+
+PyObject *python_render_async(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  char *kwlist[] = {"obj", "convexity", NULL};
+  PyObject *obj = NULL;
+  long convexity = 2;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|i", kwlist,
+                                   &PyOpenSCADType, &obj,
+                                   &convexity
+                                   )) {
+    PyErr_SetString(PyExc_TypeError, "Error during parsing render_async(object)");
+    return NULL;
+  }
+  return python_render_async_core(obj, convexity);
+}
+
+PyObject *python_oo_render_async(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+  char *kwlist[] = {"convexity", NULL};
+  long convexity = 2;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", kwlist,
+                                   &convexity
+                                   )) {
+    PyErr_SetString(PyExc_TypeError, "Error during parsing render_async(object)");
+    return NULL;
+  }
+  return python_render_async_core(obj, convexity);
+}
+
 PyObject *python_surface_core(const char *file, PyObject *center, PyObject *invert, int convexity)
 {
   DECLARE_INSTANCE
@@ -4333,6 +4707,7 @@ PyObject *python_textmetrics(PyObject *self, PyObject *args, PyObject *kwargs)
   if (halign != NULL) ftparams.set_valign(valign);
   ftparams.set_loc(instance->location());
 
+  PythonKernelGuard kernel; // the font caches are shared with background jobs
   FreetypeRenderer::TextMetrics metrics(ftparams);
   if (!metrics.ok) {
     PyErr_SetString(PyExc_TypeError, "Invalid Metric");
@@ -4404,7 +4779,7 @@ PyObject *python_osversion_num(PyObject *self, PyObject *args, PyObject *kwargs)
 }
 
 
-PyObject *python_offset_core(PyObject *obj,double r, double delta, PyObject *chamfer, double fn, double fa, double fs)
+PyObject *python_offset_core(PyObject *obj,double r, double delta, PyObject *chamfer, char *method, double resolution, double fn, double fa, double fs)
 {
   DECLARE_INSTANCE
   auto node = std::make_shared<OffsetNode>(instance);
@@ -4440,42 +4815,56 @@ PyObject *python_offset_core(PyObject *obj,double r, double delta, PyObject *cha
         return NULL;
     }
   }
+  if (method != NULL) {
+    node->method = method;
+    if (node->method != "prisms" && node->method != "levelset") {
+      PyErr_SetString(PyExc_TypeError, "Unknown offset method, use \"prisms\" or \"levelset\"");
+      return NULL;
+    }
+  }
+  if (!isnan(resolution)) node->resolution = resolution;
   node->children.push_back(child);
   return PyOpenSCADObjectFromNode(&PyOpenSCADType, node);
 }
 
 PyObject *python_offset(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-  char *kwlist[] = {"obj", "r", "delta", "chamfer", "fn", "fa", "fs", NULL};
+  char *kwlist[] = {"obj", "r", "delta", "chamfer", "fn", "fa", "fs", "method", "resolution", NULL};
   PyObject *obj = NULL;
   double r = NAN, delta = NAN;
   PyObject *chamfer = NULL;
   double fn = NAN, fa = NAN, fs = NAN;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ddOddd", kwlist,
+  char *method = NULL;
+  double resolution = NAN;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ddOdddsd", kwlist,
                                    &obj,
                                    &r, &delta, &chamfer,
-                                   &fn, &fa, &fs
+                                   &fn, &fa, &fs,
+                                   &method, &resolution
                                    )) {
     PyErr_SetString(PyExc_TypeError, "Error during parsing offset(object,r,delta)");
     return NULL;
   }
-  return python_offset_core(obj,r, delta, chamfer, fn, fa, fs);
+  return python_offset_core(obj,r, delta, chamfer, method, resolution, fn, fa, fs);
 }
 
 PyObject *python_oo_offset(PyObject *obj, PyObject *args, PyObject *kwargs)
 {
-  char *kwlist[] = {"r", "delta", "chamfer", "fn", "fa", "fs", NULL};
+  char *kwlist[] = {"r", "delta", "chamfer", "fn", "fa", "fs", "method", "resolution", NULL};
   double r = NAN, delta = NAN;
   PyObject *chamfer = NULL;
   double fn = NAN, fa = NAN, fs = NAN;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ddOddd", kwlist,
+  char *method = NULL;
+  double resolution = NAN;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ddOdddsd", kwlist,
                                    &r, &delta, &chamfer,
-                                   &fn, &fa, &fs
+                                   &fn, &fa, &fs,
+                                   &method, &resolution
                                    )) {
     PyErr_SetString(PyExc_TypeError, "Error during parsing offset(object,r,delta)");
     return NULL;
   }
-  return python_offset_core(obj,r, delta, chamfer, fn, fa, fs);
+  return python_offset_core(obj,r, delta, chamfer, method, resolution, fn, fa, fs);
 }
 
 PyObject *python_projection_core(PyObject *obj, PyObject *cut, int convexity)
@@ -4865,6 +5254,7 @@ PyObject *python_scad(PyObject *self, PyObject *args, PyObject *kwargs)
     return NULL;
   }
 
+  PythonKernelGuard kernel;
   SourceFile *parsed_file = NULL;
   if(!parse(parsed_file, code, "python", "python", false)) {
     PyErr_SetString(PyExc_TypeError, "Error in SCAD code");
@@ -4899,6 +5289,7 @@ PyObject *python_osuse_include(int mode, PyObject *self, PyObject *args, PyObjec
   const std::string filename = lookup_file(file, python_scriptpath.parent_path().u8string(),".");
   stream << "include <" << filename << ">\n";
 
+  PythonKernelGuard kernel;
   SourceFile *source;
   if(!parse(source, stream.str(), "python", "python", false)) {
     PyErr_SetString(PyExc_TypeError, "Error in SCAD code");
@@ -5105,6 +5496,7 @@ PyMethodDef PyOpenSCADFunctions[] = {
   {"show", (PyCFunction) python_show, METH_VARARGS | METH_KEYWORDS, "Show the result."},
   {"separate", (PyCFunction) python_separate, METH_VARARGS | METH_KEYWORDS, "Split into separate parts."},
   {"export", (PyCFunction) python_export, METH_VARARGS | METH_KEYWORDS, "Export the result."},
+  {"export_async", (PyCFunction) python_export_async, METH_VARARGS | METH_KEYWORDS, "Export the result in the background."},
   {"find_face", (PyCFunction) python_find_face, METH_VARARGS | METH_KEYWORDS, "find_face."},
   {"sitonto", (PyCFunction) python_sitonto, METH_VARARGS | METH_KEYWORDS, "sitonto"},
 
@@ -5139,6 +5531,7 @@ PyMethodDef PyOpenSCADFunctions[] = {
 
   {"group", (PyCFunction) python_group, METH_VARARGS | METH_KEYWORDS, "Group Object."},
   {"render", (PyCFunction) python_render, METH_VARARGS | METH_KEYWORDS, "Render Object."},
+  {"render_async", (PyCFunction) python_render_async, METH_VARARGS | METH_KEYWORDS, "Render Object in the background."},
   {"osimport", (PyCFunction) python_import, METH_VARARGS | METH_KEYWORDS, "Import Object."},
   {"osuse", (PyCFunction) python_osuse, METH_VARARGS | METH_KEYWORDS, "Use OpenSCAD Library."},
   {"osinclude", (PyCFunction) python_osinclude, METH_VARARGS | METH_KEYWORDS, "Include OpenSCAD Library."},
@@ -5198,6 +5591,7 @@ PyMethodDef PyOpenSCADMethods[] = {
   OO_METHOD_ENTRY(color,"Color Object")	
   OO_METHOD_ENTRY(separate,"Split into separate Objects")	
   OO_METHOD_ENTRY(export,"Export Object")	
+  OO_METHOD_ENTRY(export_async,"Export Object in the background")
   OO_METHOD_ENTRY(find_face,"Find Face")	
   OO_METHOD_ENTRY(sitonto,"Sit onto")	
 
@@ -5224,6 +5618,7 @@ PyMethodDef PyOpenSCADMethods[] = {
   OO_METHOD_ENTRY(pull,"Pull Obejct apart")	
   OO_METHOD_ENTRY(wrap,"Wrap Object around Cylinder")	
   OO_METHOD_ENTRY(render,"Render Object")	
+  OO_METHOD_ENTRY(render_async,"Render Object in the background")
   OO_METHOD_ENTRY(dict,"return all dictionary")	
   {NULL, NULL, 0, NULL}
 };
@@ -25,11 +25,16 @@
  */
 #include <Python.h>
 #include "genlang/genlang.h"
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
+#include <thread>
 
 #include "pyopenscad.h"
 #include "pydata.h"
 #include "core/CsgOpNode.h"
+#include "geometry/GeometryEvaluator.h"
 #include "Value.h"
 #include "Expression.h"
 #include "PlatformUtils.h"
@@ -125,6 +130,159 @@ void python_unlock(void) {
   if(pythonInitDict != nullptr)	tstate = PyEval_SaveThread();
 //#endif  
 }
+
+namespace {
+thread_local bool thread_gil_held = false;
+thread_local PyGILState_STATE thread_gil_state;
+} // namespace
+
+void python_thread_lock(void)
+{
+  if (pythonInitDict == nullptr || thread_gil_held) return;
+  thread_gil_state = PyGILState_Ensure();
+  thread_gil_held = true;
+}
+
+void python_thread_unlock(void)
+{
+  if (!thread_gil_held) return;
+  thread_gil_held = false;
+  PyGILState_Release(thread_gil_state);
+}
+
+void python_set_result_obj(PyObject *obj)
+{
+  Py_XINCREF(obj);
+  Py_XDECREF(python_result_obj);
+  python_result_obj = obj;
+}
+
+std::recursive_mutex& python_kernel_mutex()
+{
+  static std::recursive_mutex kernel_mutex;
+  return kernel_mutex;
+}
+
+// The GIL is released before waiting for the kernel lock, so a thread
+// holding the kernel lock can always get the GIL back for callbacks.
+PythonAllowThreads::PythonAllowThreads() : state(PyEval_SaveThread()), kernel_lock(python_kernel_mutex())
+{
+}
+
+PythonAllowThreads::~PythonAllowThreads()
+{
+  kernel_lock.unlock();
+  PyEval_RestoreThread(state);
+}
+
+PythonKernelGuard::PythonKernelGuard()
+{
+  PyThreadState *state = PyEval_SaveThread();
+  kernel_lock = std::unique_lock<std::recursive_mutex>(python_kernel_mutex());
+  PyEval_RestoreThread(state);
+}
+
+std::shared_ptr<const Geometry> python_evaluate_geometry(GeometryEvaluator& evaluator, const AbstractNode& node, bool allownef)
+{
+  PythonAllowThreads allow;
+  return evaluator.evaluateGeometry(node, allownef);
+}
+
+namespace {
+
+// Background thread running the jobs of render_async() and export_async() one
+// after the other. Jobs take the kernel lock, so this only overlaps rendering
+// with the Python code of the caller, it doesn't render in parallel.
+class AsyncRenderQueue
+{
+public:
+  void submit(std::function<void()> job) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!worker.joinable()) worker = std::thread([this]() { run(); });
+    jobs.push_back(std::move(job));
+    ++pending;
+    wakeup.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return pending == 0; });
+  }
+
+  // Finishes all jobs and joins the thread. A later submit() starts a new one.
+  void shutdown() {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      idle.wait(lock, [this]() { return pending == 0; });
+      stopping = true;
+    }
+    wakeup.notify_one();
+    if (worker.joinable()) worker.join();
+    const std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+  }
+
+private:
+  void run() {
+    for (;;) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeup.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job();
+      {
+        const std::lock_guard<std::mutex> lock(mutex);
+        --pending;
+      }
+      idle.notify_all();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wakeup, idle;
+  std::deque<std::function<void()>> jobs;
+  size_t pending{0};
+  bool stopping{false};
+  std::thread worker;
+};
+
+// Never destroyed: when Python isn't finalized, the idle worker is still
+// joinable at static destruction
+AsyncRenderQueue *async_queue = new AsyncRenderQueue;
+
+// Registered with atexit, so jobs finish while the interpreter is still usable
+PyObject *python_async_atexit(PyObject *, PyObject *)
+{
+  python_async_shutdown();
+  Py_RETURN_NONE;
+}
+
+PyMethodDef python_async_atexit_def = {"_async_shutdown", python_async_atexit, METH_NOARGS, nullptr};
+
+} // namespace
+
+void python_async_submit(std::function<void()> job)
+{
+  async_queue->submit(std::move(job));
+}
+
+void python_async_wait()
+{
+  Py_BEGIN_ALLOW_THREADS
+  async_queue->wait();
+  Py_END_ALLOW_THREADS
+}
+
+void python_async_shutdown()
+{
+  Py_BEGIN_ALLOW_THREADS
+  async_queue->shutdown();
+  Py_END_ALLOW_THREADS
+}
 /*
  *  extracts Absrtract Node from PyOpenSCAD Object
  */
@@ -419,6 +577,7 @@ std::vector<Vector3d> python_vectors(PyObject *vec, int mindim, int maxdim, int
  */
 
 void get_fnas(double& fn, double& fa, double& fs) {
+  PythonGILGuard gil;
   PyObject *mainModule = PyImport_AddModule("__main__");
   if (mainModule == nullptr) return;
   fn=0;
@@ -458,21 +617,64 @@ static int PyOpenSCADInit(PyOpenSCADObject *self, PyObject *args, PyObject *kwds
   (void)kwds;
   return 0;
 }
+/*
+ * Evaluates a profile function given as r(arg, angle) for all fn angles in
+ * a single call with a numpy array of angles. Returns false if numpy is
+ * missing or the function does not return one radius per angle, in which
+ * case the caller samples the angles one by one.
+ */
+static bool python_getprofile_radii(PyObject *cbfunc, int fn, double arg, std::vector<double>& radii)
+{
+	if(fn <= 0) return false;
+	PyObjectUniquePtr numpy(PyImport_ImportModule("numpy"), PyObjectDeleter);
+	if(numpy == nullptr) {
+		PyErr_Clear();
+		return false;
+	}
+	PyObjectUniquePtr angles(PyList_New(fn), PyObjectDeleter);
+	for(int i=0;i < fn;i++)
+		PyList_SetItem(angles.get(), i, PyFloat_FromDouble(360.0*(i/(double) fn)));
+	PyObjectUniquePtr array(PyObject_CallMethod(numpy.get(), "array", "O", angles.get()), PyObjectDeleter);
+	PyObjectUniquePtr pyarg(PyFloat_FromDouble(arg), PyObjectDeleter);
+	PyObjectUniquePtr result(array == nullptr ? nullptr : PyObject_CallFunctionObjArgs(cbfunc, pyarg.get(), array.get(), nullptr), PyObjectDeleter);
+	PyObjectUniquePtr values(result == nullptr || !PySequence_Check(result.get()) ? nullptr : PySequence_Fast(result.get(), ""), PyObjectDeleter);
+	if(values == nullptr || PySequence_Fast_GET_SIZE(values.get()) != fn) {
+		PyErr_Clear();
+		return false;
+	}
+	radii.resize(fn);
+	for(int i=0;i < fn;i++)
+		radii[i]=PyFloat_AsDouble(PySequence_Fast_GET_ITEM(values.get(), i));
+	if(PyErr_Occurred()) {
+		PyErr_Clear();
+		return false;
+	}
+	return true;
+}
+
 Outline2d python_getprofile(void *v_cbfunc, int fn, double arg)
 {
 	PyObject *cbfunc = (PyObject *) v_cbfunc;
 	Outline2d result;
 	if(pythonInitDict == NULL)  initPython(PlatformUtils::applicationPath(),"", 0.0);
+	PythonGILGuard gil;
 	PyObject* args = PyTuple_Pack(1,PyFloat_FromDouble(arg));
 	PyObject* polygon = PyObject_CallObject(cbfunc, args);
         Py_XDECREF(args);
 	if(polygon == NULL) { // TODO fix
+		PyErr_Clear();
+		std::vector<double> radii;
+		const bool batched = python_getprofile_radii(cbfunc, fn, arg, radii);
 		for(unsigned int i=0;i < (unsigned int) fn;i++) {
 			double ang=360.0*(i/(double) fn);
-			PyObject* args = PyTuple_Pack(2,PyFloat_FromDouble(arg),PyFloat_FromDouble(ang));
-			Py_XINCREF(args);
-			PyObject* pypt = PyObject_CallObject(cbfunc, args);
-			double r=PyFloat_AsDouble(pypt);
+			double r;
+			if(batched) r=radii[i];
+			else {
+				PyObject* args = PyTuple_Pack(2,PyFloat_FromDouble(arg),PyFloat_FromDouble(ang));
+				Py_XINCREF(args);
+				PyObject* pypt = PyObject_CallObject(cbfunc, args);
+				r=PyFloat_AsDouble(pypt);
+			}
 			if(r < 0) r=-r;  // TODO who the hell knows, why this is needed
 			double ang1=ang*3.1415/180.0;
 			double x=r*cos(ang1);
@@ -505,6 +707,7 @@ double python_doublefunc(void *v_cbfunc, double arg)
 {
 	PyObject *cbfunc = (PyObject *) v_cbfunc;
 	double result=0;
+	PythonGILGuard gil;
 	PyObject* args = PyTuple_Pack(1,PyFloat_FromDouble(arg));
 	PyObject* funcresult = PyObject_CallObject(cbfunc, args);
 	Py_XDECREF(args);
@@ -972,6 +1175,7 @@ stderr_bak = None\n\
 #endif
     PyObjectUniquePtr result(nullptr, PyObjectDeleter);
     result.reset(PyRun_String(code.c_str(), Py_file_input, pythonInitDict.get(), pythonInitDict.get())); /* actual code is run here */
+    python_async_wait(); // finish render_async()/export_async() jobs the script did not wait for
 
 
 #ifndef OPENSCAD_NOGUI
@@ -1137,7 +1341,21 @@ static PyModuleDef OpenSCADModule = {
 
 extern "C" PyObject *PyInit_openscad(void)
 {
-  return PyModule_Create(&OpenSCADModule);
+  PyObject *module = PyModule_Create(&OpenSCADModule);
+  if (module == nullptr) return nullptr;
+  // Join the render_async() thread before the interpreter is finalized
+  PyObjectUniquePtr atexit(PyImport_ImportModule("atexit"), PyObjectDeleter);
+  PyObjectUniquePtr shutdown(PyCFunction_New(&python_async_atexit_def, nullptr), PyObjectDeleter);
+  if (atexit == nullptr || shutdown == nullptr) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  PyObjectUniquePtr registered(PyObject_CallMethod(atexit.get(), "register", "O", shutdown.get()), PyObjectDeleter);
+  if (registered == nullptr) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
 }
 
 PyMODINIT_FUNC PyInit_PyOpenSCAD(void)
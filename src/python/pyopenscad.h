@@ -1,5 +1,7 @@
 #include <Python.h>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include "python_public.h"
 #include "geometry/Polygon2d.h"
 #include "core/node.h"
@@ -24,6 +26,8 @@ PyMODINIT_FUNC PyInit_PyOpenSCAD(void);
 extern PyTypeObject PyOpenSCADType;
 
 extern PyObject *python_result_obj;
+// Replaces python_result_obj, holding a reference to obj. Needs the GIL.
+void python_set_result_obj(PyObject *obj);
 extern std::vector<SelectedObject> python_result_handle;
 extern void python_catch_error(std::string &errorstr);
 
@@ -54,6 +58,75 @@ PyObject *python_fromopenscad(const Value &val);
 
 extern SourceFile *osinclude_source;
 
+/*
+ * Holds the GIL while Python is called back from geometry evaluation
+ * (profile functions, function based sphere() etc.), which may run on a
+ * thread that does not own it at that point. Nests inside
+ * python_thread_lock(), but not inside python_lock() on a worker thread, as
+ * that runs with the thread state of the main thread.
+ */
+class PythonGILGuard
+{
+public:
+  PythonGILGuard() : state(PyGILState_Ensure()) {}
+  ~PythonGILGuard() { PyGILState_Release(state); }
+  PythonGILGuard(const PythonGILGuard&) = delete;
+  PythonGILGuard& operator=(const PythonGILGuard&) = delete;
+private:
+  PyGILState_STATE state;
+};
+
+/*
+ * Releases the GIL while C++ geometry kernels run, so other Python threads
+ * can make progress. The kernels themselves are still run one at a time,
+ * as the geometry caches and the evaluator state are shared.
+ */
+class PythonAllowThreads
+{
+public:
+  PythonAllowThreads();
+  ~PythonAllowThreads();
+  PythonAllowThreads(const PythonAllowThreads&) = delete;
+  PythonAllowThreads& operator=(const PythonAllowThreads&) = delete;
+private:
+  PyThreadState *state;
+  std::unique_lock<std::recursive_mutex> kernel_lock;
+};
+
+/*
+ * Takes the kernel lock while keeping the GIL, for work on the calling
+ * thread which uses the shared caches but may call back into Python, like
+ * instantiating SCAD code or measuring text. The GIL is released while
+ * waiting, so a background job can finish first.
+ */
+class PythonKernelGuard
+{
+public:
+  PythonKernelGuard();
+  PythonKernelGuard(const PythonKernelGuard&) = delete;
+  PythonKernelGuard& operator=(const PythonKernelGuard&) = delete;
+private:
+  std::unique_lock<std::recursive_mutex> kernel_lock;
+};
+
+class GeometryEvaluator;
+class Geometry;
+std::shared_ptr<const Geometry> python_evaluate_geometry(GeometryEvaluator& evaluator, const AbstractNode& node, bool allownef);
+// Lock serializing geometry kernels started from Python
+std::recursive_mutex& python_kernel_mutex();
+// Runs job on the background render thread of render_async()/export_async().
+// Jobs run one at a time and hold the kernel lock while evaluating, so they
+// only overlap with Python code of the caller and never run alongside
+// evaluation on the calling thread, which takes the lock through
+// PythonAllowThreads or PythonKernelGuard. Evaluation outside of Python
+// only starts after evaluatePython() waited for all jobs.
+void python_async_submit(std::function<void()> job);
+// Waits for all background jobs, releasing the GIL meanwhile
+void python_async_wait();
+// Waits for all background jobs and joins the thread, called when the
+// interpreter exits
+void python_async_shutdown();
+
 PyObject *python_str(PyObject *self);
 
 extern PyNumberMethods PyOpenSCADNumbers;
@@ -15,8 +15,14 @@ std::string python_version(void);
 void initPython(const std::string& binDir, const std::string &scriptPath, double time);
 std::string evaluatePython(const std::string &code, bool dry_run=false);
 void finishPython();
+// Hand the GIL of the main thread over to a worker thread and back
 void python_lock(void);
 void python_unlock(void);
+// Take and release the GIL on a worker thread after python_unlock(), with a
+// thread state of the worker's own, so Python callbacks from evaluation on
+// that thread can take the GIL again through PyGILState_Ensure()
+void python_thread_lock(void);
+void python_thread_unlock(void);
 void ipython(void);
 
 
@@ -8,7 +8,8 @@ class StackCheck
 public:
   static StackCheck& inst()
   {
-    static StackCheck instance;
+    // Per thread, as the stack depth is measured from the first use
+    static thread_local StackCheck instance;
     return instance;
   }
 
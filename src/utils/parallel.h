@@ -2,13 +2,32 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <vector>
 
 #if ENABLE_TBB
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #endif
 
+/*
+ * Calls op(i) for each index in [begin, end), in parallel if possible.
+ * op must be safe to call concurrently for different indices.
+ */
+template <class Operation>
+void parallelizable_for(size_t begin, size_t end, const Operation &op) {
+#if ENABLE_TBB
+  if (!getenv("OPENSCAD_NO_PARALLEL")) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end), [&](const tbb::blocked_range<size_t> &range) {
+      for (size_t i = range.begin(); i != range.end(); ++i) op(i);
+    });
+    return;
+  }
+#endif
+  for (size_t i = begin; i != end; ++i) op(i);
+}
+
 template <class InputIterator, class OutputIterator, class Operation>
 void parallelizable_transform(const InputIterator begin1,
                               const InputIterator end1, OutputIterator out,
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -19,6 +20,7 @@ namespace fs = std::filesystem;
 
 std::set<std::string> printedDeprecations;
 std::list<std::string> print_messages_stack;
+std::atomic<size_t> print_messages_count{0};
 OutputHandlerFunc *outputhandler = nullptr;
 void *outputhandler_data = nullptr;
 std::string OpenSCAD::debug("");
@@ -36,6 +38,8 @@ OutputHandlerFunc2 *outputhandler2 = nullptr;
 boost::circular_buffer<std::string> lastmessages(5);
 boost::circular_buffer<struct Message> lastlogmessages(5);
 
+// Serializes output, e.g. from animation frames being exported in the background
+std::recursive_mutex print_mutex;
 int count = 0;
 bool no_throw;
 bool deferred;
@@ -82,6 +86,8 @@ void print_messages_pop()
 
 void PRINT(const Message& msgObj)
 {
+  const std::lock_guard<std::recursive_mutex> lock(print_mutex);
+  print_messages_count++;
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
 
   if (print_messages_stack.size() > 0) {
@@ -104,6 +110,7 @@ void PRINT(const Message& msgObj)
 void PRINT_NOCACHE(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  const std::lock_guard<std::recursive_mutex> lock(print_mutex);
 
   const auto msg = msgObj.str();
 
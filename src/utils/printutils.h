@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <clocale>
 #include <initializer_list>
@@ -102,6 +103,8 @@ void no_exceptions_for_warnings();
 bool would_have_thrown();
 
 extern std::list<std::string> print_messages_stack;
+// Number of messages passed to PRINT() so far
+extern std::atomic<size_t> print_messages_count;
 void print_messages_push();
 void print_messages_pop();
 void resetSuppressedMessages();
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+# Animation export test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# step 1. Export 8 frames of the input file, which are spread over worker processes.
+# step 2. Export them again with OPENSCAD_NO_PARALLEL set, all in one process.
+# step 3. Check that both exports produced the same files for all frames.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, shutil, subprocess, argparse, tempfile, filecmp
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('animate_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting animate_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = os.path.abspath(remaining_args[0])
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+frames = 8
+tmpdir = tempfile.mkdtemp(prefix='openscad-animate-')
+try:
+    outputs = {}
+    for mode in ['parallel', 'sequential']:
+        outdir = os.path.join(tmpdir, mode)
+        os.makedirs(outdir)
+        env = os.environ.copy()
+        env.pop('OPENSCAD_NO_PARALLEL', None)
+        if mode == 'sequential': env['OPENSCAD_NO_PARALLEL'] = '1'
+        cmd = [args.openscad, inputfile, '-o', os.path.join(outdir, 'frame.stl'), '--animate', str(frames)] + remaining_args
+        print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+        result = subprocess.call(cmd, env=env)
+        if result != 0:
+            failquit('OpenSCAD failed with return code ' + str(result))
+        outputs[mode] = sorted(os.listdir(outdir))
+
+    expected = ['frame%05d.stl' % frame for frame in range(frames)]
+    for mode, files in outputs.items():
+        if files != expected:
+            failquit('Unexpected ' + mode + ' frames', files)
+    for name in expected:
+        if not filecmp.cmp(os.path.join(tmpdir, 'parallel', name), os.path.join(tmpdir, 'sequential', name), shallow=False):
+            failquit('Frame differs between parallel and sequential export: ' + name)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+# Cache summary test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> --expect=<path><op><value>... [<openscad args>] outputfile
+#
+# step 1. Export the input file to STL, writing a summary of the caches with
+#         --summary cache --summary-file.
+# step 2. Check each --expect against the summary. Path is a dot separated
+#         key path below "cache", op is == or >=, e.g.
+#         --expect=geometry_cache.hits>=1
+#
+# The script is self-contained, it doesn't write to the output file.
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, json, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('cache_summary_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting cache_summary_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('--expect', action='append', default=[], help='Expected summary value, <path><op><value>')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+expectations = []
+for expect in args.expect:
+    match = re.fullmatch(r'([\w.]+)(==|>=)(\d+)', expect)
+    if not match:
+        failquit('Malformed expectation: ' + expect)
+    expectations.append((match.group(1), match.group(2), int(match.group(3))))
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-cache-summary-')
+try:
+    summaryfile = os.path.join(tmpdir, 'summary.json')
+    cmd = [args.openscad, inputfile, '-o', os.path.join(tmpdir, 'out.stl'),
+           '--summary', 'cache', '--summary-file', summaryfile] + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    if subprocess.call(cmd) != 0:
+        failquit('OpenSCAD failed')
+
+    with open(summaryfile) as f:
+        cache = json.load(f).get('cache')
+    if cache is None:
+        failquit('No cache statistic in the summary')
+    for path, op, expected in expectations:
+        value = cache
+        for key in path.split('.'):
+            if not isinstance(value, dict) or key not in value:
+                failquit('Missing ' + path + ' in the cache summary', cache)
+            value = value[key]
+        if not (value == expected if op == '==' else value >= expected):
+            failquit('Expected ' + path + op + str(expected) + ', got ' + str(value), cache)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
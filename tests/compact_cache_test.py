@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+
+# Compact geometry cache test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# step 1. Run OpenSCAD on the input file, exporting a PNG, or a binary STL
+#         with --compare=stl.
+# step 2. Run it again with --enable=compact-geometry-cache, so geometry
+#         served from the cache has been encoded and decoded.
+# step 3. Check that both images are the same, or that both STL files are
+#         byte for byte identical.
+#
+# The script is self-contained, it doesn't write to the output file.
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, shutil, subprocess, argparse, tempfile, filecmp
+from image_compare import CompareImageFiles
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('compact_cache_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting compact_cache_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('--compare', choices=['png', 'stl'], default='png', help='Output to compare')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+fontdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "data/ttf"))
+env = os.environ.copy()
+env["OPENSCAD_FONT_PATH"] = fontdir
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-compact-cache-')
+try:
+    outputs = []
+    format_args = ['--export-format=binstl'] if args.compare == 'stl' else []
+    for name, extra_args in [('plain', []), ('compact', ['--enable=compact-geometry-cache'])]:
+        output = os.path.join(tmpdir, name + '.' + args.compare)
+        cmd = [args.openscad, inputfile, '-o', output] + format_args + remaining_args + extra_args
+        print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+        if subprocess.call(cmd, env=env) != 0:
+            failquit('OpenSCAD failed')
+        outputs.append(output)
+    if args.compare == 'stl':
+        if not filecmp.cmp(outputs[0], outputs[1], shallow=False):
+            failquit('Meshes differ with the compact geometry cache')
+    elif not CompareImageFiles(outputs[0], outputs[1]):
+        failquit('Images differ with the compact geometry cache')
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,48 @@
+# Function based sphere() and profile callbacks are sampled in batches with
+# numpy arrays if the function accepts them. The meshes must be the same as
+# with functions which only take single values, which are sampled one by one.
+# Prints PASSED if they are.
+from openscad import *
+
+batched_calls = 0
+
+def radius(d):
+    global batched_calls
+    if not isinstance(d[0], float): batched_calls += 1
+    return 10 + 2*d[0]*d[0] - 3*d[1]*d[2]
+
+def radius_scalar(d):
+    x, y, z = d
+    return float(10 + 2*x*x - 3*y*z)
+
+def profile(h, a):
+    global batched_calls
+    if not isinstance(a, float): batched_calls += 1
+    return 5 + 0.1*h + 0.01*a
+
+def profile_scalar(h, a):
+    return float(5 + 0.1*h + 0.01*a)
+
+def same_mesh(a, b):
+    points_a, faces_a = a.mesh()
+    points_b, faces_b = b.mesh()
+    return points_a == points_b and faces_a == faces_b
+
+try:
+    import numpy
+    have_numpy = True
+except ImportError:
+    have_numpy = False
+
+spheres = [sphere(radius, fs=0.5, fn=5), sphere(radius_scalar, fs=0.5, fn=5)]
+extrusions = [linear_extrude(profile, height=10, slices=4, fn=16),
+              linear_extrude(profile_scalar, height=10, slices=4, fn=16)]
+results = {
+    'sphere': same_mesh(*spheres),
+    'profile': same_mesh(*extrusions),
+    'batched': batched_calls > 0 or not have_numpy,
+}
+print(results)
+if all(results.values()):
+    print('PASSED')
+spheres[0].show()
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+# Garbage collection test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# step 1. Run OpenSCAD on gc-recursion.scad with "--summary evaluation",
+#         which creates enough garbage contexts for several collections.
+# step 2. Check the echoed results of the recursive functions.
+# step 3. Check that the summary reports the collections and collected contexts.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, json, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('gc_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting gc_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-gc-')
+try:
+    summaryfile = os.path.join(tmpdir, 'summary.json')
+    cmd = [args.openscad, inputfile, '-o', os.path.join(tmpdir, 'out.stl'),
+           '--summary', 'evaluation', '--summary-file', summaryfile] + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    result = subprocess.run(cmd, stderr=subprocess.PIPE, universal_newlines=True)
+    print(result.stderr, file=sys.stderr)
+    if result.returncode != 0:
+        failquit('OpenSCAD failed with return code ' + str(result.returncode))
+
+    echoes = dict(re.findall(r'ECHO: (\w+) = (\S+)', result.stderr))
+    for name in ['sum', 'nested']:
+        if echoes.get(name) != 'true':
+            failquit('Unexpected result of ' + name + '()', echoes.get(name))
+
+    with open(summaryfile) as f:
+        gc = json.load(f).get('evaluation', {}).get('garbage_collection')
+    if gc is None:
+        failquit('No garbage collection statistic in the summary')
+    if gc['minor_collections'] < 1:
+        failquit('Expected minor collections', gc)
+    if gc['contexts_collected'] < 1:
+        failquit('Expected the make() contexts to be collected', gc)
+    if gc['max_pause_us'] > gc['total_pause_us']:
+        failquit('Max pause exceeds total pause', gc)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+# Hull test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# The input file echoes its points as "points = [...]" and exports the hull of
+# small cubes around them.
+#
+# step 1. Run OpenSCAD on the input file to get the echoed points.
+# step 2. Export the hull to STL.
+# step 3. Check that the hull is a closed mesh, that it is convex and that
+#         all points are inside of it.
+#
+# The script is self-contained, it doesn't write to the output file.
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, ast, shutil, subprocess, argparse, tempfile
+import numpy as np
+from validatestl import read_stl, validateSTL
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('hull_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting hull_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+def run(output):
+    cmd = [args.openscad, inputfile, '-o', output] + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    if subprocess.call(cmd) != 0:
+        failquit('OpenSCAD failed')
+
+# Points further outside of a face plane than this fail the test
+TOLERANCE = 1e-4
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-hull-')
+try:
+    echofile = os.path.join(tmpdir, 'points.echo')
+    stlfile = os.path.join(tmpdir, 'hull.stl')
+    run(echofile)
+    run(stlfile)
+
+    points = None
+    with open(echofile) as f:
+        for line in f:
+            if line.startswith('ECHO: points = '):
+                points = np.array(ast.literal_eval(line[len('ECHO: points = '):].strip()), dtype=float)
+    if points is None:
+        failquit('No points echoed')
+
+    if not validateSTL(stlfile):
+        failquit('Hull is not a valid closed mesh')
+    mesh = read_stl(stlfile)
+    vertices = np.array(mesh.points, dtype=float)
+    triangles = vertices[np.array(mesh.triangles)]
+    normals = np.cross(triangles[:, 1] - triangles[:, 0], triangles[:, 2] - triangles[:, 0])
+    lengths = np.linalg.norm(normals, axis=1)
+    normals = normals[lengths > 0] / lengths[lengths > 0, None]
+    origins = triangles[lengths > 0, 0]
+    offsets = np.einsum('ij,ij->i', normals, origins)
+
+    # Outward facing planes: every hull vertex and every point lies on their inner side
+    scale = max(1.0, np.abs(points).max())
+    for name, check in [('hull vertex', vertices), ('point', points)]:
+        for chunk in np.array_split(check, max(1, len(check) // 256)):
+            distance = (chunk @ normals.T - offsets).max()
+            if distance > TOLERANCE * scale:
+                failquit('A ' + name + ' lies outside of the hull by ' + str(distance))
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
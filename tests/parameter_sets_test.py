@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+
+# Multiple parameter set export test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> -p <file.json> -P <set> -P <set> ... [<openscad args>] outputfile
+#
+# step 1. Run OpenSCAD once on the input file, exporting every given parameter set
+#         to its own file through a {set} placeholder in the output name.
+# step 2. Check that one output per set was written and concatenate them, in the
+#         order the sets were given, into the output file.
+# step 3. Run OpenSCAD again with an additional set name which is not in the
+#         parameter file, which must fail with an error naming it.
+# step 4. (done in CTest) - compare the output file to the expected output.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('parameter_sets_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting parameter_sets_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('-P', dest='sets', action='append', required=True, help='Parameter set to export')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+outputfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+suffix = os.path.splitext(outputfile)[1]
+outputdir = tempfile.mkdtemp(prefix='openscad-sets-')
+try:
+    setargs = [arg for name in args.sets for arg in ['-P', name]]
+    cmd = [args.openscad, inputfile, '-o', os.path.join(outputdir, 'out-{set}' + suffix)] + setargs + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    result = subprocess.call(cmd)
+    if result != 0:
+        failquit('OpenSCAD failed with return code ' + str(result))
+
+    written = sorted(os.listdir(outputdir))
+    expected = sorted('out-' + name + suffix for name in args.sets)
+    if written != expected:
+        failquit('Expected outputs ' + str(expected) + ', got ' + str(written))
+    with open(outputfile, 'wb') as out:
+        for name in args.sets:
+            with open(os.path.join(outputdir, 'out-' + name + suffix), 'rb') as f:
+                out.write(f.read())
+
+    unknown = 'no-such-set'
+    cmd = cmd + ['-P', unknown]
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    result = subprocess.run(cmd, stderr=subprocess.PIPE, universal_newlines=True)
+    print(result.stderr, file=sys.stderr)
+    if result.returncode == 0:
+        failquit('OpenSCAD accepted the unknown parameter set ' + unknown)
+    if result.stderr.count("Parameter set '" + unknown + "' not found") != 1:
+        failquit('Expected one error about the unknown parameter set ' + unknown)
+finally:
+    shutil.rmtree(outputdir, ignore_errors=True)
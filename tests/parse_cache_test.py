@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+
+# Parse cache invalidation test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# The input file must include a file which assigns "value = 1;" and echo the value.
+#
+# step 1. Copy the input file and the file it includes to a temporary folder.
+# step 2. Run OpenSCAD twice with an empty user folder and the parse cache enabled;
+#         the second run must use the cached parse result.
+# step 3. Change the included file to assign "value = 2;".
+# step 4. Run OpenSCAD again; it must not use the cached parse result and must
+#         echo the new value. A last run must use the updated cache entry.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('parse_cache_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting parse_cache_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-parse-cache-')
+try:
+    home = os.path.join(tmpdir, 'home')
+    srcdir = os.path.join(tmpdir, 'src')
+    # The user folder is only used if the documents folder exists
+    os.makedirs(os.path.join(home, '.local', 'share'))
+    os.makedirs(srcdir)
+    with open(inputfile) as f:
+        included = re.search(r'include <([^>]+)>', f.read()).group(1)
+    mainfile = os.path.join(srcdir, os.path.basename(inputfile))
+    shutil.copy(inputfile, mainfile)
+    shutil.copy(os.path.join(os.path.dirname(inputfile), included), os.path.join(srcdir, included))
+    env = os.environ.copy()
+    env["HOME"] = home
+
+    def run(expected_value, expect_hit):
+        echofile = os.path.join(tmpdir, 'out.echo')
+        cmd = [args.openscad, mainfile, '-o', echofile, '--enable=parse-cache', '--debug=ParseCache'] + remaining_args
+        print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+        result = subprocess.run(cmd, env=env, stderr=subprocess.PIPE, universal_newlines=True)
+        print(result.stderr, file=sys.stderr)
+        if result.returncode != 0:
+            failquit('OpenSCAD failed with return code ' + str(result.returncode))
+        hit = 'Using cached parse result' in result.stderr
+        if hit != expect_hit:
+            failquit('Expected the cached parse result to be ' + ('used' if expect_hit else 'ignored'))
+        with open(echofile) as f:
+            values = re.findall(r'ECHO: value = (\S+)', f.read())
+        if values != [str(expected_value)]:
+            failquit('Expected value = ' + str(expected_value), values)
+
+    run(1, False)
+    run(1, True)
+
+    with open(os.path.join(srcdir, included), 'w') as f:
+        f.write('value = 2;\n')
+
+    run(2, False)
+    run(2, True)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+# Partial result test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# The input file echoes the number of top level objects the preview should
+# get as partial results as "top_level_objects = <n>".
+#
+# step 1. Export the CSG term of the input file with --debug=CSGTreeEvaluator.
+# step 2. Check that exactly <n> distinct top level objects were reported
+#         as partial results, in the order of the file.
+#
+# The script is self-contained, it doesn't write to the output file.
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('partial_result_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting partial_result_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-partial-result-')
+try:
+    cmd = [args.openscad, inputfile, '-o', os.path.join(tmpdir, 'out.term'),
+           '--debug=CSGTreeEvaluator'] + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    print(result.stdout, file=sys.stderr)
+    if result.returncode != 0:
+        failquit('OpenSCAD failed with return code ' + str(result.returncode))
+
+    expected = re.search(r'ECHO: top_level_objects = (\d+)', result.stdout)
+    if not expected:
+        failquit('The input file does not echo top_level_objects')
+    reported = [int(i) for i in re.findall(r'Partial result: top level object (\d+)', result.stdout)]
+    if len(reported) != int(expected.group(1)):
+        failquit('Expected ' + expected.group(1) + ' partial results, got ' + str(len(reported)))
+    if reported != sorted(set(reported)):
+        failquit('Partial results repeated or out of order', reported)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,98 @@
+// Unit test of PolygonIndexBuffer, especially switching from the triangles
+// only layout to offsets when the first non-triangle is appended.
+// Returns the number of failed checks.
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "geometry/GeometryUtils.h"
+#include "geometry/PolygonIndexBuffer.h"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #cond << std::endl; \
+      ++failures; \
+    } \
+  } while (0)
+
+bool sameFaces(const PolygonIndexBuffer& buffer, const PolygonIndices& expected)
+{
+  if (buffer.size() != expected.size()) return false;
+  size_t total = 0;
+  for (size_t i = 0; i < expected.size(); i++) {
+    const auto face = buffer[i];
+    if (buffer.faceStart(i) != total) return false;
+    if (!std::equal(face.begin(), face.end(), expected[i].begin(), expected[i].end())) return false;
+    total += expected[i].size();
+  }
+  if (buffer.faceStart(buffer.size()) != total || buffer.data().size() != total) return false;
+  size_t i = 0;
+  for (const auto& face : buffer) {
+    if (!std::equal(face.begin(), face.end(), expected[i].begin(), expected[i].end())) return false;
+    i++;
+  }
+  return i == expected.size() && buffer.toPolygonIndices() == expected;
+}
+
+void testTriangles()
+{
+  PolygonIndexBuffer buffer;
+  CHECK(buffer.empty());
+  CHECK(buffer.isTriangular());
+  buffer.push_back({0, 1, 2});
+  buffer.push_back(IndexedFace{2, 1, 3});
+  CHECK(buffer.isTriangular());
+  CHECK(sameFaces(buffer, {{0, 1, 2}, {2, 1, 3}}));
+}
+
+void testSwitchAfterTriangles()
+{
+  PolygonIndexBuffer buffer;
+  buffer.push_back({0, 1, 2});
+  buffer.push_back({2, 1, 3});
+  buffer.push_back({3, 4, 5, 6});
+  CHECK(!buffer.isTriangular());
+  buffer.push_back({6, 5, 7});
+  buffer.push_back({7, 8, 9, 10, 11});
+  CHECK(sameFaces(buffer, {{0, 1, 2}, {2, 1, 3}, {3, 4, 5, 6}, {6, 5, 7}, {7, 8, 9, 10, 11}}));
+}
+
+void testSwitchOnFirstFace()
+{
+  PolygonIndexBuffer buffer;
+  buffer.push_back(std::vector<int>{0, 1, 2, 3});
+  CHECK(!buffer.isTriangular());
+  buffer.push_back({3, 2, 4});
+  CHECK(sameFaces(buffer, {{0, 1, 2, 3}, {3, 2, 4}}));
+}
+
+void testFromPolygonIndices()
+{
+  const PolygonIndices triangles = {{0, 1, 2}, {1, 3, 2}};
+  const PolygonIndexBuffer triangle_buffer(triangles);
+  CHECK(triangle_buffer.isTriangular());
+  CHECK(sameFaces(triangle_buffer, triangles));
+
+  const PolygonIndices mixed = {{0, 1, 2}, {1, 3, 2}, {3, 4}, {4, 5, 6}};
+  const PolygonIndexBuffer mixed_buffer(mixed);
+  CHECK(!mixed_buffer.isTriangular());
+  CHECK(sameFaces(mixed_buffer, mixed));
+}
+
+} // namespace
+
+int main()
+{
+  testTriangles();
+  testSwitchAfterTriangles();
+  testSwitchOnFirstFace();
+  testFromPolygonIndices();
+  return failures;
+}
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+
+# Profiler test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# step 1. Run OpenSCAD on the input file with "--summary profile", writing the
+#         summary and the folded stacks, then again writing a Chrome trace.
+# step 2. Check the call tree in the summary: the number of calls of part() and
+#         twice() in profile.scad, cache lookups of geometry nodes, and that
+#         self time never exceeds total time.
+# step 3. Check the format of the folded stacks and the Chrome trace.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, json, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('profile_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting profile_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+def run(tmpdir, *extra_args):
+    cmd = [args.openscad, inputfile, '-o', os.path.join(tmpdir, 'out.stl')] + list(extra_args) + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    if subprocess.call(cmd) != 0:
+        failquit('OpenSCAD failed')
+
+def entries(tree):
+    for entry in tree:
+        yield entry
+        yield from entries(entry.get('children', []))
+
+def count_calls(tree, category, name):
+    return sum(e['calls'] for e in entries(tree) if e['category'] == category and e['name'] == name)
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-profile-')
+try:
+    summaryfile = os.path.join(tmpdir, 'summary.json')
+    foldedfile = os.path.join(tmpdir, 'profile.folded')
+    tracefile = os.path.join(tmpdir, 'profile.json')
+    run(tmpdir, '--summary', 'profile', '--summary-file', summaryfile, '--profile-file', foldedfile)
+    run(tmpdir, '--profile-file', tracefile)
+
+    with open(summaryfile) as f:
+        profile = json.load(f).get('profile')
+    if profile is None:
+        failquit('No profile in the summary')
+
+    phases = sorted(e['name'] for e in profile if e['category'] == 'phase')
+    if phases != ['instantiate', 'render']:
+        failquit('Unexpected phases', phases)
+    if count_calls(profile, 'module', 'part') != 4:
+        failquit('Expected 4 calls of part()', count_calls(profile, 'module', 'part'))
+    if count_calls(profile, 'function', 'twice') != 3:
+        failquit('Expected 3 calls of twice()', count_calls(profile, 'function', 'twice'))
+
+    geometry = [e for e in entries(profile) if e['category'] == 'geometry']
+    if not geometry:
+        failquit('No geometry nodes in the profile')
+    for e in geometry:
+        # Each visit of a node looks it up in the cache once
+        if e.get('cache_hits', 0) + e.get('cache_misses', 0) != e['calls']:
+            failquit('Cache lookups do not match the calls', e)
+    if not any(e.get('output_facets', 0) > 0 for e in geometry):
+        failquit('No facets recorded for geometry nodes')
+    for e in entries(profile):
+        if e['self_us'] > e['total_us']:
+            failquit('Self time exceeds total time', e)
+
+    with open(foldedfile) as f:
+        lines = f.read().splitlines()
+    if not lines:
+        failquit('Empty folded stacks')
+    for line in lines:
+        if not re.fullmatch(r'(instantiate|render)(;[^;]+)* [0-9]+', line):
+            failquit('Invalid folded stack line', line)
+
+    with open(tracefile) as f:
+        events = json.load(f)['traceEvents']
+    parts = [e for e in events if e['cat'] == 'module' and e['name'] == 'part']
+    if len(parts) != 4:
+        failquit('Expected 4 trace events for part()', len(parts))
+    for e in events:
+        if e['ph'] != 'X' or e['dur'] < 0:
+            failquit('Invalid trace event', e)
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
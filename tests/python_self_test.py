@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+
+# Python self test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# The input file is a Python script which runs its own checks and prints
+# PASSED if all of them succeed.
+#
+# step 1. Run OpenSCAD on the input file, exporting its shown object to STL.
+# step 2. Check that it printed PASSED.
+#
+# The script is self-contained, it doesn't write to the output file.
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, re, shutil, subprocess, argparse, tempfile
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('python_self_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting python_self_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+tmpdir = tempfile.mkdtemp(prefix='openscad-python-self-')
+try:
+    cmd = [args.openscad, inputfile, '-o', os.path.join(tmpdir, 'out.stl'), '--trust-python'] + remaining_args
+    print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    print(result.stdout, file=sys.stderr)
+    if result.returncode != 0:
+        failquit('OpenSCAD failed with return code ' + str(result.returncode))
+    if not re.search(r'^(ECHO: )?PASSED$', result.stdout, re.MULTILINE):
+        failquit('The checks of ' + inputfile + ' did not pass')
+finally:
+    shutil.rmtree(tmpdir, ignore_errors=True)
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+# Persistent cache test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [--expect-cache] [<openscad args>] outputfile
+#
+# step 1. Run OpenSCAD on the input file with an empty user folder, which fills
+#         any persistent caches enabled by the given args.
+# step 2. If --expect-cache is given, check that something was stored in the user folder.
+# step 3. Run OpenSCAD again with the same user folder, writing the given output file.
+#         With --expect-cache, the debug output must show that the cached parse
+#         result was used.
+# step 4. Check that both runs produced the same output.
+# step 5. (done in CTest) - compare the output file to the expected output.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, shutil, subprocess, argparse, tempfile, filecmp
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('rerun_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting rerun_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('--expect-cache', dest='expectcache', action='store_true', help='Require the first run to store something in the user folder')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+outputfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+outputbase, outputsuffix = os.path.splitext(outputfile)
+firstfile = outputbase + '-first' + outputsuffix
+
+home = tempfile.mkdtemp(prefix='openscad-rerun-')
+try:
+    # The user folder is only used if the documents folder exists
+    os.makedirs(os.path.join(home, '.local', 'share'))
+    fontdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "data/ttf"))
+    env = os.environ.copy()
+    env["HOME"] = home
+    env["OPENSCAD_FONT_PATH"] = fontdir
+
+    for output in [firstfile, outputfile]:
+        cmd = [args.openscad, inputfile, '-o', output] + remaining_args
+        print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+        result = subprocess.call(cmd, env=env)
+        if result != 0:
+            failquit('OpenSCAD failed with return code ' + str(result))
+        if output == firstfile and args.expectcache:
+            stored = [f for _, _, files in os.walk(os.path.join(home, '.local', 'share')) for f in files]
+            if not stored:
+                failquit('Nothing was stored in the user folder ' + home)
+
+    if args.expectcache:
+        # Once more with debug output of the parse cache, which must report a hit.
+        # Debug messages may end up in the output, so it isn't compared.
+        debugfile = outputbase + '-debug' + outputsuffix
+        cmd = [args.openscad, inputfile, '-o', debugfile, '--debug=ParseCache'] + remaining_args
+        print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+        result = subprocess.run(cmd, env=env, stderr=subprocess.PIPE, universal_newlines=True)
+        print(result.stderr, file=sys.stderr)
+        if result.returncode != 0:
+            failquit('OpenSCAD failed with return code ' + str(result.returncode))
+        if 'Using cached parse result' not in result.stderr:
+            failquit('The cached parse result was not used')
+        os.remove(debugfile)
+finally:
+    shutil.rmtree(home, ignore_errors=True)
+
+if not filecmp.cmp(firstfile, outputfile, shallow=False):
+    failquit('Output of the second run differs from the first: ' + firstfile + ' ' + outputfile)
+os.remove(firstfile)
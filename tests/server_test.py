@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+# Server mode test
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+#
+# step 1. Start OpenSCAD with --server and send it a job for the input file,
+#         overriding its parameters, followed by a job with a parameter name
+#         which is not an identifier and a quit command.
+# step 2. Check that the first job succeeded, the second one was rejected and
+#         the quit command was acknowledged.
+# step 3. (done in CTest) - compare the output of the first job to the expected output.
+#
+# This script should return 0 on success, not-0 on error.
+
+import sys, os, json, subprocess, argparse
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('server_test args:', str(sys.argv), file=sys.stderr)
+    print('exiting server_test.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = os.path.abspath(remaining_args[0])
+outputfile = os.path.abspath(remaining_args[-1])
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+outputbase, outputsuffix = os.path.splitext(outputfile)
+injectedfile = outputbase + '-injected' + outputsuffix
+jobs = [
+    {"id": 1, "input": inputfile, "output": outputfile, "parameters": {"size": 3, "label": "b"}},
+    {"id": 2, "input": inputfile, "output": injectedfile, "parameters": {"x=1;echo(\"injected\");y": 1}},
+    {"id": 3, "command": "quit"},
+]
+stdin = ''.join(json.dumps(job) + '\n' for job in jobs)
+
+cmd = [args.openscad, '--server'] + remaining_args
+print('Running OpenSCAD:', ' '.join(cmd), file=sys.stderr)
+proc = subprocess.run(cmd, input=stdin, stdout=subprocess.PIPE, text=True)
+if proc.returncode != 0:
+    failquit('OpenSCAD failed with return code ' + str(proc.returncode))
+
+responses = {}
+for line in proc.stdout.splitlines():
+    try:
+        response = json.loads(line)
+    except ValueError:
+        continue
+    if 'id' in response: responses[response['id']] = response
+print('Responses:', responses, file=sys.stderr)
+
+if responses.get(1, {}).get('status') != 'ok':
+    failquit('Job with valid parameters failed')
+if responses.get(2, {}).get('status') != 'error':
+    failquit('Job with an invalid parameter name was not rejected')
+if os.path.exists(injectedfile):
+    os.remove(injectedfile)
+    failquit('Job with an invalid parameter name produced output')
+if responses.get(3, {}).get('status') != 'ok':
+    failquit('Quit command was not acknowledged')